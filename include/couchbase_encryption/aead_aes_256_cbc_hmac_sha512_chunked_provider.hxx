@@ -0,0 +1,148 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#pragma once
+
+#include <couchbase/error.hxx>
+#include <couchbase_encryption/crypto_executor.hxx>
+#include <couchbase_encryption/decrypter.hxx>
+#include <couchbase_encryption/encrypter.hxx>
+#include <couchbase_encryption/encryption_result.hxx>
+#include <couchbase_encryption/keyring.hxx>
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace couchbase::crypto
+{
+namespace impl::aes_cbc_hmac
+{
+class prepared_key_cache;
+} // namespace impl::aes_cbc_hmac
+
+/**
+ * Options for couchbase::crypto::aead_aes_256_cbc_hmac_sha512_chunked_provider.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+struct chunked_provider_options {
+  /**
+   * The number of bytes of plaintext in each chunk, between 1 byte and 1 GiB. It is recorded in
+   * the encryption result, so it can be changed without affecting the fields already encrypted.
+   */
+  std::size_t chunk_size{ 64 * 1024 };
+
+  /**
+   * The executor whose worker threads help with values of more than one chunk, if any. The calling
+   * thread processes chunks as well, so this may be the executor the transcoder runs on.
+   */
+  std::shared_ptr<crypto_executor> executor{};
+};
+
+/**
+ * Provider for AES-256 in CBC mode authenticated with HMAC SHA-512, applied to consecutive chunks
+ * of the plaintext. Provides a way to create encrypters and decrypters.
+ *
+ * A single AES-CBC stream can only be encrypted one block after the other. Splitting large values,
+ * such as attachments, into independently authenticated chunks lets them be encrypted and
+ * decrypted on several threads at once. Each chunk is encrypted as with
+ * couchbase::crypto::aead_aes_256_cbc_hmac_sha512_provider, with its own IV, and with its position
+ * in the value as associated data, so that chunks cannot be reordered, dropped, or swapped between
+ * values. Each chunk adds up to 64 bytes to the ciphertext.
+ *
+ * The chunk size is recorded in the `chunk` field of the encryption result.
+ *
+ * Requires a 64 byte key.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+class aead_aes_256_cbc_hmac_sha512_chunked_provider
+{
+public:
+  static inline const std::string algorithm_name{ "AEAD_AES_256_CBC_HMAC_SHA512_CHUNKED" };
+
+  /**
+   * Constructs an instance of a chunked AEAD-AES-256-CBC-HMAC-SHA512 provider, with the given
+   * keyring.
+   *
+   * @param keyring the keyring for obtaining data encryption keys
+   * @param options the chunk size, and the executor to spread chunks over
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  explicit aead_aes_256_cbc_hmac_sha512_chunked_provider(std::shared_ptr<keyring> keyring,
+                                                         chunked_provider_options options = {});
+
+  /**
+   * Creates a new encrypter for the encryption key with the given ID.
+   *
+   * @param key_id the id of the key to use for encryption
+   * @return the chunked AEAD-AES-256-CBC-HMAC-SHA512 encrypter
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] auto encrypter_for_key(const std::string& key_id) const
+    -> std::shared_ptr<encrypter>;
+
+  /**
+   * Creates a new decrypter for this algorithm.
+   *
+   * @return the chunked AEAD-AES-256-CBC-HMAC-SHA512 decrypter
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] auto decrypter() const -> std::shared_ptr<decrypter>;
+
+private:
+  std::shared_ptr<keyring> keyring_;
+  chunked_provider_options options_;
+};
+
+class aead_aes_256_cbc_hmac_sha512_chunked_encrypter : public encrypter
+{
+public:
+  aead_aes_256_cbc_hmac_sha512_chunked_encrypter(std::string key_id,
+                                                 std::shared_ptr<keyring> keyring,
+                                                 chunked_provider_options options);
+
+  auto encrypt(std::vector<std::byte> plaintext) -> std::pair<error, encryption_result> override;
+
+  auto placeholder(std::size_t plaintext_size) -> std::optional<encryption_result> override;
+
+private:
+  std::shared_ptr<keyring> keyring_;
+  std::string key_id_;
+  chunked_provider_options options_;
+  std::shared_ptr<impl::aes_cbc_hmac::prepared_key_cache> prepared_keys_;
+};
+
+class aead_aes_256_cbc_hmac_sha512_chunked_decrypter : public decrypter
+{
+public:
+  aead_aes_256_cbc_hmac_sha512_chunked_decrypter(std::shared_ptr<keyring> keyring,
+                                                 std::shared_ptr<crypto_executor> executor);
+
+  auto decrypt(encryption_result encrypted) -> std::pair<error, std::vector<std::byte>> override;
+  [[nodiscard]] auto algorithm() const -> const std::string& override;
+  void prefetch_keys(const std::vector<std::string>& key_ids) override;
+
+private:
+  std::shared_ptr<keyring> keyring_;
+  std::shared_ptr<crypto_executor> executor_;
+  std::shared_ptr<impl::aes_cbc_hmac::prepared_key_cache> prepared_keys_;
+};
+} // namespace couchbase::crypto
@@ -20,6 +20,11 @@
 
 namespace couchbase::crypto
 {
+namespace impl::aes_cbc_hmac
+{
+class prepared_key_cache;
+} // namespace impl::aes_cbc_hmac
+
 /**
  * Provider for AES-256 in CBC mode authenticated with HMAC SHA-512. Provides a way to create
  * encrypters and decrypters.
@@ -29,6 +34,9 @@ namespace couchbase::crypto
  * The algorithm is formally described in <a
  * href="https://tools.ietf.org/html/draft-mcgrew-aead-aes-cbc-hmac-sha2-05"> Authenticated
  * Encryption with AES-CBC and HMAC-SHA</a>.
+ *
+ * Encrypters and decrypters set up each key once, the first time it is used, and only set it up
+ * again if the keyring returns different bytes for its ID.
  */
 class aead_aes_256_cbc_hmac_sha512_provider
 {
@@ -79,9 +87,12 @@ public:
 
   auto encrypt(std::vector<std::byte> plaintext) -> std::pair<error, encryption_result> override;
 
+  auto placeholder(std::size_t plaintext_size) -> std::optional<encryption_result> override;
+
 private:
   std::shared_ptr<keyring> keyring_;
   std::string key_id_;
+  std::shared_ptr<impl::aes_cbc_hmac::prepared_key_cache> prepared_keys_;
 };
 
 class aead_aes_256_cbc_hmac_sha512_decrypter : public decrypter
@@ -91,8 +102,10 @@ public:
 
   auto decrypt(encryption_result encrypted) -> std::pair<error, std::vector<std::byte>> override;
   [[nodiscard]] auto algorithm() const -> const std::string& override;
+  void prefetch_keys(const std::vector<std::string>& key_ids) override;
 
 private:
   std::shared_ptr<keyring> keyring_;
+  std::shared_ptr<impl::aes_cbc_hmac::prepared_key_cache> prepared_keys_;
 };
 } // namespace couchbase::crypto
@@ -0,0 +1,109 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#pragma once
+
+#include <couchbase/error.hxx>
+#include <couchbase_encryption/decrypter.hxx>
+#include <couchbase_encryption/encrypter.hxx>
+#include <couchbase_encryption/encryption_result.hxx>
+#include <couchbase_encryption/keyring.hxx>
+
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace couchbase::crypto
+{
+/**
+ * Provider for deterministic authenticated encryption using AES-SIV with AES-256 and CMAC. Provides
+ * a way to create encrypters and decrypters.
+ *
+ * Unlike couchbase::crypto::aead_aes_256_cbc_hmac_sha512_provider, encrypting the same plaintext
+ * with the same key always produces the same ciphertext. This allows the server to index the
+ * ciphertext of a field and look documents up by equality, e.g. with an index on
+ * `encrypted$ssn.ciphertext`, at the cost of revealing which documents share a value for the
+ * field. It should only be used for fields that need to be queried by equality.
+ *
+ * Requires a 64 byte key.
+ *
+ * The algorithm is formally described in <a href="https://tools.ietf.org/html/rfc5297">RFC 5297:
+ * Synthetic Initialization Vector (SIV) Authenticated Encryption Using the Advanced Encryption
+ * Standard (AES)</a>.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+class aead_aes_siv_cmac_512_provider
+{
+public:
+  static inline const std::string algorithm_name{ "AEAD_AES_SIV_CMAC_512" };
+
+  /**
+   * Constructs an instance of an AEAD-AES-SIV-CMAC-512 provider, with the given keyring.
+   *
+   * @param keyring the keyring for obtaining data encryption keys
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  explicit aead_aes_siv_cmac_512_provider(std::shared_ptr<keyring> keyring);
+
+  /**
+   * Creates a new encrypter for the encryption key with the given ID.
+   *
+   * @param key_id the id of the key to use for encryption
+   * @return the AEAD-AES-SIV-CMAC-512 encrypter
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] auto encrypter_for_key(const std::string& key_id) const
+    -> std::shared_ptr<encrypter>;
+
+  /**
+   * Creates a new decrypter for this algorithm.
+   *
+   * @return the AEAD-AES-SIV-CMAC-512 decrypter
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] auto decrypter() const -> std::shared_ptr<decrypter>;
+
+private:
+  std::shared_ptr<keyring> keyring_;
+};
+
+class aead_aes_siv_cmac_512_encrypter : public encrypter
+{
+public:
+  explicit aead_aes_siv_cmac_512_encrypter(std::string key_id, std::shared_ptr<keyring> keyring);
+
+  auto encrypt(std::vector<std::byte> plaintext) -> std::pair<error, encryption_result> override;
+
+  auto placeholder(std::size_t plaintext_size) -> std::optional<encryption_result> override;
+
+private:
+  std::shared_ptr<keyring> keyring_;
+  std::string key_id_;
+};
+
+class aead_aes_siv_cmac_512_decrypter : public decrypter
+{
+public:
+  explicit aead_aes_siv_cmac_512_decrypter(std::shared_ptr<keyring> keyring);
+
+  auto decrypt(encryption_result encrypted) -> std::pair<error, std::vector<std::byte>> override;
+  [[nodiscard]] auto algorithm() const -> const std::string& override;
+  void prefetch_keys(const std::vector<std::string>& key_ids) override;
+
+private:
+  std::shared_ptr<keyring> keyring_;
+};
+} // namespace couchbase::crypto
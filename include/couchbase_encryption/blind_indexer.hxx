@@ -0,0 +1,158 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#pragma once
+
+#include <couchbase/error.hxx>
+#include <couchbase_encryption/encrypted_fields.hxx>
+#include <couchbase_encryption/keyring.hxx>
+#include <couchbase_encryption/manager.hxx>
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace couchbase::crypto
+{
+/**
+ * The errors specific to blind indexes, reported alongside those of
+ * couchbase::errc::field_level_encryption.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+enum class blind_index_errc {
+  /**
+   * No blind indexer is registered with the alias of the field, nor as the default one.
+   */
+  blind_indexer_not_found = 1,
+};
+
+/**
+ * Returns the category of couchbase::crypto::blind_index_errc.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+auto
+blind_index_category() noexcept -> const std::error_category&;
+
+/**
+ * @since 1.1.0
+ * @uncommitted
+ */
+auto
+make_error_code(blind_index_errc code) noexcept -> std::error_code;
+
+/**
+ * A blind indexer computes a keyed hash of a plaintext, which is stored alongside an encrypted
+ * field so that the server can match documents on the field's value without decrypting it.
+ *
+ * @see couchbase::crypto::blind_index_options
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+class blind_indexer
+{
+public:
+  blind_indexer() = default;
+  blind_indexer(const blind_indexer& other) = default;
+  blind_indexer(blind_indexer&& other) = default;
+  auto operator=(const blind_indexer& other) -> blind_indexer& = default;
+  auto operator=(blind_indexer&& other) -> blind_indexer& = default;
+  virtual ~blind_indexer() = default;
+
+  /**
+   * Computes the keyed hash of the given message.
+   *
+   * @param plaintext the message to hash
+   * @return the keyed hash, or an error if it could not be computed
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] virtual auto index(const std::vector<std::byte>& plaintext)
+    -> std::pair<error, std::vector<std::byte>> = 0;
+
+  /**
+   * Returns the size of the keyed hashes computed by index(), without retrieving the key. It is
+   * used to compute the size of encrypted documents ahead of time.
+   *
+   * The default implementation returns std::nullopt.
+   *
+   * @return the size of the keyed hashes, in bytes, or std::nullopt if it is not known in advance
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] virtual auto index_size() const -> std::optional<std::size_t>
+  {
+    return std::nullopt;
+  }
+};
+
+/**
+ * A blind indexer that computes HMAC-SHA512 of the plaintext, using a key from a keyring.
+ *
+ * The key should not be used for anything else, in particular it must not be a data encryption
+ * key.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+class hmac_sha512_blind_indexer : public blind_indexer
+{
+public:
+  /**
+   * Constructs an HMAC-SHA512 blind indexer that uses the key with the given ID.
+   *
+   * @param key_id the id of the key to use for hashing
+   * @param keyring the keyring for obtaining the key
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  hmac_sha512_blind_indexer(std::string key_id, std::shared_ptr<keyring> keyring);
+
+  [[nodiscard]] auto index(const std::vector<std::byte>& plaintext)
+    -> std::pair<error, std::vector<std::byte>> override;
+
+  [[nodiscard]] auto index_size() const -> std::optional<std::size_t> override;
+
+private:
+  std::shared_ptr<keyring> keyring_;
+  std::string key_id_;
+};
+
+/**
+ * Computes the blind index token for the given plaintext, as it is stored in the `bix` member of
+ * an encrypted node. This can be used to build queries that match on a blind-indexed field.
+ *
+ * @param crypto_manager the crypto manager with the blind indexer registered
+ * @param plaintext the serialized value of the field, e.g. `"123-45-6789"` (including the quotes)
+ * for a JSON string
+ * @param options the blind index options of the field
+ * @return the base64-encoded token, or an error if it could not be computed
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+auto
+blind_index_token(const std::shared_ptr<manager>& crypto_manager,
+                  const std::vector<std::byte>& plaintext,
+                  const blind_index_options& options) -> std::pair<error, std::string>;
+} // namespace couchbase::crypto
+
+template<>
+struct std::is_error_code_enum<couchbase::crypto::blind_index_errc> : std::true_type {
+};
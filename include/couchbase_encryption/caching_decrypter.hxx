@@ -0,0 +1,146 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#pragma once
+
+#include <couchbase/error.hxx>
+#include <couchbase_encryption/decrypter.hxx>
+#include <couchbase_encryption/encryption_result.hxx>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace couchbase::crypto
+{
+/**
+ * Options for couchbase::crypto::caching_decrypter.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+struct caching_decrypter_options {
+  /**
+   * The maximum number of bytes of plaintext (plus a small per-entry overhead) kept in the cache.
+   * Zero disables caching.
+   */
+  std::size_t max_bytes{ 16 * 1024 * 1024 };
+
+  /**
+   * The number of independently locked shards the cache is split into, which reduces contention
+   * between threads. Each shard holds at most `max_bytes / shard_count` bytes.
+   */
+  std::size_t shard_count{ 16 };
+};
+
+/**
+ * A decrypter that caches the plaintexts produced by another decrypter, so that fields that are
+ * read over and over again are only decrypted once.
+ *
+ * Entries are looked up by the algorithm, the key ID and a SHA-256 digest of the whole encrypted
+ * node, so a cached plaintext is only returned for exactly the ciphertext it was decrypted from,
+ * which has been authenticated when it was first decrypted. Only successful decryptions are
+ * cached. The cache is bounded by size and evicts the least recently used entries first. Evicted
+ * plaintexts are overwritten before their memory is released.
+ *
+ * Caching keeps decrypted field values in memory for longer than they would otherwise be, which
+ * is why it has to be enabled explicitly, by registering this decrypter with the crypto manager.
+ * When a key is revoked, call invalidate() with its ID, so that values encrypted with it are no
+ * longer served from the cache.
+ *
+ * It uses the same algorithm name as the decrypter it wraps, so it replaces that decrypter when
+ * registered with the crypto manager.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+class caching_decrypter : public decrypter
+{
+public:
+  /**
+   * Constructs a caching decrypter.
+   *
+   * @param decrypter the decrypter to decrypt the fields that are not cached with
+   * @param options the cache options
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  explicit caching_decrypter(std::shared_ptr<decrypter> decrypter,
+                             caching_decrypter_options options = {});
+
+  /**
+   * Returns the cached plaintext of the given encrypted message, or decrypts it with the wrapped
+   * decrypter and caches the result.
+   *
+   * @param encrypted the encrypted message to decrypt
+   * @return the decrypted message, or an error if decryption failed
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] auto decrypt(encryption_result encrypted)
+    -> std::pair<error, std::vector<std::byte>> override;
+
+  /**
+   * Returns the name of the encryption algorithm of the wrapped decrypter.
+   *
+   * @return the name of the algorithm
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] auto algorithm() const -> const std::string& override;
+
+  /**
+   * Passes the hint on to the wrapped decrypter.
+   *
+   * @param key_ids the IDs of the keys
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  void prefetch_keys(const std::vector<std::string>& key_ids) override;
+
+  /**
+   * Removes the plaintexts of all fields that were encrypted with the given key from the cache.
+   * The plaintexts of the decryptions that are running meanwhile are not cached either.
+   *
+   * @param key_id the ID of the key
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  void invalidate(const std::string& key_id);
+
+  /**
+   * Removes all plaintexts from the cache.
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  void clear();
+
+  /**
+   * Returns the number of bytes currently accounted to the cache.
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] auto size_in_bytes() const -> std::size_t;
+
+private:
+  struct shard;
+
+  std::shared_ptr<decrypter> decrypter_;
+  std::size_t max_shard_bytes_;
+  std::vector<std::shared_ptr<shard>> shards_{};
+};
+} // namespace couchbase::crypto
@@ -0,0 +1,162 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#pragma once
+
+#include <couchbase_encryption/key.hxx>
+#include <couchbase_encryption/keyring.hxx>
+
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace couchbase::crypto
+{
+/**
+ * Options for couchbase::crypto::caching_keyring.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+struct caching_keyring_options {
+  /**
+   * The maximum number of keys kept in the cache. Zero disables caching of keys.
+   */
+  std::size_t max_keys{ 1024 };
+
+  /**
+   * How long a key is served from the cache before it is fetched from the backing keyring again.
+   */
+  std::chrono::milliseconds key_ttl{ std::chrono::minutes{ 10 } };
+
+  /**
+   * The maximum number of missing key IDs remembered by the cache. Zero disables negative
+   * caching.
+   */
+  std::size_t max_missing_keys{ 4096 };
+
+  /**
+   * How long a key ID that the backing keyring reported as missing is answered from the cache,
+   * without consulting the backing keyring.
+   */
+  std::chrono::milliseconds missing_key_ttl{ std::chrono::seconds{ 30 } };
+};
+
+/**
+ * A keyring that caches the keys retrieved from another keyring, typically one that is backed by a
+ * remote key management service.
+ *
+ * Key IDs that the backing keyring reports as missing are cached as well (negative caching), so
+ * that documents referring to an unknown key do not result in a request to the backing keyring on
+ * every read. Both caches are bounded, and evict the least recently used entries first.
+ *
+ * Errors other than couchbase::errc::field_level_encryption::crypto_key_not_found are never
+ * cached.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+class caching_keyring : public keyring
+{
+public:
+  /**
+   * Constructs a caching keyring in front of the given keyring.
+   *
+   * @param backing_keyring the keyring to retrieve keys from when they are not cached
+   * @param options the cache options
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  explicit caching_keyring(std::shared_ptr<keyring> backing_keyring,
+                           caching_keyring_options options = {});
+
+  /**
+   * Retrieves a key from the cache, or from the backing keyring if it is not cached.
+   *
+   * @param key_id the ID of the key to retrieve
+   * @return the key if found, or an error if retrieving the key failed
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] auto get(const std::string& key_id) const -> std::pair<error, key> override;
+
+  /**
+   * Retrieves several keys from the cache, retrieving the ones that are not cached from the backing
+   * keyring in a single call to its get_many().
+   *
+   * @param key_ids the IDs of the keys to retrieve
+   * @return for each key ID, in the same order, the key if found, or an error if retrieving the
+   * key failed
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] auto get_many(const std::vector<std::string>& key_ids) const
+    -> std::vector<std::pair<error, key>> override;
+
+  /**
+   * Retrieves the keys that are not cached from the backing keyring, in a single call to its
+   * get_many(), and caches them.
+   *
+   * @param key_ids the IDs of the keys that are about to be used
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  void prefetch(const std::vector<std::string>& key_ids) const override;
+
+  /**
+   * Removes the key with the given ID from the cache, whether it was cached as present or missing.
+   *
+   * @param key_id the ID of the key to remove
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  void invalidate(const std::string& key_id);
+
+  /**
+   * Removes all keys from the cache.
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  void clear();
+
+private:
+  using clock = std::chrono::steady_clock;
+
+  struct entry {
+    std::optional<key> k{};
+    clock::time_point expires_at{};
+    std::list<std::string>::iterator lru_position{};
+  };
+
+  auto find(const std::string& key_id) const -> std::optional<std::pair<error, key>>;
+  void store(const std::string& key_id, std::optional<key> k) const;
+  void store(const std::string& key_id, const std::pair<error, key>& result) const;
+  void erase(std::unordered_map<std::string, entry>::iterator it) const;
+
+  std::shared_ptr<keyring> backing_keyring_;
+  caching_keyring_options options_;
+
+  mutable std::mutex mutex_{};
+  mutable std::unordered_map<std::string, entry> entries_{};
+  mutable std::list<std::string> keys_lru_{};
+  mutable std::list<std::string> missing_keys_lru_{};
+};
+} // namespace couchbase::crypto
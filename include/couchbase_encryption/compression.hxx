@@ -0,0 +1,234 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#pragma once
+
+#include <couchbase/error.hxx>
+#include <couchbase_encryption/decrypter.hxx>
+#include <couchbase_encryption/encrypter.hxx>
+#include <couchbase_encryption/encryption_result.hxx>
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace couchbase::crypto
+{
+/**
+ * The compression algorithms that can be applied to a field before it is encrypted.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+enum class compression_algorithm {
+  /**
+   * Zstandard. Requires the library to be built with zstd support.
+   */
+  zstd,
+
+  /**
+   * LZ4 block compression. Requires the library to be built with LZ4 support.
+   */
+  lz4,
+};
+
+/**
+ * A compression dictionary, typically trained on a sample of the values of a field (e.g. with
+ * `zstd --train`). Small values of similar shape compress much better with a dictionary.
+ *
+ * The same dictionary, with the same ID, must be made available to the
+ * couchbase::crypto::decompressing_decrypter to read the fields back.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+struct compression_dictionary {
+  /**
+   * The ID of the dictionary, which is recorded in the encryption result. It must be 1 to 65535
+   * bytes long.
+   */
+  std::string id;
+
+  /**
+   * The contents of the dictionary.
+   */
+  std::vector<std::byte> bytes;
+};
+
+/**
+ * Options for couchbase::crypto::compressing_encrypter.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+struct compression_options {
+  /**
+   * The compression algorithm.
+   */
+  compression_algorithm algorithm{ compression_algorithm::zstd };
+
+  /**
+   * Plaintexts shorter than this number of bytes are encrypted without compression.
+   */
+  std::size_t min_size{ 1024 };
+
+  /**
+   * The compression level. For zstd this is the zstd compression level, for LZ4 it is the
+   * acceleration factor (higher is faster and compresses less).
+   */
+  int level{ 3 };
+
+  /**
+   * The dictionary to compress with, if any.
+   */
+  std::optional<compression_dictionary> dictionary{};
+};
+
+/**
+ * Returns whether the library was built with support for the given compression algorithm.
+ *
+ * @param algorithm the compression algorithm
+ * @return true if the algorithm can be used for compression and decompression
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+auto
+is_compression_supported(compression_algorithm algorithm) -> bool;
+
+/**
+ * An encrypter that compresses the plaintext before passing it to another encrypter.
+ *
+ * Ciphertext does not compress, so compression has to happen before encryption to have any effect
+ * on the size of the encrypted field. When the plaintext was compressed, the algorithm (and the
+ * dictionary ID, if any) is written in a short header in front of the compressed data, so that the
+ * wrapped encrypter authenticates it. It is also recorded in the encryption result, in the `cmp`
+ * and `cdict` fields, which the couchbase::crypto::decompressing_decrypter checks against the
+ * header. If compression does not make the plaintext smaller, it is encrypted as-is.
+ *
+ * Compression makes the length of the ciphertext depend on the contents of the plaintext. Do not
+ * compress fields that mix secrets with data an attacker can influence.
+ *
+ * Fields encrypted by this encrypter must be read with a
+ * couchbase::crypto::decompressing_decrypter.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+class compressing_encrypter : public encrypter
+{
+public:
+  /**
+   * Constructs a compressing encrypter.
+   *
+   * If the dictionary cannot be prepared (e.g. it is not a valid zstd dictionary, or its ID is
+   * empty), every call to encrypt() fails, rather than compressing without the dictionary.
+   *
+   * @param encrypter the encrypter to encrypt the (compressed) plaintext with
+   * @param options the compression options
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  compressing_encrypter(std::shared_ptr<encrypter> encrypter, compression_options options = {});
+
+  /**
+   * Compresses, then encrypts the given message.
+   *
+   * @param plaintext the bytes to encrypt
+   * @return the encryption result, or an error if compression or encryption failed
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  auto encrypt(std::vector<std::byte> plaintext) -> std::pair<error, encryption_result> override;
+
+private:
+  struct compressor;
+
+  std::shared_ptr<encrypter> encrypter_;
+  compression_options options_;
+  std::shared_ptr<compressor> compressor_;
+};
+
+/**
+ * A decrypter that decompresses the plaintext produced by another decrypter, if the encryption
+ * result indicates that it was compressed by a couchbase::crypto::compressing_encrypter.
+ *
+ * It uses the same algorithm name as the decrypter it wraps, so it replaces that decrypter when
+ * registered with the crypto manager. Fields that were not compressed are decrypted as usual.
+ * Fields whose `cmp` or `cdict` fields do not match the authenticated compression header fail to
+ * decrypt.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+class decompressing_decrypter : public decrypter
+{
+public:
+  /**
+   * Constructs a decompressing decrypter.
+   *
+   * @param decrypter the decrypter to decrypt the field with
+   * @param dictionaries the dictionaries the fields may have been compressed with. Fields that
+   * refer to a dictionary that cannot be prepared fail to decrypt.
+   * @param max_plaintext_size the maximum size of a decompressed field, which protects against
+   * maliciously crafted compressed fields
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  explicit decompressing_decrypter(std::shared_ptr<decrypter> decrypter,
+                                   std::vector<compression_dictionary> dictionaries = {},
+                                   std::size_t max_plaintext_size = 20 * 1024 * 1024);
+
+  /**
+   * Decrypts the given encrypted message, then decompresses it if it was compressed.
+   *
+   * @param encrypted the encrypted message to decrypt
+   * @return the decrypted message, or an error if decryption or decompression failed
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] auto decrypt(encryption_result encrypted)
+    -> std::pair<error, std::vector<std::byte>> override;
+
+  /**
+   * Returns the name of the encryption algorithm of the wrapped decrypter.
+   *
+   * @return the name of the algorithm
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] auto algorithm() const -> const std::string& override;
+
+  /**
+   * Passes the hint on to the wrapped decrypter.
+   *
+   * @param key_ids the IDs of the keys
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  void prefetch_keys(const std::vector<std::string>& key_ids) override;
+
+private:
+  struct decompressor;
+
+  std::shared_ptr<decrypter> decrypter_;
+  std::map<std::string, std::shared_ptr<decompressor>, std::less<>> dictionaries_{};
+  std::size_t max_plaintext_size_;
+};
+} // namespace couchbase::crypto
@@ -0,0 +1,148 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace couchbase::crypto
+{
+/**
+ * The implementations of AEAD_AES_256_CBC_HMAC_SHA512 that
+ * couchbase::crypto::aead_aes_256_cbc_hmac_sha512_provider and
+ * couchbase::crypto::aead_aes_256_cbc_hmac_sha512_chunked_provider can use. All of them produce
+ * the same ciphertexts, so values encrypted with one can be decrypted with another.
+ *
+ * `openssl` is used unless another backend is pinned with pin_crypto_backend(), or named by the
+ * `COUCHBASE_CXX_ENCRYPTION_CRYPTO_BACKEND` environment variable. The fastest backend on the
+ * current CPU can be selected instead by a short benchmark of about 10 ms, either explicitly with
+ * select_crypto_backend(), or by setting the environment variable to `auto`, in which case the
+ * benchmark runs the first time a key is set up.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+enum class crypto_backend {
+  /**
+   * The OpenSSL (or BoringSSL) library the encryption library is linked with, with the AES key
+   * schedules and HMAC states of each key set up once. Uses the AES and SHA instructions of the
+   * CPU where the library does.
+   */
+  openssl,
+
+  /**
+   * The implementation of the Couchbase C++ SDK, which sets each key up for every value.
+   */
+  couchbase_sdk,
+};
+
+/**
+ * The throughput of a backend, as measured by benchmark_crypto_backends().
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+struct crypto_backend_measurement {
+  /**
+   * The backend that was measured.
+   */
+  crypto_backend backend;
+
+  /**
+   * The number of bytes of plaintext encrypted and decrypted per second, or 0 if the backend
+   * failed, or produced ciphertexts that the other backends could not decrypt.
+   */
+  double bytes_per_second;
+};
+
+/**
+ * Returns the name of the given backend, as accepted by crypto_backend_from_name().
+ *
+ * @param backend the backend
+ * @return the name of the backend, e.g. `openssl`
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+auto
+crypto_backend_name(crypto_backend backend) -> std::string_view;
+
+/**
+ * Returns the backend with the given name.
+ *
+ * @param name the name of the backend, e.g. `openssl`
+ * @return the backend, or an empty optional if there is no backend with this name
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+auto
+crypto_backend_from_name(std::string_view name) -> std::optional<crypto_backend>;
+
+/**
+ * Measures the throughput of every backend on the current CPU, by encrypting and decrypting
+ * values of 16 KiB, and checking that every backend decrypts the ciphertexts of the others.
+ *
+ * The backends are measured in turn for the given time in each round, starting with a different
+ * backend every round, and the median throughput of the rounds is reported, so that a single
+ * interruption of the thread, or the CPU warming up, does not decide the outcome.
+ *
+ * @param duration how long to measure each backend for in each round
+ * @param rounds the number of rounds
+ * @return the throughput of each backend
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+auto
+benchmark_crypto_backends(std::chrono::microseconds duration = std::chrono::milliseconds{ 1 },
+                          std::size_t rounds = 5) -> std::vector<crypto_backend_measurement>;
+
+/**
+ * Uses the given backend for the keys set up from now on, instead of the default one, e.g. to make
+ * benchmarks reproducible.
+ *
+ * @param backend the backend to use
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+void
+pin_crypto_backend(crypto_backend backend);
+
+/**
+ * Runs the benchmark of benchmark_crypto_backends() on the calling thread, and pins the fastest
+ * backend, like pin_crypto_backend(). As the outcome may differ from one run to the next, call it
+ * once, when the application starts, if at all.
+ *
+ * @return the selected backend
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+auto
+select_crypto_backend() -> crypto_backend;
+
+/**
+ * Returns the backend used for the keys set up from now on. If none was pinned or selected yet,
+ * chooses it from the `COUCHBASE_CXX_ENCRYPTION_CRYPTO_BACKEND` environment variable first, which
+ * runs the benchmark if the variable is `auto`, and other threads that need the backend meanwhile
+ * wait for it.
+ *
+ * @return the active backend
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+auto
+active_crypto_backend() -> crypto_backend;
+} // namespace couchbase::crypto
@@ -0,0 +1,137 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+namespace couchbase::crypto
+{
+/**
+ * The queue of a couchbase::crypto::crypto_executor that a task is posted to.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+enum class crypto_priority {
+  /**
+   * Tasks that someone is waiting for, e.g. decoding the result of a get. They run before bulk
+   * tasks.
+   */
+  interactive,
+
+  /**
+   * Tasks that are part of a larger job, e.g. a migration, which may wait behind interactive tasks.
+   */
+  bulk,
+};
+
+/**
+ * Options for couchbase::crypto::crypto_executor.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+struct crypto_executor_options {
+  /**
+   * The number of worker threads.
+   */
+  std::size_t threads{ 2 };
+
+  /**
+   * Documents of at least this number of bytes are encoded and decoded on the worker threads.
+   */
+  std::size_t min_document_size{ 16 * 1024 };
+
+  /**
+   * Documents with at least this number of encrypted fields are encoded and decoded on the worker
+   * threads, whatever their size.
+   */
+  std::size_t min_encrypted_fields{ 8 };
+};
+
+/**
+ * A pool of threads dedicated to encrypting and decrypting documents, so that large documents do
+ * not block the I/O threads of the SDK, and every other operation multiplexed on them. See the
+ * encode_async() and decode_async() functions of couchbase::crypto::transcoder, which only hand
+ * documents above the size or field count thresholds to the pool, and encode or decode smaller
+ * documents on the calling thread.
+ *
+ * Interactive tasks run before bulk tasks, except that a bulk task that has been waiting runs after
+ * every few interactive tasks, so that bulk tasks cannot be starved.
+ *
+ * Destroying the executor runs the tasks that were already posted, then joins the worker threads,
+ * so it must not be destroyed by one of its own tasks.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+class crypto_executor
+{
+public:
+  /**
+   * Starts the worker threads.
+   *
+   * @param options the options of the executor
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  explicit crypto_executor(crypto_executor_options options = {});
+  crypto_executor(const crypto_executor&) = delete;
+  crypto_executor(crypto_executor&&) = delete;
+  auto operator=(const crypto_executor&) -> crypto_executor& = delete;
+  auto operator=(crypto_executor&&) -> crypto_executor& = delete;
+  ~crypto_executor();
+
+  /**
+   * Runs the given task on a worker thread. Tasks should not throw, exceptions thrown by a task
+   * are logged and otherwise ignored.
+   *
+   * @param task the task to run
+   * @param priority the queue to post the task to
+   * @throws std::invalid_argument if the task is empty
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  void post(std::function<void()> task, crypto_priority priority = crypto_priority::interactive);
+
+  /**
+   * Returns whether a document of the given size, with the given number of encrypted fields, is
+   * worth handing to the worker threads.
+   *
+   * @param document_size the size of the document, in bytes
+   * @param encrypted_fields the number of encrypted fields of the document
+   * @return true if the document is above either threshold
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] auto should_offload(std::size_t document_size, std::size_t encrypted_fields) const
+    -> bool;
+
+  /**
+   * Returns the number of worker threads.
+   *
+   * @return the number of worker threads
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] auto threads() const -> std::size_t;
+
+private:
+  struct state;
+
+  crypto_executor_options options_;
+  std::unique_ptr<state> state_;
+};
+} // namespace couchbase::crypto
@@ -0,0 +1,80 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+namespace couchbase::crypto
+{
+#ifndef COUCHBASE_CXX_ENCRYPTION_DOXYGEN
+namespace internal
+{
+struct decode_state;
+} // namespace internal
+
+enum class document_format;
+
+template<typename Serializer, document_format Format>
+class transcoder;
+#endif
+
+/**
+ * Remembers the encrypted fields of a decoded document, so that encoding the document again after
+ * modifying it only encrypts the fields that have changed.
+ *
+ * Pass the handle to couchbase::crypto::transcoder::decode(), then to
+ * couchbase::crypto::transcoder::encode() in the same read-modify-write cycle. The encrypted nodes
+ * of fields whose plaintext is unchanged are carried over as they were read, as long as the field
+ * would still be encrypted with the same algorithm and key ID, and with the same blind index token,
+ * if any. Fields whose encrypter alias or blind index changed, or whose key was rotated, are
+ * encrypted again. Fields whose encrypter cannot tell its algorithm and key ID without encrypting
+ * (see couchbase::crypto::encrypter::placeholder()) are always encrypted again. To re-encrypt every
+ * field, encode without the handle.
+ *
+ * Only a keyed digest of each plaintext is kept, never the plaintext itself. A handle must not be
+ * used by several threads at the same time.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+class decode_handle
+{
+public:
+  /**
+   * Constructs an empty handle.
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  decode_handle();
+
+  /**
+   * Returns the number of encrypted fields remembered by the handle.
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] auto size() const -> std::size_t;
+
+  /**
+   * Forgets all remembered fields.
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  void clear();
+
+private:
+  template<typename Serializer, document_format Format>
+  friend class transcoder;
+
+  std::shared_ptr<internal::decode_state> state_;
+};
+} // namespace couchbase::crypto
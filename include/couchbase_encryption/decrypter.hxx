@@ -54,5 +54,21 @@ public:
    * @committed
    */
   [[nodiscard]] virtual auto algorithm() const -> const std::string& = 0;
+
+  /**
+   * Hints that messages encrypted with the keys with the given IDs are about to be decrypted, so
+   * that the keys can be retrieved from the keyring ahead of time, in a single request.
+   *
+   * The default implementation does nothing.
+   *
+   * @param key_ids the IDs of the keys
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  virtual void prefetch_keys(const std::vector<std::string>& key_ids)
+  {
+    (void)key_ids;
+  }
 };
 } // namespace couchbase::crypto
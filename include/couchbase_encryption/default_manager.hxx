@@ -9,6 +9,7 @@
 #pragma once
 
 #include <couchbase/error.hxx>
+#include <couchbase_encryption/blind_indexer.hxx>
 #include <couchbase_encryption/manager.hxx>
 
 namespace couchbase::crypto
@@ -65,6 +66,30 @@ public:
    */
   auto register_default_encrypter(std::shared_ptr<encrypter> encrypter) -> error;
 
+  /**
+   * Registers a blind indexer and associates it with the given alias.
+   *
+   * @param alias the alias to associate with the blind indexer
+   * @param indexer the blind indexer to register
+   * @return an error if the registration failed
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  auto register_blind_indexer(std::string alias, std::shared_ptr<blind_indexer> indexer) -> error;
+
+  /**
+   * Registers a default blind indexer that will be used if no indexer alias is specified in the
+   * blind index options of a field.
+   *
+   * @param indexer the default blind indexer to register
+   * @return an error if the registration failed
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  auto register_default_blind_indexer(std::shared_ptr<blind_indexer> indexer) -> error;
+
   /**
    * Encrypts the given data, using the encrypter associated with the given alias, or the default
    * encrypter if no alias is given.
@@ -93,6 +118,50 @@ public:
   auto decrypt(std::map<std::string, std::string> encrypted_node)
     -> std::pair<error, std::vector<std::byte>> override;
 
+  /**
+   * Computes the keyed hash used as a blind index for the given plaintext, using the blind indexer
+   * associated with the given alias, or the default blind indexer if no alias is given.
+   *
+   * @param plaintext the message to compute the blind index for
+   * @param indexer_alias the alias of the blind indexer to use, or std::nullopt to use the default
+   * @return the keyed hash, or an error if it could not be computed
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  auto blind_index(const std::vector<std::byte>& plaintext,
+                   const std::optional<std::string>& indexer_alias)
+    -> std::pair<error, std::vector<std::byte>> override;
+
+  /**
+   * Returns the placeholder encrypted node of the encrypter associated with the given alias, or
+   * the default encrypter if no alias is given.
+   *
+   * @param plaintext_size the size of the plaintext, in bytes
+   * @param encrypter_alias the alias of the encrypter to use, or std::nullopt to use the default
+   * @return the placeholder encrypted node, or an error if the encrypter is not found or cannot
+   * tell the size of its ciphertext in advance
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  auto placeholder(std::size_t plaintext_size, const std::optional<std::string>& encrypter_alias)
+    -> std::pair<error, std::map<std::string, std::string>> override;
+
+  /**
+   * Returns the size of the keyed hashes of the blind indexer associated with the given alias, or
+   * the default blind indexer if no alias is given.
+   *
+   * @param indexer_alias the alias of the blind indexer to use, or std::nullopt to use the default
+   * @return the size of the keyed hashes, in bytes, or an error if the blind indexer is not found
+   * or cannot tell their size in advance
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  auto blind_index_size(const std::optional<std::string>& indexer_alias)
+    -> std::pair<error, std::size_t> override;
+
   /**
    * Transforms the given field name to indicate its value is encrypted, by prefixing it with this
    * crypto manager's encrypted field prefix.
@@ -127,9 +196,22 @@ public:
    */
   auto is_mangled(const std::string& field_name) -> bool override;
 
+  /**
+   * Passes the key IDs of each algorithm on to the decrypter registered for it. Algorithms without
+   * a decrypter are ignored, their fields fail to decrypt later.
+   *
+   * @param key_ids_by_algorithm the IDs of the keys, by algorithm name
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  void prefetch_keys(const std::map<std::string, std::vector<std::string>>& key_ids_by_algorithm)
+    override;
+
 private:
   std::string encrypted_field_name_prefix_;
   std::map<std::string, std::shared_ptr<encrypter>> alias_to_encrypter_{};
   std::map<std::string, std::shared_ptr<decrypter>> algorithm_to_decrypter_{};
+  std::map<std::string, std::shared_ptr<blind_indexer>> alias_to_blind_indexer_{};
 };
 } // namespace couchbase::crypto
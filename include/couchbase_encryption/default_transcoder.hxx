@@ -31,6 +31,24 @@ namespace crypto
  * @committed
  */
 using default_transcoder = transcoder<codec::tao_json_serializer>;
+
+/**
+ * A couchbase::crypto::transcoder that uses the couchbase::codec::tao_json_serializer for encoding
+ * and decoding documents, and stores them as CBOR.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+using cbor_transcoder = transcoder<codec::tao_json_serializer, document_format::cbor>;
+
+/**
+ * A couchbase::crypto::transcoder that uses the couchbase::codec::tao_json_serializer for encoding
+ * and decoding documents, and stores them as MessagePack.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+using msgpack_transcoder = transcoder<codec::tao_json_serializer, document_format::msgpack>;
 } // namespace crypto
 } // namespace couchbase
 
@@ -44,4 +62,23 @@ template<>
 struct couchbase::codec::is_crypto_transcoder<couchbase::crypto::default_transcoder>
   : public std::true_type {
 };
+
+template<>
+struct couchbase::codec::is_transcoder<couchbase::crypto::cbor_transcoder> : public std::true_type {
+};
+
+template<>
+struct couchbase::codec::is_crypto_transcoder<couchbase::crypto::cbor_transcoder>
+  : public std::true_type {
+};
+
+template<>
+struct couchbase::codec::is_transcoder<couchbase::crypto::msgpack_transcoder>
+  : public std::true_type {
+};
+
+template<>
+struct couchbase::codec::is_crypto_transcoder<couchbase::crypto::msgpack_transcoder>
+  : public std::true_type {
+};
 #endif
@@ -53,6 +53,8 @@ public:
    * @param field_path the path to the field that should be encrypted as it appears in the
    * serialized document, e.g. {"address", "street"}
    * @param encrypter_alias the alias of the encrypter that should be used to encrypt the field
+   * @param blind_index if set, a blind index token is stored alongside the encrypted field
+   * @param envelope how the encrypted field is stored in the document
    * @return this document, for chaining purposes
    *
    * @note Only fields of JSON objects can be encrypted.
@@ -61,10 +63,12 @@ public:
    * @committed
    */
   auto with_encrypted_field(std::vector<std::string> field_path,
-                            std::optional<std::string> encrypter_alias = {}) -> document&
+                            std::optional<std::string> encrypter_alias = {},
+                            std::optional<blind_index_options> blind_index = {},
+                            envelope_format envelope = envelope_format::object) -> document&
   {
-    encrypted_fields_.emplace_back(
-      encrypted_field{ std::move(field_path), std::move(encrypter_alias) });
+    encrypted_fields_.emplace_back(encrypted_field{
+      std::move(field_path), std::move(encrypter_alias), std::move(blind_index), envelope });
     return *this;
   }
 
@@ -8,22 +8,106 @@
 
 #pragma once
 
+#include <cstddef>
 #include <optional>
 #include <string>
 #include <vector>
 
 namespace couchbase::crypto
 {
+/**
+ * Specifies that a blind index token should be stored alongside an encrypted field.
+ *
+ * The token is a keyed hash (e.g. HMAC-SHA512) of the field's plaintext, computed by the
+ * couchbase::crypto::blind_indexer registered with the couchbase::crypto::manager under the given
+ * alias. It is stored in the encrypted node as the `bix` member, so that the server can index it
+ * and documents can be matched by equality without decrypting them, e.g.
+ * `WHERE encrypted$ssn.bix = $token`. Tokens for queries are computed with
+ * couchbase::crypto::blind_index_token().
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+struct blind_index_options {
+  /**
+   * The alias of the blind indexer that should be used to compute the token. If no alias is
+   * specified, the default blind indexer is used.
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  std::optional<std::string> indexer_alias{};
+
+  /**
+   * The number of bytes of the keyed hash to keep in the token, or zero to keep all of it.
+   * Truncating the token makes it smaller, at the cost of more false positives when matching.
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  std::size_t length{ 0 };
+
+  auto operator==(const blind_index_options& other) const -> bool
+  {
+    return indexer_alias == other.indexer_alias && length == other.length;
+  }
+};
+
+/**
+ * How an encrypted field is stored in a document.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+enum class envelope_format {
+  /**
+   * An object with the `alg`, `kid` and `ciphertext` members, which can be read by every FLE
+   * implementation.
+   */
+  object,
+
+  /**
+   * A single string `<algorithm id>:<key ID>:<ciphertext>`, with the ciphertext in base64, and a
+   * short numeric ID standing for the algorithm name: `1` for AEAD_AES_256_CBC_HMAC_SHA512 and `2`
+   * for AEAD_AES_SIV_CMAC_512. This saves almost 60 bytes per field, but can only be read by this
+   * library, from version 1.1.0.
+   *
+   * Fields that have a blind index, or whose encrypter stores more than these three members (e.g.
+   * with compression) or uses another algorithm, are stored as objects.
+   */
+  compact,
+};
+
 /**
  * Represents an individual field that should be encrypted in a document.
  *
- * @note Only fields of JSON objects can be encrypted.
+ * @note Only fields of JSON objects can be encrypted. Array elements cannot be encrypted
+ * individually, but fields of objects nested in arrays can.
+ *
+ * @note The members added in 1.1.0 change the size and layout of the structure, so code that uses
+ * it must be recompiled against the 1.1.0 headers.
  */
 struct encrypted_field {
   /**
    * The path to the field that should be encrypted, as it appears in the serialized document
    * e.g. {"address", "street"}.
    *
+   * Since 1.1.0, a segment can also be:
+   * - `*`, which matches every member of an object or every element of an array, e.g.
+   *   {"contacts", "*", "phone"}. Values that do not contain the rest of the path are skipped.
+   *   A wildcard also matches the members named by other paths, whatever the order in which the
+   *   fields are listed: with {"accounts", "*", "pin"} and {"accounts", "checking"}, the pin of
+   *   the checking account is encrypted, then the account itself. A member that both a wildcard
+   *   and another path would encrypt is encrypted once, with the settings of the other path.
+   * - a decimal number in square brackets, which matches the element at that index of an array,
+   *   e.g. {"contacts", "[0]", "phone"}. Any other segment, including a decimal number without
+   *   brackets, is the name of an object member, e.g. {"codes", "1"} for `{"codes": {"1": ...}}`.
+   *
+   * There is no escape for these segments: since 1.1.0, an object member literally named `*`, or
+   * named like an array index (e.g. `[0]`), cannot be encrypted on its own. A `*` segment matches
+   * all of its siblings too, and `[0]` only matches an array element. Encrypt the parent object
+   * instead, or all of its members with a wildcard.
+   *
    * @since 1.0.0
    * @committed
    */
@@ -41,9 +125,28 @@ struct encrypted_field {
    */
   std::optional<std::string> encrypter_alias{};
 
+  /**
+   * If set, a blind index token is computed from the plaintext of the field and stored alongside
+   * its ciphertext.
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  std::optional<blind_index_options> blind_index{};
+
+  /**
+   * How the encrypted field is stored in the document. Fields can be decrypted whatever their
+   * envelope.
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  envelope_format envelope{ envelope_format::object };
+
   auto operator==(const encrypted_field& other) const -> bool
   {
-    return field_path == other.field_path && encrypter_alias == other.encrypter_alias;
+    return field_path == other.field_path && encrypter_alias == other.encrypter_alias &&
+           blind_index == other.blind_index && envelope == other.envelope;
   }
 };
 
@@ -11,6 +11,8 @@
 #include <couchbase/error.hxx>
 #include <couchbase_encryption/encryption_result.hxx>
 
+#include <cstddef>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -47,5 +49,26 @@ public:
    * @committed
    */
   virtual auto encrypt(std::vector<std::byte> plaintext) -> std::pair<error, encryption_result> = 0;
+
+  /**
+   * Returns the encryption result that encrypt() would produce for a plaintext of the given size,
+   * except that every byte of its ciphertext is zero, without retrieving the key or encrypting
+   * anything. It is used to compute the size of encrypted documents ahead of time.
+   *
+   * The default implementation returns std::nullopt, which is also appropriate for encrypters
+   * whose ciphertext size depends on the contents of the plaintext.
+   *
+   * @param plaintext_size the size of the plaintext, in bytes
+   * @return the placeholder encryption result, or std::nullopt if its size cannot be known in
+   * advance
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  virtual auto placeholder(std::size_t plaintext_size) -> std::optional<encryption_result>
+  {
+    (void)plaintext_size;
+    return std::nullopt;
+  }
 };
 } // namespace couchbase::crypto
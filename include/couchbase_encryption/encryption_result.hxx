@@ -59,6 +59,17 @@ public:
    */
   [[nodiscard]] auto algorithm() const -> std::string;
 
+  /**
+   * Returns a reference to the algorithm that was used to produce this encryption result, which
+   * avoids copying it. The reference is valid as long as the encryption result is.
+   *
+   * @return the algorithm
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] auto algorithm_ref() const -> const std::string&;
+
   /**
    * Retrieves the value of a specific string field from the encryption result.
    *
@@ -94,6 +105,28 @@ public:
    */
   [[nodiscard]] auto as_map() const -> std::map<std::string, std::string>;
 
+  /**
+   * Returns a reference to the internal map representation of the encryption result, which avoids
+   * copying it. The reference is valid as long as the encryption result is.
+   *
+   * @return the encryption result as a map.
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] auto map_ref() const -> const std::map<std::string, std::string>&;
+
+  /**
+   * Moves the internal map representation out of the encryption result, e.g.
+   * `std::move(result).take_map()`. The encryption result must not be used afterwards.
+   *
+   * @return the encryption result as a map.
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] auto take_map() && -> std::map<std::string, std::string>;
+
   /**
    * Adds a new string field to the encryption result with the specified value.
    *
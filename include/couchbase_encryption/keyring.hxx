@@ -11,6 +11,10 @@
 #include <couchbase/error.hxx>
 #include <couchbase_encryption/key.hxx>
 
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace couchbase::crypto
 {
 /**
@@ -41,5 +45,46 @@ public:
    * @committed
    */
   [[nodiscard]] virtual auto get(const std::string& key_id) const -> std::pair<error, key> = 0;
+
+  /**
+   * Retrieves several keys from the keyring. Keyrings backed by a remote service should override
+   * this to retrieve the keys in a single request.
+   *
+   * The default implementation calls get() for each key.
+   *
+   * @param key_ids the IDs of the keys to retrieve
+   * @return for each key ID, in the same order, the key if found, or an error if retrieving the
+   * key failed
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] virtual auto get_many(const std::vector<std::string>& key_ids) const
+    -> std::vector<std::pair<error, key>>
+  {
+    std::vector<std::pair<error, key>> results{};
+    results.reserve(key_ids.size());
+    for (const auto& key_id : key_ids) {
+      results.push_back(get(key_id));
+    }
+    return results;
+  }
+
+  /**
+   * Hints that the keys with the given IDs are about to be used, e.g. when a service starts or a
+   * batch of documents is decoded, so that a keyring that caches keys can retrieve the missing ones
+   * ahead of time, in a single request. Errors are not reported, but returned by get() later.
+   *
+   * The default implementation does nothing.
+   *
+   * @param key_ids the IDs of the keys that are about to be used
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  virtual void prefetch(const std::vector<std::string>& key_ids) const
+  {
+    (void)key_ids;
+  }
 };
 } // namespace couchbase::crypto
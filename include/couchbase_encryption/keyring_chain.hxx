@@ -0,0 +1,86 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#pragma once
+
+#include <couchbase_encryption/key.hxx>
+#include <couchbase_encryption/keyring.hxx>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace couchbase::crypto
+{
+/**
+ * A keyring that consults an ordered list of keyrings, returning the key from the first keyring
+ * that has it, e.g. a local keyring, followed by a couchbase::crypto::caching_keyring in front of a
+ * remote key management service.
+ *
+ * A keyring in the chain is only skipped if it reports that the key could not be found
+ * (couchbase::errc::field_level_encryption::crypto_key_not_found). Any other error stops the
+ * lookup and is returned to the caller.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+class keyring_chain : public keyring
+{
+public:
+  /**
+   * Constructs a keyring chain from the given keyrings.
+   *
+   * @param keyrings the keyrings to consult, in order
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  explicit keyring_chain(std::vector<std::shared_ptr<keyring>> keyrings);
+
+  /**
+   * Retrieves a key from the first keyring in the chain that contains it.
+   *
+   * @param key_id the ID of the key to retrieve
+   * @return the key if found, or an error if retrieving the key failed
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] auto get(const std::string& key_id) const -> std::pair<error, key> override;
+
+  /**
+   * Retrieves several keys, each from the first keyring in the chain that contains it. Each keyring
+   * is asked once, with a single call to its get_many(), for the keys that the keyrings before it
+   * did not have.
+   *
+   * @param key_ids the IDs of the keys to retrieve
+   * @return for each key ID, in the same order, the key if found, or an error if retrieving the
+   * key failed
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] auto get_many(const std::vector<std::string>& key_ids) const
+    -> std::vector<std::pair<error, key>> override;
+
+  /**
+   * Retrieves the keys with the given IDs through the chain, so that caching keyrings in the chain
+   * hold them when they are used.
+   *
+   * @param key_ids the IDs of the keys that are about to be used
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  void prefetch(const std::vector<std::string>& key_ids) const override;
+
+private:
+  std::vector<std::shared_ptr<keyring>> keyrings_;
+};
+} // namespace couchbase::crypto
@@ -9,13 +9,16 @@
 #pragma once
 
 #include <couchbase/error.hxx>
+#include <couchbase/error_codes.hxx>
 #include <couchbase_encryption/decrypter.hxx>
 #include <couchbase_encryption/encrypter.hxx>
 #include <couchbase_encryption/encryption_result.hxx>
 #include <couchbase_encryption/keyring.hxx>
 
+#include <cstddef>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -92,5 +95,95 @@ public:
    * @committed
    */
   virtual auto is_mangled(const std::string& field_name) -> bool = 0;
+
+  // the functions added since 1.0.0 follow the committed ones, so that their vtable slots stay put
+
+  /**
+   * Computes the keyed hash used as a blind index for the given plaintext, using the blind indexer
+   * associated with the given alias, or the default blind indexer if no alias is given.
+   *
+   * The default implementation reports that blind indexes are not supported.
+   *
+   * @param plaintext the message to compute the blind index for
+   * @param indexer_alias the alias of the blind indexer to use, or std::nullopt to use the default
+   * @return the keyed hash, or an error if it could not be computed
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  virtual auto blind_index(const std::vector<std::byte>& plaintext,
+                           const std::optional<std::string>& indexer_alias)
+    -> std::pair<error, std::vector<std::byte>>
+  {
+    (void)plaintext;
+    (void)indexer_alias;
+    return { error{ errc::field_level_encryption::generic_cryptography_failure,
+                    "blind indexes are not supported by this crypto manager" },
+             {} };
+  }
+
+  /**
+   * Hints that fields encrypted with the given keys are about to be decrypted, e.g. before decoding
+   * a batch of documents, so that each decrypter can retrieve the missing keys ahead of time, in a
+   * single request.
+   *
+   * The default implementation does nothing.
+   *
+   * @param key_ids_by_algorithm the IDs of the keys, by algorithm name
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  virtual void prefetch_keys(const std::map<std::string, std::vector<std::string>>&
+                               key_ids_by_algorithm)
+  {
+    (void)key_ids_by_algorithm;
+  }
+
+  /**
+   * Returns the encrypted node that encrypt() would produce for a plaintext of the given size,
+   * except that every byte of its ciphertext is zero, without retrieving any key or encrypting
+   * anything. It is used to compute the size of encrypted documents ahead of time.
+   *
+   * The default implementation reports that size estimates are not supported.
+   *
+   * @param plaintext_size the size of the plaintext, in bytes
+   * @param encrypter_alias the alias of the encrypter to use, or std::nullopt to use the default
+   * @return the placeholder encrypted node, or an error if its size cannot be known in advance
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  virtual auto placeholder(std::size_t plaintext_size,
+                           const std::optional<std::string>& encrypter_alias)
+    -> std::pair<error, std::map<std::string, std::string>>
+  {
+    (void)plaintext_size;
+    (void)encrypter_alias;
+    return { error{ errc::field_level_encryption::generic_cryptography_failure,
+                    "size estimates are not supported by this crypto manager" },
+             {} };
+  }
+
+  /**
+   * Returns the size of the keyed hashes that blind_index() computes with the blind indexer
+   * associated with the given alias, without retrieving its key.
+   *
+   * The default implementation reports that size estimates are not supported.
+   *
+   * @param indexer_alias the alias of the blind indexer to use, or std::nullopt to use the default
+   * @return the size of the keyed hashes, in bytes, or an error if it cannot be known in advance
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  virtual auto blind_index_size(const std::optional<std::string>& indexer_alias)
+    -> std::pair<error, std::size_t>
+  {
+    (void)indexer_alias;
+    return { error{ errc::field_level_encryption::generic_cryptography_failure,
+                    "size estimates are not supported by this crypto manager" },
+             {} };
+  }
 };
 } // namespace couchbase::crypto
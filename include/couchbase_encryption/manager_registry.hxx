@@ -0,0 +1,173 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#pragma once
+
+#include <couchbase/error.hxx>
+#include <couchbase_encryption/blind_indexer.hxx>
+#include <couchbase_encryption/decrypter.hxx>
+#include <couchbase_encryption/encrypter.hxx>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+namespace couchbase::crypto
+{
+/**
+ * Encrypters, decrypters and blind indexers shared by many crypto managers, typically the
+ * couchbase::crypto::manager_view instances of the tenants of a service.
+ *
+ * Encrypters for a key are created by the registered encrypter factory the first time a manager
+ * asks for that key, and then shared by every manager that uses the key.
+ *
+ * Registering and looking up are thread-safe, but registration is expected to be done before the
+ * registry is shared.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+class manager_registry
+{
+public:
+  /**
+   * Creates the encrypter for the key with the given ID, e.g.
+   * couchbase::crypto::aead_aes_256_cbc_hmac_sha512_provider::encrypter_for_key.
+   */
+  using encrypter_factory = std::function<std::shared_ptr<encrypter>(const std::string& key_id)>;
+
+  /**
+   * Registers the factory used to create the encrypters for keys, replacing any previous factory.
+   *
+   * @param factory the factory to register
+   * @return an error if the registration failed
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  auto register_encrypter_factory(encrypter_factory factory) -> error;
+
+  /**
+   * Registers an encrypter and associates it with the given alias, for every manager that does
+   * not map this alias to a key of its own.
+   *
+   * @param alias the alias to associate with the encrypter
+   * @param encrypter the encrypter to register
+   * @return an error if the registration failed
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  auto register_encrypter(std::string alias, std::shared_ptr<encrypter> encrypter) -> error;
+
+  /**
+   * Registers the encrypter used by managers that have no default key of their own.
+   *
+   * @param encrypter the default encrypter to register
+   * @return an error if the registration failed
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  auto register_default_encrypter(std::shared_ptr<encrypter> encrypter) -> error;
+
+  /**
+   * Registers a decrypter.
+   *
+   * @param decrypter the decrypter to register
+   * @return an error if the registration failed
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  auto register_decrypter(std::shared_ptr<decrypter> decrypter) -> error;
+
+  /**
+   * Registers a blind indexer and associates it with the given alias.
+   *
+   * @param alias the alias to associate with the blind indexer
+   * @param indexer the blind indexer to register
+   * @return an error if the registration failed
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  auto register_blind_indexer(std::string alias, std::shared_ptr<blind_indexer> indexer) -> error;
+
+  /**
+   * Registers the blind indexer used if no indexer alias is specified in the blind index options
+   * of a field.
+   *
+   * @param indexer the default blind indexer to register
+   * @return an error if the registration failed
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  auto register_default_blind_indexer(std::shared_ptr<blind_indexer> indexer) -> error;
+
+  /**
+   * Returns the encrypter for the key with the given ID, creating it on first use.
+   *
+   * @param key_id the ID of the key
+   * @return the encrypter, or nullptr if no encrypter factory is registered
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] auto encrypter_for_key(const std::string& key_id) const
+    -> std::shared_ptr<encrypter>;
+
+  /**
+   * Returns the encrypter registered with the given alias.
+   *
+   * @param alias the alias of the encrypter
+   * @return the encrypter, or nullptr if there is none
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] auto encrypter_for_alias(const std::string& alias) const
+    -> std::shared_ptr<encrypter>;
+
+  /**
+   * Returns the decrypter registered for the given algorithm.
+   *
+   * @param algorithm the name of the algorithm
+   * @return the decrypter, or nullptr if there is none
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] auto decrypter_for_algorithm(const std::string& algorithm) const
+    -> std::shared_ptr<decrypter>;
+
+  /**
+   * Returns the blind indexer registered with the given alias.
+   *
+   * @param alias the alias of the blind indexer
+   * @return the blind indexer, or nullptr if there is none
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  [[nodiscard]] auto blind_indexer_for_alias(const std::string& alias) const
+    -> std::shared_ptr<blind_indexer>;
+
+private:
+  mutable std::shared_mutex mutex_{};
+  encrypter_factory encrypter_factory_{};
+  mutable std::unordered_map<std::string, std::shared_ptr<encrypter>> key_id_to_encrypter_{};
+  std::map<std::string, std::shared_ptr<encrypter>> alias_to_encrypter_{};
+  std::map<std::string, std::shared_ptr<decrypter>> algorithm_to_decrypter_{};
+  std::map<std::string, std::shared_ptr<blind_indexer>> alias_to_blind_indexer_{};
+};
+} // namespace couchbase::crypto
@@ -0,0 +1,110 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#pragma once
+
+#include <couchbase/error.hxx>
+#include <couchbase_encryption/default_manager.hxx>
+#include <couchbase_encryption/manager.hxx>
+#include <couchbase_encryption/manager_registry.hxx>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace couchbase::crypto
+{
+/**
+ * A crypto manager that only holds its encrypted field name prefix and the IDs of the keys its
+ * encrypter aliases refer to. Everything else, including the encrypters for those keys, comes from
+ * a couchbase::crypto::manager_registry shared with other views.
+ *
+ * This makes it cheap to create a manager per tenant of a service, where each tenant has its own
+ * keys and field name prefix but the same algorithms and keyrings.
+ *
+ * Aliases that the view does not map to a key fall back to the encrypters registered with the
+ * registry.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+class manager_view : public manager
+{
+public:
+  /**
+   * Constructs a view of the given registry.
+   *
+   * @param registry the registry that provides the encrypters, decrypters and blind indexers
+   * @param encrypted_field_name_prefix the prefix to use for encrypted field names
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  explicit manager_view(
+    std::shared_ptr<const manager_registry> registry,
+    std::string encrypted_field_name_prefix = default_manager::default_encrypted_field_name_prefix);
+
+  /**
+   * Maps an encrypter alias of this view to a key, whose encrypter is created by the registry.
+   *
+   * @param alias the encrypter alias
+   * @param key_id the ID of the key to encrypt with
+   * @return an error if the mapping failed
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  auto register_key(std::string alias, std::string key_id) -> error;
+
+  /**
+   * Sets the key used if no encrypter alias is specified for a field.
+   *
+   * @param key_id the ID of the key to encrypt with
+   * @return an error if the mapping failed
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  auto register_default_key(std::string key_id) -> error;
+
+  auto encrypt(std::vector<std::byte> plaintext, const std::optional<std::string>& encrypter_alias)
+    -> std::pair<error, std::map<std::string, std::string>> override;
+
+  auto decrypt(std::map<std::string, std::string> encrypted_node)
+    -> std::pair<error, std::vector<std::byte>> override;
+
+  auto blind_index(const std::vector<std::byte>& plaintext,
+                   const std::optional<std::string>& indexer_alias)
+    -> std::pair<error, std::vector<std::byte>> override;
+
+  auto placeholder(std::size_t plaintext_size, const std::optional<std::string>& encrypter_alias)
+    -> std::pair<error, std::map<std::string, std::string>> override;
+
+  auto blind_index_size(const std::optional<std::string>& indexer_alias)
+    -> std::pair<error, std::size_t> override;
+
+  auto mangle(std::string field_name) -> std::string override;
+
+  auto demangle(std::string field_name) -> std::string override;
+
+  auto is_mangled(const std::string& field_name) -> bool override;
+
+  void prefetch_keys(const std::map<std::string, std::vector<std::string>>& key_ids_by_algorithm)
+    override;
+
+private:
+  [[nodiscard]] auto select_encrypter(const std::string& alias) const
+    -> std::pair<error, std::shared_ptr<encrypter>>;
+
+  std::shared_ptr<const manager_registry> registry_;
+  std::string encrypted_field_name_prefix_;
+  // views have few aliases, which are cheaper to scan than to hash
+  std::vector<std::pair<std::string, std::string>> alias_to_key_id_{};
+};
+} // namespace couchbase::crypto
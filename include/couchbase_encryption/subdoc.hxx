@@ -0,0 +1,93 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#pragma once
+
+#include <couchbase/codec/encoded_value.hxx>
+#include <couchbase/error.hxx>
+#include <couchbase_encryption/encrypted_fields.hxx>
+#include <couchbase_encryption/manager.hxx>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Helpers to read and write individual encrypted fields with the sub-document API (`lookup_in` and
+ * `mutate_in`), without fetching and replacing the whole document.
+ *
+ * For example, to update an encrypted field:
+ *
+ * @code{.cpp}
+ * auto [path_err, path] = couchbase::crypto::subdoc::encrypted_path(field.field_path, manager);
+ * auto [enc_err, node] = couchbase::crypto::subdoc::encrypt_value(field, new_value, manager);
+ * auto node_json = couchbase::codec::tao_json_serializer::deserialize<tao::json::value>(node);
+ * collection.mutate_in(id, couchbase::mutate_in_specs{
+ *   couchbase::mutate_in_specs::upsert(path, node_json),
+ * });
+ * @endcode
+ *
+ * And to read it, look up the same path and pass the returned value to decrypt_value().
+ */
+namespace couchbase::crypto::subdoc
+{
+/**
+ * Returns the sub-document path of the encrypted node for the field at the given path, e.g.
+ * `address.encrypted$street` for {"address", "street"}.
+ *
+ * Array index segments, e.g. `[1]`, become array indexes, and every other segment the name of an
+ * object member, exactly as when the whole document is encoded with couchbase::crypto::transcoder.
+ * Names that contain characters with a special meaning in sub-document paths are escaped. Wildcard
+ * segments are not allowed, as a sub-document path addresses a single value.
+ *
+ * @param field_path the path of the field, as used in couchbase::crypto::encrypted_field
+ * @param crypto_manager the crypto manager, which determines the name of the encrypted field
+ * @return the sub-document path, or an error if the path cannot be expressed as one
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+auto
+encrypted_path(const std::vector<std::string>& field_path,
+               const std::shared_ptr<manager>& crypto_manager) -> std::pair<error, std::string>;
+
+/**
+ * Encrypts a value for the given field, and returns the encrypted node to store at its
+ * encrypted_path(), e.g. with an upsert sub-document operation.
+ *
+ * The encrypter alias and blind index options of the field are applied, exactly as when the whole
+ * document is encoded with couchbase::crypto::transcoder.
+ *
+ * @param field the field to encrypt
+ * @param value the JSON-encoded value of the field
+ * @param crypto_manager the crypto manager to encrypt the value with
+ * @return the JSON-encoded encrypted node, or an error if encryption failed
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+auto
+encrypt_value(const encrypted_field& field,
+              const codec::binary& value,
+              const std::shared_ptr<manager>& crypto_manager) -> std::pair<error, codec::binary>;
+
+/**
+ * Decrypts an encrypted node, e.g. one returned by a lookup of an encrypted_path().
+ *
+ * @param encrypted_node the JSON-encoded encrypted node
+ * @param crypto_manager the crypto manager to decrypt the value with
+ * @return the JSON-encoded value of the field, or an error if decryption failed
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+auto
+decrypt_value(const codec::binary& encrypted_node, const std::shared_ptr<manager>& crypto_manager)
+  -> std::pair<error, codec::binary>;
+} // namespace couchbase::crypto::subdoc
@@ -10,23 +10,116 @@
 
 #include <couchbase/codec/codec_flags.hxx>
 #include <couchbase/codec/encoded_value.hxx>
+#include <couchbase/error.hxx>
 #include <couchbase/error_codes.hxx>
+#include <couchbase_encryption/crypto_executor.hxx>
+#include <couchbase_encryption/decode_handle.hxx>
 #include <couchbase_encryption/document.hxx>
 #include <couchbase_encryption/manager.hxx>
 
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
 namespace couchbase::crypto
 {
+/**
+ * The format in which a couchbase::crypto::transcoder stores documents.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+enum class document_format {
+  /**
+   * JSON, with base64-encoded ciphertext. Documents are stored with JSON common flags.
+   */
+  json,
+
+  /**
+   * CBOR (RFC 8949), with the ciphertext stored as a byte string. Documents are stored with binary
+   * common flags.
+   */
+  cbor,
+
+  /**
+   * MessagePack, with the ciphertext stored as a bin value. Documents are stored with binary
+   * common flags.
+   */
+  msgpack,
+};
+
+/**
+ * The outcome of decrypting one encrypted field of a document decoded with
+ * couchbase::crypto::transcoder::decode_partially.
+ *
+ * @since 1.1.0
+ * @uncommitted
+ */
+struct field_decryption_status {
+  /**
+   * The JSON pointer to the field in the decoded document. The last token is the demangled name of
+   * the field if it was decrypted, and its mangled name if it was left encrypted.
+   */
+  std::string pointer{};
+
+  /**
+   * Why the field could not be decrypted, or no error if it was decrypted.
+   */
+  error err{};
+};
+
 #ifndef COUCHBASE_CXX_ENCRYPTION_DOXYGEN
 namespace internal
 {
 auto
 encrypt(const codec::binary& raw,
         const std::vector<encrypted_field>& encrypted_fields,
-        const std::shared_ptr<manager>& crypto_manager) -> std::pair<error, codec::binary>;
+        const std::shared_ptr<manager>& crypto_manager,
+        document_format format = document_format::json,
+        const decode_state* previous_state = nullptr) -> std::pair<error, codec::binary>;
+
+auto
+encoded_size(const codec::binary& raw,
+             const std::vector<encrypted_field>& encrypted_fields,
+             const std::shared_ptr<manager>& crypto_manager,
+             document_format format = document_format::json) -> std::pair<error, std::size_t>;
+
+auto
+decrypt(const codec::binary& encrypted,
+        const std::shared_ptr<manager>& crypto_manager,
+        document_format format = document_format::json,
+        decode_state* state = nullptr,
+        std::vector<field_decryption_status>* statuses = nullptr)
+  -> std::pair<error, codec::binary>;
 
 auto
-decrypt(const codec::binary& encrypted, const std::shared_ptr<manager>& crypto_manager)
+decrypt(const codec::binary& encrypted,
+        const std::vector<encrypted_field>& encrypted_fields,
+        const std::shared_ptr<manager>& crypto_manager,
+        document_format format = document_format::json,
+        decode_state* state = nullptr,
+        std::vector<field_decryption_status>* statuses = nullptr)
   -> std::pair<error, codec::binary>;
+
+auto
+decrypt_many(const std::vector<codec::encoded_value>& encrypted,
+             const std::shared_ptr<manager>& crypto_manager,
+             document_format format = document_format::json)
+  -> std::vector<std::pair<error, codec::binary>>;
+
+constexpr auto
+common_flags(document_format format) -> std::uint32_t
+{
+  return format == document_format::json ? codec::codec_flags::json_common_flags
+                                         : codec::codec_flags::binary_common_flags;
+}
 } // namespace internal
 #endif
 
@@ -35,12 +128,19 @@ decrypt(const codec::binary& encrypted, const std::shared_ptr<manager>& crypto_m
  * crypto manager as a parameter when encoding and decoding documents, and is used to encrypt or
  * decrypt fields.
  *
+ * The serializer always produces and consumes JSON, and the fields are always encrypted as JSON, so
+ * that they can be decrypted by any FLE implementation. With a binary document format, the
+ * transcoder converts the encrypted document to that format, and stores the ciphertext as native
+ * binary data instead of base64. Such documents can only be read by a transcoder using the same
+ * format, and must not contain binary data outside of the encrypted fields.
+ *
  * @tparam Serializer The serializer to use for encoding and decoding documents.
+ * @tparam Format The format in which the documents are stored (since 1.1.0).
  *
  * @since 1.0.0
  * @committed
  */
-template<typename Serializer>
+template<typename Serializer, document_format Format = document_format::json>
 class transcoder
 {
 public:
@@ -48,62 +148,842 @@ public:
   static auto encode(const document<DocumentType>& document,
                      const std::shared_ptr<manager>& crypto_manager) -> codec::encoded_value
   {
+    return encode_with_state(
+      Serializer::serialize(document.content()), document.encrypted_fields(), crypto_manager);
+  }
+
+  /**
+   * Encodes a document that was previously decoded with the given handle, reusing the encrypted
+   * nodes of the fields that have not changed since.
+   *
+   * @param document the document to encode
+   * @param crypto_manager the crypto manager to encrypt the changed fields with
+   * @param handle the handle the document was decoded with
+   * @return the encoded document
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  template<typename DocumentType>
+  static auto encode(const document<DocumentType>& document,
+                     const std::shared_ptr<manager>& crypto_manager,
+                     const decode_handle& handle) -> codec::encoded_value
+  {
+    return encode_with_state(Serializer::serialize(document.content()),
+                             document.encrypted_fields(),
+                             crypto_manager,
+                             handle.state_.get());
+  }
+
+  template<typename Document>
+  static auto encode(Document document, const std::shared_ptr<manager>& crypto_manager)
+    -> codec::encoded_value
+  {
+    return encode_with_state(
+      Serializer::serialize(document), encrypted_fields_of<Document>(), crypto_manager);
+  }
+
+  /**
+   * Encodes a document that was previously decoded with the given handle, reusing the encrypted
+   * nodes of the fields that have not changed since.
+   *
+   * @tparam Document the type of the document, which lists its encrypted fields
+   * @param document the document to encode
+   * @param crypto_manager the crypto manager to encrypt the changed fields with
+   * @param handle the handle the document was decoded with
+   * @return the encoded document
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  template<typename Document>
+  static auto encode(Document document,
+                     const std::shared_ptr<manager>& crypto_manager,
+                     const decode_handle& handle) -> codec::encoded_value
+  {
+    return encode_with_state(Serializer::serialize(document),
+                             encrypted_fields_of<Document>(),
+                             crypto_manager,
+                             handle.state_.get());
+  }
+
+  template<typename Document>
+  static auto decode(const codec::encoded_value& encoded,
+                     const std::shared_ptr<manager>& crypto_manager) -> Document
+  {
+    check_decode_preconditions(encoded, crypto_manager);
+    return deserialize_or_throw<Document>(internal::decrypt(encoded.data, crypto_manager, Format));
+  }
+
+  /**
+   * Decodes a document, decrypting only the fields at the given paths.
+   *
+   * Unlike decode(), which searches the whole document for encrypted fields, this only visits the
+   * given paths, which is much cheaper for large documents. Encrypted fields at other paths are
+   * left encrypted.
+   *
+   * @tparam Document the type to deserialize the document into
+   * @param encoded the encoded document
+   * @param crypto_manager the crypto manager to decrypt the fields with
+   * @param encrypted_fields the fields that may be encrypted, e.g. Document::encrypted_fields
+   * @return the decoded document
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  template<typename Document>
+  static auto decode(const codec::encoded_value& encoded,
+                     const std::shared_ptr<manager>& crypto_manager,
+                     const std::vector<encrypted_field>& encrypted_fields) -> Document
+  {
+    check_decode_preconditions(encoded, crypto_manager);
+    return deserialize_or_throw<Document>(
+      internal::decrypt(encoded.data, encrypted_fields, crypto_manager, Format));
+  }
+
+  /**
+   * Decodes a document, and remembers its encrypted fields in the given handle, so that they can
+   * be reused when the document is encoded again with the same handle. Anything the handle
+   * remembered from a previous decode is forgotten.
+   *
+   * @tparam Document the type to deserialize the document into
+   * @param encoded the encoded document
+   * @param crypto_manager the crypto manager to decrypt the fields with
+   * @param handle the handle to remember the encrypted fields in
+   * @return the decoded document
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  template<typename Document>
+  static auto decode(const codec::encoded_value& encoded,
+                     const std::shared_ptr<manager>& crypto_manager,
+                     decode_handle& handle) -> Document
+  {
+    check_decode_preconditions(encoded, crypto_manager);
+    return deserialize_or_throw<Document>(decrypt_into_handle(encoded, crypto_manager, handle));
+  }
+
+  /**
+   * Decodes a document, decrypting the fields that can be decrypted, and leaving the others
+   * encrypted, e.g. when the key of a field is not available. The outcome of decrypting each
+   * field is appended to the given list, so that callers can tell which fields they got, instead of
+   * retrying the whole document.
+   *
+   * The Document type must accept the encrypted nodes that are left in the document, e.g.
+   * tao::json::value.
+   *
+   * @tparam Document the type to deserialize the document into
+   * @param encoded the encoded document
+   * @param crypto_manager the crypto manager to decrypt the fields with
+   * @param statuses the list to append the outcome of decrypting each encrypted field to
+   * @return the decoded document
+   * @throws std::system_error if the document itself cannot be decoded
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  template<typename Document>
+  static auto decode_partially(const codec::encoded_value& encoded,
+                               const std::shared_ptr<manager>& crypto_manager,
+                               std::vector<field_decryption_status>& statuses) -> Document
+  {
+    check_decode_preconditions(encoded, crypto_manager);
+    return deserialize_or_throw<Document>(
+      internal::decrypt(encoded.data, crypto_manager, Format, nullptr, &statuses));
+  }
+
+  /**
+   * Decodes a document like decode_partially(), but only visits the fields at the given paths.
+   *
+   * @tparam Document the type to deserialize the document into
+   * @param encoded the encoded document
+   * @param crypto_manager the crypto manager to decrypt the fields with
+   * @param encrypted_fields the fields that may be encrypted, e.g. Document::encrypted_fields
+   * @param statuses the list to append the outcome of decrypting each encrypted field to
+   * @return the decoded document
+   * @throws std::system_error if the document itself cannot be decoded
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  template<typename Document>
+  static auto decode_partially(const codec::encoded_value& encoded,
+                               const std::shared_ptr<manager>& crypto_manager,
+                               const std::vector<encrypted_field>& encrypted_fields,
+                               std::vector<field_decryption_status>& statuses) -> Document
+  {
+    check_decode_preconditions(encoded, crypto_manager);
+    return deserialize_or_throw<Document>(internal::decrypt(
+      encoded.data, encrypted_fields, crypto_manager, Format, nullptr, &statuses));
+  }
+
+  /**
+   * Decodes a batch of documents. The encrypted fields of all documents are found first, and the
+   * crypto manager is asked to retrieve the keys they were encrypted with ahead of time (see
+   * couchbase::crypto::manager::prefetch_keys), so that a keyring backed by a remote service is
+   * called once for the batch rather than once for each key the documents use.
+   *
+   * @tparam Document the type to deserialize the documents into
+   * @param encoded the encoded documents
+   * @param crypto_manager the crypto manager to decrypt the fields with
+   * @return the decoded documents, in the same order
+   * @throws std::system_error if any document cannot be decoded
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  template<typename Document>
+  static auto decode_many(const std::vector<codec::encoded_value>& encoded,
+                          const std::shared_ptr<manager>& crypto_manager) -> std::vector<Document>
+  {
+    for (const auto& value : encoded) {
+      check_decode_preconditions(value, crypto_manager);
+    }
+
+    auto results = internal::decrypt_many(encoded, crypto_manager, Format);
+    std::vector<Document> documents{};
+    documents.reserve(results.size());
+    for (auto& result : results) {
+      documents.push_back(deserialize_or_throw<Document>(std::move(result)));
+    }
+    return documents;
+  }
+
+  /**
+   * Encodes a document, reporting failures as an error instead of throwing, which is much cheaper
+   * when many documents fail, e.g. because a key was revoked.
+   *
+   * @param document the document to encode
+   * @param crypto_manager the crypto manager to encrypt the fields with
+   * @return the encoded document, or an error if it could not be encrypted
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  template<typename DocumentType>
+  static auto try_encode(const document<DocumentType>& document,
+                         const std::shared_ptr<manager>& crypto_manager)
+    -> std::pair<error, codec::encoded_value>
+  {
+    return try_encode_with_state(
+      Serializer::serialize(document.content()), document.encrypted_fields(), crypto_manager);
+  }
+
+  /**
+   * Encodes a document that was previously decoded with the given handle, reusing the encrypted
+   * nodes of the fields that have not changed since, and reporting failures as an error instead of
+   * throwing.
+   *
+   * @param document the document to encode
+   * @param crypto_manager the crypto manager to encrypt the changed fields with
+   * @param handle the handle the document was decoded with
+   * @return the encoded document, or an error if it could not be encrypted
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  template<typename DocumentType>
+  static auto try_encode(const document<DocumentType>& document,
+                         const std::shared_ptr<manager>& crypto_manager,
+                         const decode_handle& handle) -> std::pair<error, codec::encoded_value>
+  {
+    return try_encode_with_state(Serializer::serialize(document.content()),
+                                 document.encrypted_fields(),
+                                 crypto_manager,
+                                 handle.state_.get());
+  }
+
+  /**
+   * Encodes a document, reporting failures as an error instead of throwing.
+   *
+   * @tparam Document the type of the document, which lists its encrypted fields
+   * @param document the document to encode
+   * @param crypto_manager the crypto manager to encrypt the fields with
+   * @return the encoded document, or an error if it could not be encrypted
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  template<typename Document>
+  static auto try_encode(Document document, const std::shared_ptr<manager>& crypto_manager)
+    -> std::pair<error, codec::encoded_value>
+  {
+    return try_encode_with_state(
+      Serializer::serialize(document), encrypted_fields_of<Document>(), crypto_manager);
+  }
+
+  /**
+   * Encodes a document that was previously decoded with the given handle, reusing the encrypted
+   * nodes of the fields that have not changed since, and reporting failures as an error instead of
+   * throwing.
+   *
+   * @tparam Document the type of the document, which lists its encrypted fields
+   * @param document the document to encode
+   * @param crypto_manager the crypto manager to encrypt the changed fields with
+   * @param handle the handle the document was decoded with
+   * @return the encoded document, or an error if it could not be encrypted
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  template<typename Document>
+  static auto try_encode(Document document,
+                         const std::shared_ptr<manager>& crypto_manager,
+                         const decode_handle& handle) -> std::pair<error, codec::encoded_value>
+  {
+    return try_encode_with_state(Serializer::serialize(document),
+                                 encrypted_fields_of<Document>(),
+                                 crypto_manager,
+                                 handle.state_.get());
+  }
+
+  /**
+   * Computes the exact size of the document that encode() would produce, without retrieving any
+   * key or encrypting anything: the encrypted fields are replaced with encrypted nodes of the same
+   * size, including the IV, padding and authentication tag of their algorithm, the base64 encoding
+   * of the ciphertext, and their envelope. This can be used to check documents against a size
+   * limit, or for capacity planning.
+   *
+   * Every encrypter (and blind indexer) the document uses must be able to tell the size of its
+   * output in advance (see couchbase::crypto::encrypter::placeholder), which is not the case of
+   * encrypters that compress the plaintext.
+   *
+   * @param document the document to encode
+   * @param crypto_manager the crypto manager that would encrypt the fields
+   * @return the size of the encoded document in bytes, or an error if it cannot be computed
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  template<typename DocumentType>
+  static auto encoded_size(const document<DocumentType>& document,
+                           const std::shared_ptr<manager>& crypto_manager)
+    -> std::pair<error, std::size_t>
+  {
+    return encoded_size_of(
+      Serializer::serialize(document.content()), document.encrypted_fields(), crypto_manager);
+  }
+
+  /**
+   * Computes the exact size of the document that encode() would produce, without retrieving any
+   * key or encrypting anything.
+   *
+   * @tparam Document the type of the document, which lists its encrypted fields
+   * @param document the document to encode
+   * @param crypto_manager the crypto manager that would encrypt the fields
+   * @return the size of the encoded document in bytes, or an error if it cannot be computed
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  template<typename Document>
+  static auto encoded_size(const Document& document,
+                           const std::shared_ptr<manager>& crypto_manager)
+    -> std::pair<error, std::size_t>
+  {
+    return encoded_size_of(
+      Serializer::serialize(document), encrypted_fields_of<Document>(), crypto_manager);
+  }
+
+  /**
+   * Decodes a document, reporting failures as an error instead of throwing, which is much cheaper
+   * when many documents fail, e.g. because a key was revoked. Only the serializer may still throw,
+   * if the decrypted document does not match the requested type.
+   *
+   * @tparam Document the type to deserialize the document into, which must be default
+   * constructible
+   * @param encoded the encoded document
+   * @param crypto_manager the crypto manager to decrypt the fields with
+   * @return the decoded document, or an error if it could not be decrypted
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  template<typename Document>
+  static auto try_decode(const codec::encoded_value& encoded,
+                         const std::shared_ptr<manager>& crypto_manager)
+    -> std::pair<error, Document>
+  {
+    if (auto err = decode_preconditions(encoded, crypto_manager); err) {
+      return { std::move(err), {} };
+    }
+    return try_deserialize<Document>(internal::decrypt(encoded.data, crypto_manager, Format));
+  }
+
+  /**
+   * Decodes a document, decrypting only the fields at the given paths, and reporting failures as an
+   * error instead of throwing.
+   *
+   * @tparam Document the type to deserialize the document into, which must be default
+   * constructible
+   * @param encoded the encoded document
+   * @param crypto_manager the crypto manager to decrypt the fields with
+   * @param encrypted_fields the fields that may be encrypted, e.g. Document::encrypted_fields
+   * @return the decoded document, or an error if it could not be decrypted
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  template<typename Document>
+  static auto try_decode(const codec::encoded_value& encoded,
+                         const std::shared_ptr<manager>& crypto_manager,
+                         const std::vector<encrypted_field>& encrypted_fields)
+    -> std::pair<error, Document>
+  {
+    if (auto err = decode_preconditions(encoded, crypto_manager); err) {
+      return { std::move(err), {} };
+    }
+    return try_deserialize<Document>(
+      internal::decrypt(encoded.data, encrypted_fields, crypto_manager, Format));
+  }
+
+  /**
+   * Decodes a document, and remembers its encrypted fields in the given handle, reporting failures
+   * as an error instead of throwing. Anything the handle remembered from a previous decode is
+   * forgotten.
+   *
+   * @tparam Document the type to deserialize the document into, which must be default
+   * constructible
+   * @param encoded the encoded document
+   * @param crypto_manager the crypto manager to decrypt the fields with
+   * @param handle the handle to remember the encrypted fields in
+   * @return the decoded document, or an error if it could not be decrypted
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  template<typename Document>
+  static auto try_decode(const codec::encoded_value& encoded,
+                         const std::shared_ptr<manager>& crypto_manager,
+                         decode_handle& handle) -> std::pair<error, Document>
+  {
+    if (auto err = decode_preconditions(encoded, crypto_manager); err) {
+      handle.clear();
+      return { std::move(err), {} };
+    }
+    return try_deserialize<Document>(decrypt_into_handle(encoded, crypto_manager, handle));
+  }
+
+  /**
+   * Decodes a batch of documents like decode_many(), but reports the failure of each document as
+   * its own error instead of throwing, so that the documents that could be decrypted are still
+   * returned.
+   *
+   * @tparam Document the type to deserialize the documents into, which must be default
+   * constructible
+   * @param encoded the encoded documents
+   * @param crypto_manager the crypto manager to decrypt the fields with
+   * @return for each document, in the same order, the decoded document, or an error if it could
+   * not be decrypted
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  template<typename Document>
+  static auto try_decode_many(const std::vector<codec::encoded_value>& encoded,
+                              const std::shared_ptr<manager>& crypto_manager)
+    -> std::vector<std::pair<error, Document>>
+  {
+    std::vector<std::pair<error, Document>> documents(encoded.size());
     if (crypto_manager == nullptr) {
-      throw std::system_error(errc::field_level_encryption::generic_cryptography_failure,
-                              "crypto manager is not set, cannot use transcoder with FLE");
+      for (auto& document : documents) {
+        document.first = missing_crypto_manager();
+      }
+      return documents;
+    }
+
+    auto results = internal::decrypt_many(encoded, crypto_manager, Format);
+    for (std::size_t i = 0; i < encoded.size(); ++i) {
+      // documents with the wrong flags were decrypted for nothing, which is rare enough to not be
+      // worth a copy of the batch without them
+      if (auto err = decode_preconditions(encoded[i], crypto_manager); err) {
+        documents[i].first = std::move(err);
+      } else {
+        documents[i] = try_deserialize<Document>(std::move(results[i]));
+      }
+    }
+    return documents;
+  }
+
+  /**
+   * Encodes a document like try_encode(), on a worker thread of the given executor if the document
+   * is large enough, or has enough encrypted fields, to block the calling thread for long (see
+   * couchbase::crypto::crypto_executor::should_offload), and on the calling thread otherwise. The
+   * document is serialized on the calling thread in any case.
+   *
+   * @param document the document to encode
+   * @param crypto_manager the crypto manager to encrypt the fields with, which must be safe to use
+   * from several threads at once
+   * @param executor the executor to run the encoding on
+   * @param handler the copyable callable that receives the error, if any, and the encoded document,
+   * on the thread that encoded it
+   * @param priority the queue of the executor to use
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  template<typename DocumentType, typename Handler>
+  static void encode_async(const document<DocumentType>& document,
+                           const std::shared_ptr<manager>& crypto_manager,
+                           crypto_executor& executor,
+                           Handler&& handler,
+                           crypto_priority priority = crypto_priority::interactive)
+  {
+    encode_on(executor,
+              priority,
+              Serializer::serialize(document.content()),
+              document.encrypted_fields(),
+              crypto_manager,
+              std::forward<Handler>(handler));
+  }
+
+  /**
+   * Encodes a document like try_encode(), on a worker thread of the given executor if it is worth
+   * it, and on the calling thread otherwise.
+   *
+   * @tparam Document the type of the document, which lists its encrypted fields
+   * @param document the document to encode
+   * @param crypto_manager the crypto manager to encrypt the fields with, which must be safe to use
+   * from several threads at once
+   * @param executor the executor to run the encoding on
+   * @param handler the copyable callable that receives the error, if any, and the encoded document,
+   * on the thread that encoded it
+   * @param priority the queue of the executor to use
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  template<typename Document, typename Handler>
+  static void encode_async(const Document& document,
+                           const std::shared_ptr<manager>& crypto_manager,
+                           crypto_executor& executor,
+                           Handler&& handler,
+                           crypto_priority priority = crypto_priority::interactive)
+  {
+    encode_on(executor,
+              priority,
+              Serializer::serialize(document),
+              encrypted_fields_of<Document>(),
+              crypto_manager,
+              std::forward<Handler>(handler));
+  }
+
+  /**
+   * Encodes a document like encode_async(), and returns a future of the outcome.
+   *
+   * @param document the document to encode
+   * @param crypto_manager the crypto manager to encrypt the fields with
+   * @param executor the executor to run the encoding on
+   * @param priority the queue of the executor to use
+   * @return the future error, if any, and encoded document
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  template<typename Document>
+  static auto encode_future(const Document& document,
+                            const std::shared_ptr<manager>& crypto_manager,
+                            crypto_executor& executor,
+                            crypto_priority priority = crypto_priority::interactive)
+    -> std::future<std::pair<error, codec::encoded_value>>
+  {
+    auto barrier = std::make_shared<std::promise<std::pair<error, codec::encoded_value>>>();
+    auto future = barrier->get_future();
+    encode_async(
+      document,
+      crypto_manager,
+      executor,
+      [barrier](error err, codec::encoded_value encoded) {
+        barrier->set_value({ std::move(err), std::move(encoded) });
+      },
+      priority);
+    return future;
+  }
+
+  /**
+   * Decodes a document like try_decode(), on a worker thread of the given executor if the document
+   * is large enough, or has enough encrypted fields, to block the calling thread for long (see
+   * couchbase::crypto::crypto_executor::should_offload), and on the calling thread otherwise.
+   *
+   * This keeps large documents from blocking the I/O thread of the SDK that delivers them, and
+   * every other operation multiplexed on it.
+   *
+   * @tparam Document the type to deserialize the document into, which must be default
+   * constructible
+   * @param encoded the encoded document
+   * @param crypto_manager the crypto manager to decrypt the fields with, which must be safe to use
+   * from several threads at once
+   * @param executor the executor to run the decoding on
+   * @param handler the copyable callable that receives the error, if any, and the decoded document,
+   * on the thread that decoded it
+   * @param priority the queue of the executor to use
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  template<typename Document, typename Handler>
+  static void decode_async(codec::encoded_value encoded,
+                           const std::shared_ptr<manager>& crypto_manager,
+                           crypto_executor& executor,
+                           Handler&& handler,
+                           crypto_priority priority = crypto_priority::interactive)
+  {
+    if (crypto_manager == nullptr ||
+        !executor.should_offload(encoded.data.size(),
+                                 count_encrypted_fields(encoded.data, *crypto_manager))) {
+      auto [err, document] = decode_catching<Document>(encoded, crypto_manager);
+      handler(std::move(err), std::move(document));
+      return;
+    }
+    executor.post(
+      [encoded = std::move(encoded),
+       crypto_manager,
+       handler = std::forward<Handler>(handler)]() mutable {
+        auto [err, document] = decode_catching<Document>(encoded, crypto_manager);
+        handler(std::move(err), std::move(document));
+      },
+      priority);
+  }
+
+  /**
+   * Decodes a document like decode_async(), and returns a future of the outcome.
+   *
+   * @tparam Document the type to deserialize the document into, which must be default
+   * constructible
+   * @param encoded the encoded document
+   * @param crypto_manager the crypto manager to decrypt the fields with
+   * @param executor the executor to run the decoding on
+   * @param priority the queue of the executor to use
+   * @return the future error, if any, and decoded document
+   *
+   * @since 1.1.0
+   * @uncommitted
+   */
+  template<typename Document>
+  static auto decode_future(codec::encoded_value encoded,
+                            const std::shared_ptr<manager>& crypto_manager,
+                            crypto_executor& executor,
+                            crypto_priority priority = crypto_priority::interactive)
+    -> std::future<std::pair<error, Document>>
+  {
+    auto barrier = std::make_shared<std::promise<std::pair<error, Document>>>();
+    auto future = barrier->get_future();
+    decode_async<Document>(
+      std::move(encoded),
+      crypto_manager,
+      executor,
+      [barrier](error err, Document document) {
+        barrier->set_value({ std::move(err), std::move(document) });
+      },
+      priority);
+    return future;
+  }
+
+private:
+  template<typename Document>
+  static auto encrypted_fields_of() -> const std::vector<encrypted_field>&
+  {
+    static const std::vector<encrypted_field> no_fields_to_encrypt{};
+    if constexpr (has_encrypted_fields_v<Document>) {
+      return Document::encrypted_fields;
+    } else {
+      return no_fields_to_encrypt;
     }
-    auto data = Serializer::serialize(document.content());
+  }
+
+  static auto missing_crypto_manager() -> error
+  {
+    return { errc::field_level_encryption::generic_cryptography_failure,
+             "crypto manager is not set, cannot use transcoder with FLE" };
+  }
 
+  static auto try_encode_with_state(const codec::binary& data,
+                                    const std::vector<encrypted_field>& encrypted_fields,
+                                    const std::shared_ptr<manager>& crypto_manager,
+                                    const internal::decode_state* previous_state = nullptr)
+    -> std::pair<error, codec::encoded_value>
+  {
+    if (crypto_manager == nullptr) {
+      return { missing_crypto_manager(), {} };
+    }
     auto [err, encrypted_data] =
-      internal::encrypt(data, document.encrypted_fields(), crypto_manager);
+      internal::encrypt(data, encrypted_fields, crypto_manager, Format, previous_state);
     if (err) {
-      throw std::system_error(err.ec(), "Failed to encrypt document: " + err.message());
+      return { std::move(err), {} };
     }
-    return { std::move(encrypted_data), codec::codec_flags::json_common_flags };
+    return {
+      error{},
+      codec::encoded_value{ std::move(encrypted_data), internal::common_flags(Format) },
+    };
   }
 
-  template<typename Document>
-  static auto encode(Document document, const std::shared_ptr<manager>& crypto_manager)
-    -> codec::encoded_value
+  static auto encoded_size_of(const codec::binary& data,
+                              const std::vector<encrypted_field>& encrypted_fields,
+                              const std::shared_ptr<manager>& crypto_manager)
+    -> std::pair<error, std::size_t>
   {
     if (crypto_manager == nullptr) {
-      throw std::system_error(errc::field_level_encryption::generic_cryptography_failure,
-                              "crypto manager is not set, cannot use transcoder with FLE");
+      return { missing_crypto_manager(), 0 };
     }
-    auto data = Serializer::serialize(document);
+    return internal::encoded_size(data, encrypted_fields, crypto_manager, Format);
+  }
 
-    static const std::vector<encrypted_field> no_fields_to_encrypt{};
-    constexpr const std::vector<encrypted_field>& encrypted_fields =
-      has_encrypted_fields_v<Document> ? Document::encrypted_fields : no_fields_to_encrypt;
+  template<typename Handler>
+  static void encode_on(crypto_executor& executor,
+                        crypto_priority priority,
+                        codec::binary data,
+                        const std::vector<encrypted_field>& encrypted_fields,
+                        const std::shared_ptr<manager>& crypto_manager,
+                        Handler&& handler)
+  {
+    if (!executor.should_offload(data.size(), encrypted_fields.size())) {
+      auto [err, encoded] = encode_catching(data, encrypted_fields, crypto_manager);
+      handler(std::move(err), std::move(encoded));
+      return;
+    }
+    // the fields of a crypto::document are copied, as the document may be gone by the time the
+    // task runs
+    executor.post(
+      [data = std::move(data),
+       encrypted_fields,
+       crypto_manager,
+       handler = std::forward<Handler>(handler)]() mutable {
+        auto [err, encoded] = encode_catching(data, encrypted_fields, crypto_manager);
+        handler(std::move(err), std::move(encoded));
+      },
+      priority);
+  }
+
+  /**
+   * Encodes a document like try_encode(), reporting the exceptions of the encrypters as errors as
+   * well, as there is no caller to catch them on a worker thread.
+   */
+  static auto encode_catching(const codec::binary& data,
+                              const std::vector<encrypted_field>& encrypted_fields,
+                              const std::shared_ptr<manager>& crypto_manager)
+    -> std::pair<error, codec::encoded_value>
+  {
+    try {
+      return try_encode_with_state(data, encrypted_fields, crypto_manager);
+    } catch (const std::system_error& e) {
+      return { error{ e.code(), e.what() }, {} };
+    } catch (const std::exception& e) {
+      return { error{ errc::field_level_encryption::encryption_failure, e.what() }, {} };
+    }
+  }
+
+  /**
+   * Returns the number of encrypted field names in the document, which is much cheaper than
+   * parsing it.
+   */
+  static auto count_encrypted_fields(const codec::binary& data, manager& crypto_manager)
+    -> std::size_t
+  {
+    const auto prefix = crypto_manager.mangle({});
+    if (prefix.empty()) {
+      return 0;
+    }
+    const std::string_view text{ reinterpret_cast<const char*>(data.data()), data.size() };
+    std::size_t count = 0;
+    for (auto pos = text.find(prefix); pos != std::string_view::npos;
+         pos = text.find(prefix, pos + prefix.size())) {
+      ++count;
+    }
+    return count;
+  }
+
+  /**
+   * Decodes a document like try_decode(), reporting the exceptions of the serializer as errors as
+   * well, as there is no caller to catch them on a worker thread.
+   */
+  template<typename Document>
+  static auto decode_catching(const codec::encoded_value& encoded,
+                              const std::shared_ptr<manager>& crypto_manager)
+    -> std::pair<error, Document>
+  {
+    try {
+      return try_decode<Document>(encoded, crypto_manager);
+    } catch (const std::system_error& e) {
+      return { error{ e.code(), e.what() }, {} };
+    } catch (const std::exception& e) {
+      return { error{ errc::common::decoding_failure, e.what() }, {} };
+    }
+  }
 
-    auto [err, encrypted_data] = internal::encrypt(data, encrypted_fields, crypto_manager);
+  static auto encode_with_state(const codec::binary& data,
+                                const std::vector<encrypted_field>& encrypted_fields,
+                                const std::shared_ptr<manager>& crypto_manager,
+                                const internal::decode_state* previous_state = nullptr)
+    -> codec::encoded_value
+  {
+    if (crypto_manager == nullptr) {
+      const auto err = missing_crypto_manager();
+      throw std::system_error(err.ec(), err.message());
+    }
+    auto [err, encoded] =
+      try_encode_with_state(data, encrypted_fields, crypto_manager, previous_state);
     if (err) {
+      // the context is only added here, so that failures reported by try_encode() cost no more
+      // than the error itself
       throw std::system_error(err.ec(), "Failed to encrypt document: " + err.message());
     }
-    return { std::move(encrypted_data), codec::codec_flags::json_common_flags };
+    return std::move(encoded);
+  }
+
+  static auto decrypt_into_handle(const codec::encoded_value& encoded,
+                                  const std::shared_ptr<manager>& crypto_manager,
+                                  decode_handle& handle) -> std::pair<error, codec::binary>
+  {
+    handle.clear();
+    auto result = internal::decrypt(encoded.data, crypto_manager, Format, handle.state_.get());
+    if (result.first) {
+      handle.clear();
+    }
+    return result;
   }
 
   template<typename Document>
-  static auto decode(const codec::encoded_value& encoded,
-                     const std::shared_ptr<manager>& crypto_manager) -> Document
+  static auto try_deserialize(std::pair<error, codec::binary> decrypted)
+    -> std::pair<error, Document>
+  {
+    if (decrypted.first) {
+      return { std::move(decrypted.first), {} };
+    }
+    return { error{}, Serializer::template deserialize<Document>(decrypted.second) };
+  }
+
+  template<typename Document>
+  static auto deserialize_or_throw(std::pair<error, codec::binary> decrypted) -> Document
+  {
+    if (decrypted.first) {
+      throw std::system_error(decrypted.first.ec(),
+                              "Failed to decrypt document: " + decrypted.first.message());
+    }
+    return Serializer::template deserialize<Document>(decrypted.second);
+  }
+
+  static auto decode_preconditions(const codec::encoded_value& encoded,
+                                   const std::shared_ptr<manager>& crypto_manager) -> error
   {
     if (crypto_manager == nullptr) {
-      throw std::system_error(errc::field_level_encryption::generic_cryptography_failure,
-                              "crypto manager is not set, cannot use transcoder with FLE");
+      return missing_crypto_manager();
     }
-    if (!codec::codec_flags::has_common_flags(encoded.flags,
-                                              codec::codec_flags::json_common_flags)) {
-      throw std::system_error(
-        errc::common::decoding_failure,
-        "crypto::transcoder expects document to have JSON common flags, flags=" +
-          std::to_string(encoded.flags));
+    if (!codec::codec_flags::has_common_flags(encoded.flags, internal::common_flags(Format))) {
+      return { errc::common::decoding_failure,
+               std::string{ "crypto::transcoder expects document to have " } +
+                 (Format == document_format::json ? "JSON" : "binary") +
+                 " common flags, flags=" + std::to_string(encoded.flags) };
     }
+    return {};
+  }
 
-    auto [err, decrypted_data] = internal::decrypt(encoded.data, crypto_manager);
-    if (err) {
-      throw std::system_error(err.ec(), "Failed to decrypt document: " + err.message());
+  static void check_decode_preconditions(const codec::encoded_value& encoded,
+                                         const std::shared_ptr<manager>& crypto_manager)
+  {
+    if (auto err = decode_preconditions(encoded, crypto_manager); err) {
+      throw std::system_error(err.ec(), err.message());
     }
-    return Serializer::template deserialize<Document>(decrypted_data);
   }
 };
 } // namespace couchbase::crypto
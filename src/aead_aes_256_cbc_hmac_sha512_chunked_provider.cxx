@@ -0,0 +1,166 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include <couchbase_encryption/aead_aes_256_cbc_hmac_sha512_chunked_provider.hxx>
+
+#include <couchbase/error_codes.hxx>
+
+#include "crypto/aes_cbc_hmac.hxx"
+#include "crypto/chunked_cbc_hmac.hxx"
+
+#include <charconv>
+#include <string_view>
+
+namespace couchbase::crypto
+{
+namespace
+{
+constexpr std::string_view chunk_key{ "chunk" };
+constexpr std::string_view ciphertext_key{ "ciphertext" };
+} // namespace
+
+aead_aes_256_cbc_hmac_sha512_chunked_provider::aead_aes_256_cbc_hmac_sha512_chunked_provider(
+  std::shared_ptr<keyring> keyring,
+  chunked_provider_options options)
+  : keyring_{ std::move(keyring) }
+  , options_{ std::move(options) }
+{
+}
+
+auto
+aead_aes_256_cbc_hmac_sha512_chunked_provider::encrypter_for_key(const std::string& key_id) const
+  -> std::shared_ptr<encrypter>
+{
+  return std::make_shared<aead_aes_256_cbc_hmac_sha512_chunked_encrypter>(
+    key_id, keyring_, options_);
+}
+
+auto
+aead_aes_256_cbc_hmac_sha512_chunked_provider::decrypter() const
+  -> std::shared_ptr<crypto::decrypter>
+{
+  return std::make_shared<aead_aes_256_cbc_hmac_sha512_chunked_decrypter>(keyring_,
+                                                                          options_.executor);
+}
+
+aead_aes_256_cbc_hmac_sha512_chunked_encrypter::aead_aes_256_cbc_hmac_sha512_chunked_encrypter(
+  std::string key_id,
+  std::shared_ptr<keyring> keyring,
+  chunked_provider_options options)
+  : keyring_{ std::move(keyring) }
+  , key_id_{ std::move(key_id) }
+  , options_{ std::move(options) }
+  , prepared_keys_{ std::make_shared<impl::aes_cbc_hmac::prepared_key_cache>() }
+{
+}
+
+auto
+aead_aes_256_cbc_hmac_sha512_chunked_encrypter::encrypt(std::vector<std::byte> plaintext)
+  -> std::pair<error, encryption_result>
+{
+  auto [key_err, key] = keyring_->get(key_id_);
+  if (key_err) {
+    return { key_err, {} };
+  }
+
+  auto [prepare_err, prepared_key] = prepared_keys_->get(key);
+  if (prepare_err) {
+    return { prepare_err, {} };
+  }
+
+  auto [enc_err, ciphertext] = impl::chunked_cbc_hmac::encrypt(
+    *prepared_key, options_.chunk_size, plaintext, options_.executor.get());
+  if (enc_err) {
+    return { enc_err, {} };
+  }
+
+  auto res = encryption_result(aead_aes_256_cbc_hmac_sha512_chunked_provider::algorithm_name);
+  res.put("kid", key_id_);
+  res.put(std::string{ chunk_key }, std::to_string(options_.chunk_size));
+  res.put(std::string{ ciphertext_key }, std::move(ciphertext));
+
+  return { error{}, std::move(res) };
+}
+
+auto
+aead_aes_256_cbc_hmac_sha512_chunked_encrypter::placeholder(std::size_t plaintext_size)
+  -> std::optional<encryption_result>
+{
+  if (options_.chunk_size == 0 || options_.chunk_size > impl::chunked_cbc_hmac::max_chunk_size) {
+    return std::nullopt;
+  }
+  auto res = encryption_result(aead_aes_256_cbc_hmac_sha512_chunked_provider::algorithm_name);
+  res.put("kid", key_id_);
+  res.put(std::string{ chunk_key }, std::to_string(options_.chunk_size));
+  res.put(std::string{ ciphertext_key },
+          std::vector<std::byte>(
+            impl::chunked_cbc_hmac::ciphertext_size(plaintext_size, options_.chunk_size)));
+  return res;
+}
+
+aead_aes_256_cbc_hmac_sha512_chunked_decrypter::aead_aes_256_cbc_hmac_sha512_chunked_decrypter(
+  std::shared_ptr<keyring> keyring,
+  std::shared_ptr<crypto_executor> executor)
+  : keyring_{ std::move(keyring) }
+  , executor_{ std::move(executor) }
+  , prepared_keys_{ std::make_shared<impl::aes_cbc_hmac::prepared_key_cache>() }
+{
+}
+
+auto
+aead_aes_256_cbc_hmac_sha512_chunked_decrypter::decrypt(encryption_result encrypted)
+  -> std::pair<error, std::vector<std::byte>>
+{
+  const auto& members = encrypted.map_ref();
+  const auto key_id = members.find("kid");
+  if (key_id == members.end()) {
+    return { error{ errc::field_level_encryption::decryption_failure,
+                    "failed to get key ID from document" },
+             {} };
+  }
+  const auto chunk = members.find(std::string{ chunk_key });
+  std::size_t chunk_size{ 0 };
+  if (chunk == members.end() ||
+      std::from_chars(chunk->second.data(), chunk->second.data() + chunk->second.size(), chunk_size)
+          .ec != std::errc{}) {
+    return { error{ errc::field_level_encryption::decryption_failure,
+                    "failed to get chunk size from document" },
+             {} };
+  }
+  const auto ciphertext = members.find(std::string{ ciphertext_key });
+  if (ciphertext == members.end()) {
+    return { error{ errc::field_level_encryption::decryption_failure,
+                    "failed to get ciphertext from document" },
+             {} };
+  }
+  const auto [key_err, key] = keyring_->get(key_id->second);
+  if (key_err) {
+    return { key_err, {} };
+  }
+  const auto [prepare_err, prepared_key] = prepared_keys_->get(key);
+  if (prepare_err) {
+    return { prepare_err, {} };
+  }
+
+  return impl::chunked_cbc_hmac::decrypt(
+    *prepared_key, chunk_size, ciphertext->second, executor_.get());
+}
+
+auto
+aead_aes_256_cbc_hmac_sha512_chunked_decrypter::algorithm() const -> const std::string&
+{
+  return aead_aes_256_cbc_hmac_sha512_chunked_provider::algorithm_name;
+}
+
+void
+aead_aes_256_cbc_hmac_sha512_chunked_decrypter::prefetch_keys(
+  const std::vector<std::string>& key_ids)
+{
+  keyring_->prefetch(key_ids);
+}
+} // namespace couchbase::crypto
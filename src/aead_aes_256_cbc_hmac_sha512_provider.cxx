@@ -11,6 +11,7 @@
 #include <couchbase/crypto/internal.hxx>
 #include <couchbase/error_codes.hxx>
 
+#include "crypto/aes_cbc_hmac.hxx"
 #include "utils/base64.h"
 
 #include <spdlog/fmt/bundled/format.h>
@@ -43,6 +44,7 @@ aead_aes_256_cbc_hmac_sha512_encrypter::aead_aes_256_cbc_hmac_sha512_encrypter(
   std::shared_ptr<keyring> keyring)
   : keyring_{ std::move(keyring) }
   , key_id_{ std::move(key_id) }
+  , prepared_keys_{ std::make_shared<impl::aes_cbc_hmac::prepared_key_cache>() }
 {
 }
 
@@ -55,13 +57,17 @@ aead_aes_256_cbc_hmac_sha512_encrypter::encrypt(std::vector<std::byte> plaintext
     return { key_err, {} };
   }
 
+  auto [prepare_err, prepared_key] = prepared_keys_->get(key);
+  if (prepare_err) {
+    return { prepare_err, {} };
+  }
+
   auto [iv_err, iv] = couchbase::crypto::internal::generate_initialization_vector();
   if (iv_err) {
     return { iv_err, {} };
   }
 
-  auto [enc_err, ciphertext] = couchbase::crypto::internal::aead_aes_256_cbc_hmac_sha512::encrypt(
-    key.bytes(), iv, plaintext, {});
+  auto [enc_err, ciphertext] = prepared_key->encrypt(iv, plaintext, {});
   if (enc_err) {
     return { enc_err, {} };
   }
@@ -70,12 +76,24 @@ aead_aes_256_cbc_hmac_sha512_encrypter::encrypt(std::vector<std::byte> plaintext
   res.put("kid", key_id_);
   res.put("ciphertext", impl::utils::base64::encode(ciphertext));
 
-  return { {}, res };
+  return { error{}, std::move(res) };
+}
+
+auto
+aead_aes_256_cbc_hmac_sha512_encrypter::placeholder(std::size_t plaintext_size)
+  -> std::optional<encryption_result>
+{
+  auto res = encryption_result(aead_aes_256_cbc_hmac_sha512_provider::algorithm_name);
+  res.put("kid", key_id_);
+  res.put("ciphertext",
+          std::vector<std::byte>(impl::aes_cbc_hmac::ciphertext_size(plaintext_size)));
+  return res;
 }
 
 aead_aes_256_cbc_hmac_sha512_decrypter::aead_aes_256_cbc_hmac_sha512_decrypter(
   std::shared_ptr<keyring> keyring)
   : keyring_{ std::move(keyring) }
+  , prepared_keys_{ std::make_shared<impl::aes_cbc_hmac::prepared_key_cache>() }
 {
 }
 
@@ -106,9 +124,12 @@ aead_aes_256_cbc_hmac_sha512_decrypter::decrypt(encryption_result encrypted)
   if (key_err) {
     return { key_err, {} };
   }
+  const auto [prepare_err, prepared_key] = prepared_keys_->get(key);
+  if (prepare_err) {
+    return { prepare_err, {} };
+  }
 
-  return couchbase::crypto::internal::aead_aes_256_cbc_hmac_sha512::decrypt(
-    key.bytes(), ciphertext.value(), {});
+  return prepared_key->decrypt(ciphertext.value(), {});
 }
 
 auto
@@ -116,4 +137,10 @@ aead_aes_256_cbc_hmac_sha512_decrypter::algorithm() const -> const std::string&
 {
   return aead_aes_256_cbc_hmac_sha512_provider::algorithm_name;
 }
+
+void
+aead_aes_256_cbc_hmac_sha512_decrypter::prefetch_keys(const std::vector<std::string>& key_ids)
+{
+  keyring_->prefetch(key_ids);
+}
 } // namespace couchbase::crypto
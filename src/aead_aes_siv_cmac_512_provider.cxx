@@ -0,0 +1,148 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include <couchbase_encryption/aead_aes_siv_cmac_512_provider.hxx>
+
+#include <couchbase/error_codes.hxx>
+
+#include "crypto/aes_siv.hxx"
+#include "utils/base64.h"
+
+#include <spdlog/fmt/bundled/format.h>
+
+#include <stdexcept>
+
+namespace couchbase::crypto
+{
+namespace
+{
+constexpr std::size_t key_size{ 64 };
+
+auto
+check_key_size(const key& k) -> error
+{
+  if (k.bytes().size() != key_size) {
+    return { errc::field_level_encryption::invalid_crypto_key,
+             fmt::format("Expected key to be {} bytes, but got {} bytes",
+                         key_size,
+                         k.bytes().size()) };
+  }
+  return {};
+}
+} // namespace
+
+aead_aes_siv_cmac_512_provider::aead_aes_siv_cmac_512_provider(std::shared_ptr<keyring> keyring)
+  : keyring_(std::move(keyring))
+{
+}
+
+auto
+aead_aes_siv_cmac_512_provider::encrypter_for_key(const std::string& key_id) const
+  -> std::shared_ptr<encrypter>
+{
+  return std::make_shared<aead_aes_siv_cmac_512_encrypter>(key_id, keyring_);
+}
+
+auto
+aead_aes_siv_cmac_512_provider::decrypter() const -> std::shared_ptr<crypto::decrypter>
+{
+  return std::make_shared<aead_aes_siv_cmac_512_decrypter>(keyring_);
+}
+
+aead_aes_siv_cmac_512_encrypter::aead_aes_siv_cmac_512_encrypter(std::string key_id,
+                                                                 std::shared_ptr<keyring> keyring)
+  : keyring_{ std::move(keyring) }
+  , key_id_{ std::move(key_id) }
+{
+}
+
+auto
+aead_aes_siv_cmac_512_encrypter::encrypt(std::vector<std::byte> plaintext)
+  -> std::pair<error, encryption_result>
+{
+  auto [key_err, key] = keyring_->get(key_id_);
+  if (key_err) {
+    return { key_err, {} };
+  }
+  if (auto err = check_key_size(key); err) {
+    return { err, {} };
+  }
+
+  auto [enc_err, ciphertext] = impl::aes_siv::encrypt(key.bytes(), plaintext, {});
+  if (enc_err) {
+    return { enc_err, {} };
+  }
+
+  auto res = encryption_result(aead_aes_siv_cmac_512_provider::algorithm_name);
+  res.put("kid", key_id_);
+  res.put("ciphertext", impl::utils::base64::encode(ciphertext));
+
+  return { error{}, std::move(res) };
+}
+
+auto
+aead_aes_siv_cmac_512_encrypter::placeholder(std::size_t plaintext_size)
+  -> std::optional<encryption_result>
+{
+  auto res = encryption_result(aead_aes_siv_cmac_512_provider::algorithm_name);
+  res.put("kid", key_id_);
+  res.put("ciphertext", std::vector<std::byte>(impl::aes_siv::ciphertext_size(plaintext_size)));
+  return res;
+}
+
+aead_aes_siv_cmac_512_decrypter::aead_aes_siv_cmac_512_decrypter(std::shared_ptr<keyring> keyring)
+  : keyring_{ std::move(keyring) }
+{
+}
+
+auto
+aead_aes_siv_cmac_512_decrypter::decrypt(encryption_result encrypted)
+  -> std::pair<error, std::vector<std::byte>>
+{
+  const auto key_id = encrypted.get("kid");
+  if (!key_id.has_value()) {
+    return { error{ errc::field_level_encryption::decryption_failure,
+                    "failed to get key ID from document" },
+             {} };
+  }
+  std::optional<std::vector<std::byte>> ciphertext{};
+  try {
+    ciphertext = encrypted.get_bytes("ciphertext");
+  } catch (const std::invalid_argument& e) {
+    return { error{ errc::field_level_encryption::invalid_ciphertext,
+                    fmt::format("ciphertext could not be decoded: {}", e.what()) },
+             {} };
+  }
+  if (!ciphertext.has_value()) {
+    return { error{ errc::field_level_encryption::decryption_failure,
+                    "failed to get ciphertext from document" },
+             {} };
+  }
+  const auto [key_err, key] = keyring_->get(key_id.value());
+  if (key_err) {
+    return { key_err, {} };
+  }
+  if (auto err = check_key_size(key); err) {
+    return { err, {} };
+  }
+
+  return impl::aes_siv::decrypt(key.bytes(), ciphertext.value(), {});
+}
+
+auto
+aead_aes_siv_cmac_512_decrypter::algorithm() const -> const std::string&
+{
+  return aead_aes_siv_cmac_512_provider::algorithm_name;
+}
+
+void
+aead_aes_siv_cmac_512_decrypter::prefetch_keys(const std::vector<std::string>& key_ids)
+{
+  keyring_->prefetch(key_ids);
+}
+} // namespace couchbase::crypto
@@ -0,0 +1,115 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include <couchbase_encryption/blind_indexer.hxx>
+
+#include <couchbase/error_codes.hxx>
+
+#include "utils/base64.h"
+
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/sha.h>
+
+#include <string>
+
+namespace couchbase::crypto
+{
+namespace
+{
+class blind_index_error_category : public std::error_category
+{
+public:
+  [[nodiscard]] auto name() const noexcept -> const char* override
+  {
+    return "couchbase.encryption.blind_index";
+  }
+
+  [[nodiscard]] auto message(int code) const -> std::string override
+  {
+    switch (static_cast<blind_index_errc>(code)) {
+      case blind_index_errc::blind_indexer_not_found:
+        return "blind_indexer_not_found";
+    }
+    return "unknown blind index error " + std::to_string(code);
+  }
+};
+} // namespace
+
+auto
+blind_index_category() noexcept -> const std::error_category&
+{
+  static const blind_index_error_category instance{};
+  return instance;
+}
+
+auto
+make_error_code(blind_index_errc code) noexcept -> std::error_code
+{
+  return { static_cast<int>(code), blind_index_category() };
+}
+
+hmac_sha512_blind_indexer::hmac_sha512_blind_indexer(std::string key_id,
+                                                     std::shared_ptr<keyring> keyring)
+  : keyring_{ std::move(keyring) }
+  , key_id_{ std::move(key_id) }
+{
+}
+
+auto
+hmac_sha512_blind_indexer::index(const std::vector<std::byte>& plaintext)
+  -> std::pair<error, std::vector<std::byte>>
+{
+  auto [key_err, key] = keyring_->get(key_id_);
+  if (key_err) {
+    return { key_err, {} };
+  }
+  if (key.bytes().empty()) {
+    return { error{ errc::field_level_encryption::invalid_crypto_key,
+                    "blind index key must not be empty" },
+             {} };
+  }
+
+  std::vector<std::byte> mac(EVP_MAX_MD_SIZE);
+  unsigned int mac_size = 0;
+  if (HMAC(EVP_sha512(),
+           key.bytes().data(),
+           static_cast<int>(key.bytes().size()),
+           reinterpret_cast<const unsigned char*>(plaintext.data()),
+           plaintext.size(),
+           reinterpret_cast<unsigned char*>(mac.data()),
+           &mac_size) == nullptr) {
+    return { error{ errc::field_level_encryption::generic_cryptography_failure,
+                    "unable to compute HMAC-SHA512" },
+             {} };
+  }
+  mac.resize(mac_size);
+  return { error{}, std::move(mac) };
+}
+
+auto
+hmac_sha512_blind_indexer::index_size() const -> std::optional<std::size_t>
+{
+  return std::size_t{ SHA512_DIGEST_LENGTH };
+}
+
+auto
+blind_index_token(const std::shared_ptr<manager>& crypto_manager,
+                  const std::vector<std::byte>& plaintext,
+                  const blind_index_options& options) -> std::pair<error, std::string>
+{
+  auto [err, mac] = crypto_manager->blind_index(plaintext, options.indexer_alias);
+  if (err) {
+    return { err, {} };
+  }
+  if (options.length > 0 && options.length < mac.size()) {
+    mac.resize(options.length);
+  }
+  return { error{}, impl::utils::base64::encode(mac) };
+}
+} // namespace couchbase::crypto
@@ -0,0 +1,225 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include <couchbase_encryption/caching_decrypter.hxx>
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+namespace couchbase::crypto
+{
+namespace
+{
+/// Accounted to every entry in addition to its plaintext, for the bookkeeping around it
+constexpr std::size_t entry_overhead{ 128 };
+
+struct md_ctx_deleter {
+  void operator()(EVP_MD_CTX* ctx) const
+  {
+    EVP_MD_CTX_free(ctx);
+  }
+};
+
+auto
+update_with_length_prefix(EVP_MD_CTX* ctx, const std::string& data) -> bool
+{
+  std::array<unsigned char, 8> length{};
+  for (std::size_t i = 0; i < length.size(); ++i) {
+    length[i] = static_cast<unsigned char>(data.size() >> (8 * (length.size() - 1 - i)));
+  }
+  return EVP_DigestUpdate(ctx, length.data(), length.size()) == 1 &&
+         EVP_DigestUpdate(ctx, data.data(), data.size()) == 1;
+}
+
+/**
+ * Returns the SHA-256 digest of every member of the encrypted node (including the algorithm, the
+ * key ID and the ciphertext), or an empty optional if it could not be computed.
+ */
+auto
+cache_key(const encryption_result& encrypted) -> std::optional<std::string>
+{
+  const std::unique_ptr<EVP_MD_CTX, md_ctx_deleter> ctx{ EVP_MD_CTX_new() };
+  if (!ctx || EVP_DigestInit_ex(ctx.get(), EVP_sha256(), nullptr) != 1) {
+    return {};
+  }
+  for (const auto& [name, value] : encrypted.map_ref()) {
+    if (!update_with_length_prefix(ctx.get(), name) ||
+        !update_with_length_prefix(ctx.get(), value)) {
+      return {};
+    }
+  }
+  std::string digest(EVP_MAX_MD_SIZE, '\0');
+  unsigned int digest_size = 0;
+  if (EVP_DigestFinal_ex(
+        ctx.get(), reinterpret_cast<unsigned char*>(digest.data()), &digest_size) != 1) {
+    return {};
+  }
+  digest.resize(digest_size);
+  return digest;
+}
+
+auto
+shard_index(const std::string& digest, std::size_t shard_count) -> std::size_t
+{
+  std::uint64_t prefix = 0;
+  for (std::size_t i = 0; i < sizeof(prefix) && i < digest.size(); ++i) {
+    prefix = (prefix << 8U) | static_cast<unsigned char>(digest[i]);
+  }
+  return static_cast<std::size_t>(prefix % shard_count);
+}
+} // namespace
+
+struct caching_decrypter::shard {
+  struct entry {
+    std::string key_id{};
+    std::vector<std::byte> plaintext{};
+    std::list<std::string>::iterator lru_position{};
+  };
+
+  static auto cost(const entry& e) -> std::size_t
+  {
+    return e.plaintext.size() + e.key_id.size() + entry_overhead;
+  }
+
+  void erase(std::unordered_map<std::string, entry>::iterator it)
+  {
+    bytes -= cost(it->second);
+    OPENSSL_cleanse(it->second.plaintext.data(), it->second.plaintext.size());
+    lru.erase(it->second.lru_position);
+    entries.erase(it);
+  }
+
+  std::mutex mutex{};
+  std::unordered_map<std::string, entry> entries{};
+  std::list<std::string> lru{};
+  std::size_t bytes{ 0 };
+  /// Incremented whenever entries are invalidated, so that decryptions running meanwhile are not
+  /// cached
+  std::uint64_t generation{ 0 };
+};
+
+caching_decrypter::caching_decrypter(std::shared_ptr<decrypter> decrypter,
+                                     caching_decrypter_options options)
+  : decrypter_{ std::move(decrypter) }
+  , max_shard_bytes_{ options.max_bytes / std::max<std::size_t>(options.shard_count, 1) }
+{
+  const auto shard_count = std::max<std::size_t>(options.shard_count, 1);
+  shards_.reserve(shard_count);
+  for (std::size_t i = 0; i < shard_count; ++i) {
+    shards_.push_back(std::make_shared<shard>());
+  }
+}
+
+auto
+caching_decrypter::decrypt(encryption_result encrypted) -> std::pair<error, std::vector<std::byte>>
+{
+  if (max_shard_bytes_ == 0) {
+    return decrypter_->decrypt(std::move(encrypted));
+  }
+  auto digest = cache_key(encrypted);
+  if (!digest.has_value()) {
+    return decrypter_->decrypt(std::move(encrypted));
+  }
+  auto& s = *shards_[shard_index(digest.value(), shards_.size())];
+  std::uint64_t generation{};
+  {
+    const std::scoped_lock lock(s.mutex);
+    if (auto it = s.entries.find(digest.value()); it != s.entries.end()) {
+      s.lru.splice(s.lru.begin(), s.lru, it->second.lru_position);
+      return { {}, it->second.plaintext };
+    }
+    generation = s.generation;
+  }
+
+  auto key_id = encrypted.get("kid").value_or(std::string{});
+  auto [err, plaintext] = decrypter_->decrypt(std::move(encrypted));
+  if (err) {
+    return { std::move(err), {} };
+  }
+
+  shard::entry e{ std::move(key_id), plaintext };
+  const auto cost = shard::cost(e);
+  if (cost > max_shard_bytes_) {
+    OPENSSL_cleanse(e.plaintext.data(), e.plaintext.size());
+    return { error{}, std::move(plaintext) };
+  }
+
+  const std::scoped_lock lock(s.mutex);
+  if (s.generation != generation || s.entries.find(digest.value()) != s.entries.end()) {
+    // the key may have been revoked, or another thread decrypted the same field, in the meantime
+    OPENSSL_cleanse(e.plaintext.data(), e.plaintext.size());
+    return { error{}, std::move(plaintext) };
+  }
+  while (s.bytes + cost > max_shard_bytes_) {
+    s.erase(s.entries.find(s.lru.back()));
+  }
+  s.lru.push_front(digest.value());
+  e.lru_position = s.lru.begin();
+  s.bytes += cost;
+  s.entries.emplace(std::move(digest.value()), std::move(e));
+  return { error{}, std::move(plaintext) };
+}
+
+auto
+caching_decrypter::algorithm() const -> const std::string&
+{
+  return decrypter_->algorithm();
+}
+
+void
+caching_decrypter::prefetch_keys(const std::vector<std::string>& key_ids)
+{
+  decrypter_->prefetch_keys(key_ids);
+}
+
+void
+caching_decrypter::invalidate(const std::string& key_id)
+{
+  for (const auto& s : shards_) {
+    const std::scoped_lock lock(s->mutex);
+    ++s->generation;
+    for (auto it = s->entries.begin(); it != s->entries.end();) {
+      auto current = it++;
+      if (current->second.key_id == key_id) {
+        s->erase(current);
+      }
+    }
+  }
+}
+
+void
+caching_decrypter::clear()
+{
+  for (const auto& s : shards_) {
+    const std::scoped_lock lock(s->mutex);
+    ++s->generation;
+    while (!s->entries.empty()) {
+      s->erase(s->entries.begin());
+    }
+  }
+}
+
+auto
+caching_decrypter::size_in_bytes() const -> std::size_t
+{
+  std::size_t total = 0;
+  for (const auto& s : shards_) {
+    const std::scoped_lock lock(s->mutex);
+    total += s->bytes;
+  }
+  return total;
+}
+} // namespace couchbase::crypto
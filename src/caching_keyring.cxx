@@ -0,0 +1,166 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include <couchbase/error_codes.hxx>
+#include <couchbase_encryption/caching_keyring.hxx>
+
+namespace couchbase::crypto
+{
+caching_keyring::caching_keyring(std::shared_ptr<keyring> backing_keyring,
+                                 caching_keyring_options options)
+  : backing_keyring_{ std::move(backing_keyring) }
+  , options_{ options }
+{
+}
+
+auto
+caching_keyring::get(const std::string& key_id) const -> std::pair<error, key>
+{
+  if (auto cached = find(key_id); cached.has_value()) {
+    return std::move(cached.value());
+  }
+
+  // The backing keyring may be remote, so it is consulted without holding the lock.
+  auto res = backing_keyring_->get(key_id);
+  store(key_id, res);
+  return res;
+}
+
+auto
+caching_keyring::get_many(const std::vector<std::string>& key_ids) const
+  -> std::vector<std::pair<error, key>>
+{
+  std::vector<std::pair<error, key>> results(key_ids.size());
+  std::vector<std::string> missed_key_ids{};
+  std::vector<std::size_t> missed_positions{};
+  for (std::size_t i = 0; i < key_ids.size(); ++i) {
+    if (auto cached = find(key_ids[i]); cached.has_value()) {
+      results[i] = std::move(cached.value());
+    } else {
+      missed_key_ids.push_back(key_ids[i]);
+      missed_positions.push_back(i);
+    }
+  }
+  if (missed_key_ids.empty()) {
+    return results;
+  }
+
+  auto fetched = backing_keyring_->get_many(missed_key_ids);
+  for (std::size_t i = 0; i < missed_key_ids.size(); ++i) {
+    auto res = i < fetched.size() ? std::move(fetched[i])
+                                  : std::pair<error, key>{
+                                      error{ errc::field_level_encryption::crypto_key_not_found,
+                                             "Key not found: " + missed_key_ids[i] },
+                                      {}
+                                    };
+    store(missed_key_ids[i], res);
+    results[missed_positions[i]] = std::move(res);
+  }
+  return results;
+}
+
+void
+caching_keyring::prefetch(const std::vector<std::string>& key_ids) const
+{
+  std::vector<std::string> missed_key_ids{};
+  for (const auto& key_id : key_ids) {
+    if (!find(key_id).has_value()) {
+      missed_key_ids.push_back(key_id);
+    }
+  }
+  if (missed_key_ids.empty()) {
+    return;
+  }
+
+  auto fetched = backing_keyring_->get_many(missed_key_ids);
+  for (std::size_t i = 0; i < missed_key_ids.size() && i < fetched.size(); ++i) {
+    store(missed_key_ids[i], fetched[i]);
+  }
+}
+
+void
+caching_keyring::invalidate(const std::string& key_id)
+{
+  const std::scoped_lock lock(mutex_);
+  if (auto it = entries_.find(key_id); it != entries_.end()) {
+    erase(it);
+  }
+}
+
+void
+caching_keyring::clear()
+{
+  const std::scoped_lock lock(mutex_);
+  entries_.clear();
+  keys_lru_.clear();
+  missing_keys_lru_.clear();
+}
+
+auto
+caching_keyring::find(const std::string& key_id) const -> std::optional<std::pair<error, key>>
+{
+  const std::scoped_lock lock(mutex_);
+  auto it = entries_.find(key_id);
+  if (it == entries_.end()) {
+    return std::nullopt;
+  }
+  if (it->second.expires_at <= clock::now()) {
+    erase(it);
+    return std::nullopt;
+  }
+  auto& lru = it->second.k.has_value() ? keys_lru_ : missing_keys_lru_;
+  lru.splice(lru.begin(), lru, it->second.lru_position);
+  if (!it->second.k.has_value()) {
+    return std::pair<error, key>{
+      error{ errc::field_level_encryption::crypto_key_not_found, "Key not found: " + key_id }, {}
+    };
+  }
+  return std::pair<error, key>{ {}, it->second.k.value() };
+}
+
+void
+caching_keyring::store(const std::string& key_id, const std::pair<error, key>& result) const
+{
+  // Only successful lookups and missing keys are cached, other errors may be transient.
+  if (!result.first) {
+    store(key_id, result.second);
+  } else if (result.first.ec() == errc::field_level_encryption::crypto_key_not_found) {
+    store(key_id, std::nullopt);
+  }
+}
+
+void
+caching_keyring::store(const std::string& key_id, std::optional<key> k) const
+{
+  const bool missing = !k.has_value();
+  const auto capacity = missing ? options_.max_missing_keys : options_.max_keys;
+  if (capacity == 0) {
+    return;
+  }
+  const auto ttl = missing ? options_.missing_key_ttl : options_.key_ttl;
+
+  const std::scoped_lock lock(mutex_);
+  if (auto it = entries_.find(key_id); it != entries_.end()) {
+    erase(it);
+  }
+  auto& lru = missing ? missing_keys_lru_ : keys_lru_;
+  while (lru.size() >= capacity) {
+    erase(entries_.find(lru.back()));
+  }
+  lru.push_front(key_id);
+  entries_.emplace(key_id, entry{ std::move(k), clock::now() + ttl, lru.begin() });
+}
+
+void
+caching_keyring::erase(std::unordered_map<std::string, entry>::iterator it) const
+{
+  auto& lru = it->second.k.has_value() ? keys_lru_ : missing_keys_lru_;
+  lru.erase(it->second.lru_position);
+  entries_.erase(it);
+}
+} // namespace couchbase::crypto
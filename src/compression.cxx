@@ -0,0 +1,530 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include <couchbase_encryption/compression.hxx>
+
+#include <couchbase/error_codes.hxx>
+
+#include <spdlog/fmt/bundled/format.h>
+
+#ifdef COUCHBASE_CXX_ENCRYPTION_HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef COUCHBASE_CXX_ENCRYPTION_HAVE_LZ4
+#include <lz4.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
+namespace couchbase::crypto
+{
+namespace
+{
+constexpr std::string_view compression_key{ "cmp" };
+constexpr std::string_view dictionary_key{ "cdict" };
+constexpr std::string_view zstd_name{ "zstd" };
+constexpr std::string_view lz4_name{ "lz4" };
+
+/// LZ4 blocks do not record the size of the uncompressed data, so it is prepended to the block
+constexpr std::size_t lz4_size_prefix{ 4 };
+
+/**
+ * Compressed plaintexts start with a header that names the algorithm and the dictionary, so that
+ * the wrapped encrypter authenticates them together with the data:
+ *
+ *   magic (4) | algorithm length (1) | algorithm | dictionary ID length (2, big endian) | ID
+ *
+ * The `cmp` and `cdict` fields of the encryption result are not authenticated. They must match the
+ * header, which is the only thing decompression relies on. JSON never starts with a NUL byte, so a
+ * field whose `cmp` field was removed is still recognised as compressed.
+ */
+constexpr std::array<std::byte, 4> header_magic{ std::byte{ 0x00 },
+                                                 std::byte{ 'c' },
+                                                 std::byte{ 'm' },
+                                                 std::byte{ 'p' } };
+constexpr std::size_t max_dictionary_id_size{ 0xffff };
+
+struct compression_header {
+  std::string_view algorithm{};
+  std::string_view dictionary_id{};
+  std::size_t size{ 0 };
+};
+
+auto
+make_header(std::string_view algorithm, std::string_view dictionary_id) -> std::vector<std::byte>
+{
+  std::vector<std::byte> header(header_magic.begin(), header_magic.end());
+  header.reserve(header_magic.size() + 3 + algorithm.size() + dictionary_id.size());
+  header.push_back(static_cast<std::byte>(algorithm.size()));
+  for (const auto c : algorithm) {
+    header.push_back(static_cast<std::byte>(c));
+  }
+  header.push_back(static_cast<std::byte>(dictionary_id.size() >> CHAR_BIT));
+  header.push_back(static_cast<std::byte>(dictionary_id.size()));
+  for (const auto c : dictionary_id) {
+    header.push_back(static_cast<std::byte>(c));
+  }
+  return header;
+}
+
+auto
+read_header(const std::vector<std::byte>& plaintext) -> std::optional<compression_header>
+{
+  auto as_chars = [&plaintext](std::size_t offset, std::size_t size) {
+    return std::string_view{ reinterpret_cast<const char*>(plaintext.data()) + offset, size };
+  };
+
+  std::size_t offset = header_magic.size();
+  if (plaintext.size() < offset + 1 ||
+      !std::equal(header_magic.begin(), header_magic.end(), plaintext.begin())) {
+    return {};
+  }
+  const auto algorithm_size = std::to_integer<std::size_t>(plaintext[offset]);
+  offset += 1;
+  if (plaintext.size() < offset + algorithm_size + 2) {
+    return {};
+  }
+  compression_header header{};
+  header.algorithm = as_chars(offset, algorithm_size);
+  offset += algorithm_size;
+  const auto dictionary_id_size = (std::to_integer<std::size_t>(plaintext[offset]) << CHAR_BIT) |
+                                  std::to_integer<std::size_t>(plaintext[offset + 1]);
+  offset += 2;
+  if (plaintext.size() < offset + dictionary_id_size) {
+    return {};
+  }
+  header.dictionary_id = as_chars(offset, dictionary_id_size);
+  header.size = offset + dictionary_id_size;
+  return header;
+}
+
+auto
+algorithm_name(compression_algorithm algorithm) -> std::string_view
+{
+  switch (algorithm) {
+    case compression_algorithm::zstd:
+      return zstd_name;
+    case compression_algorithm::lz4:
+      return lz4_name;
+  }
+  return {};
+}
+
+auto
+unsupported(std::string_view name) -> error
+{
+  return { errc::field_level_encryption::generic_cryptography_failure,
+           fmt::format("The library was built without support for `{}` compression", name) };
+}
+
+#ifdef COUCHBASE_CXX_ENCRYPTION_HAVE_ZSTD
+struct zstd_cdict_deleter {
+  void operator()(ZSTD_CDict* dict) const
+  {
+    ZSTD_freeCDict(dict);
+  }
+};
+
+struct zstd_ddict_deleter {
+  void operator()(ZSTD_DDict* dict) const
+  {
+    ZSTD_freeDDict(dict);
+  }
+};
+
+struct zstd_cctx_deleter {
+  void operator()(ZSTD_CCtx* ctx) const
+  {
+    ZSTD_freeCCtx(ctx);
+  }
+};
+
+struct zstd_dctx_deleter {
+  void operator()(ZSTD_DCtx* ctx) const
+  {
+    ZSTD_freeDCtx(ctx);
+  }
+};
+#endif
+} // namespace
+
+/**
+ * The state needed to compress with the configured algorithm and dictionary. Digested dictionaries
+ * are expensive to build, so they are built once, when the encrypter is constructed.
+ */
+struct compressing_encrypter::compressor {
+  /// Written in front of the compressed data, see compression_header
+  std::vector<std::byte> header{};
+  std::vector<std::byte> dictionary{};
+#ifdef COUCHBASE_CXX_ENCRYPTION_HAVE_ZSTD
+  std::unique_ptr<ZSTD_CDict, zstd_cdict_deleter> zstd_dictionary{};
+#endif
+  /// Set if the dictionary could not be prepared, in which case nothing is encrypted
+  error setup_error{};
+
+  [[nodiscard]] auto compress(const compression_options& options,
+                              [[maybe_unused]] const std::vector<std::byte>& input) const
+    -> std::pair<error, std::vector<std::byte>>
+  {
+    switch (options.algorithm) {
+      case compression_algorithm::zstd: {
+#ifdef COUCHBASE_CXX_ENCRYPTION_HAVE_ZSTD
+        const std::unique_ptr<ZSTD_CCtx, zstd_cctx_deleter> ctx{ ZSTD_createCCtx() };
+        if (!ctx) {
+          return { error{ errc::field_level_encryption::encryption_failure,
+                          "could not create zstd compression context" },
+                   {} };
+        }
+        const auto bound = ZSTD_compressBound(input.size());
+        auto output = with_header(bound);
+        auto* destination = output.data() + header.size();
+        std::size_t size = 0;
+        if (zstd_dictionary) {
+          size = ZSTD_compress_usingCDict(
+            ctx.get(), destination, bound, input.data(), input.size(), zstd_dictionary.get());
+        } else {
+          size = ZSTD_compressCCtx(
+            ctx.get(), destination, bound, input.data(), input.size(), options.level);
+        }
+        if (ZSTD_isError(size) != 0) {
+          return { error{ errc::field_level_encryption::encryption_failure,
+                          fmt::format("zstd compression failed: {}", ZSTD_getErrorName(size)) },
+                   {} };
+        }
+        output.resize(header.size() + size);
+        return { error{}, std::move(output) };
+#else
+        return { unsupported(zstd_name), {} };
+#endif
+      }
+
+      case compression_algorithm::lz4: {
+#ifdef COUCHBASE_CXX_ENCRYPTION_HAVE_LZ4
+        if (input.size() > static_cast<std::size_t>(LZ4_MAX_INPUT_SIZE)) {
+          return { error{ errc::field_level_encryption::encryption_failure,
+                          "the plaintext is too large for LZ4 compression" },
+                   {} };
+        }
+        const auto input_size = static_cast<int>(input.size());
+        const auto bound = LZ4_compressBound(input_size);
+        auto output = with_header(lz4_size_prefix + static_cast<std::size_t>(bound));
+        auto* block = output.data() + header.size();
+        for (std::size_t i = 0; i < lz4_size_prefix; ++i) {
+          const auto shift = CHAR_BIT * (lz4_size_prefix - 1 - i);
+          block[i] = static_cast<std::byte>(input.size() >> shift);
+        }
+        auto* source = reinterpret_cast<const char*>(input.data());
+        auto* destination = reinterpret_cast<char*>(block + lz4_size_prefix);
+        int size = 0;
+        if (dictionary.empty()) {
+          size = LZ4_compress_fast(source, destination, input_size, bound, options.level);
+        } else {
+          LZ4_stream_t stream{};
+          LZ4_initStream(&stream, sizeof(stream));
+          LZ4_loadDict(&stream,
+                       reinterpret_cast<const char*>(dictionary.data()),
+                       static_cast<int>(dictionary.size()));
+          size = LZ4_compress_fast_continue(
+            &stream, source, destination, input_size, bound, options.level);
+        }
+        if (size <= 0) {
+          return { error{ errc::field_level_encryption::encryption_failure,
+                          "LZ4 compression failed" },
+                   {} };
+        }
+        output.resize(header.size() + lz4_size_prefix + static_cast<std::size_t>(size));
+        return { error{}, std::move(output) };
+#else
+        return { unsupported(lz4_name), {} };
+#endif
+      }
+    }
+    return { unsupported(algorithm_name(options.algorithm)), {} };
+  }
+
+  /// Returns a buffer that starts with the header, followed by room for the compressed data
+  [[nodiscard]] auto with_header(std::size_t capacity) const -> std::vector<std::byte>
+  {
+    std::vector<std::byte> output(header.size() + capacity);
+    std::copy(header.begin(), header.end(), output.begin());
+    return output;
+  }
+};
+
+/**
+ * A dictionary the fields may have been compressed with, prepared for decompression.
+ */
+struct decompressing_decrypter::decompressor {
+  std::vector<std::byte> dictionary{};
+#ifdef COUCHBASE_CXX_ENCRYPTION_HAVE_ZSTD
+  std::unique_ptr<ZSTD_DDict, zstd_ddict_deleter> zstd_dictionary{};
+#endif
+  /// Set if the dictionary could not be prepared for zstd, which fails zstd fields that use it
+  error zstd_setup_error{};
+
+  [[nodiscard]] auto decompress(std::string_view algorithm,
+                                [[maybe_unused]] const std::vector<std::byte>& input,
+                                [[maybe_unused]] std::size_t max_size) const
+    -> std::pair<error, std::vector<std::byte>>
+  {
+    if (algorithm == zstd_name) {
+#ifdef COUCHBASE_CXX_ENCRYPTION_HAVE_ZSTD
+      if (zstd_setup_error) {
+        return { zstd_setup_error, {} };
+      }
+      const auto content_size = ZSTD_getFrameContentSize(input.data(), input.size());
+      if (content_size == ZSTD_CONTENTSIZE_ERROR || content_size == ZSTD_CONTENTSIZE_UNKNOWN ||
+          content_size > max_size) {
+        return { error{ errc::field_level_encryption::decryption_failure,
+                        "invalid or oversized zstd frame" },
+                 {} };
+      }
+      const std::unique_ptr<ZSTD_DCtx, zstd_dctx_deleter> ctx{ ZSTD_createDCtx() };
+      if (!ctx) {
+        return { error{ errc::field_level_encryption::decryption_failure,
+                        "could not create zstd decompression context" },
+                 {} };
+      }
+      std::vector<std::byte> output(static_cast<std::size_t>(content_size));
+      std::size_t size = 0;
+      if (zstd_dictionary) {
+        size = ZSTD_decompress_usingDDict(ctx.get(),
+                                          output.data(),
+                                          output.size(),
+                                          input.data(),
+                                          input.size(),
+                                          zstd_dictionary.get());
+      } else {
+        size =
+          ZSTD_decompressDCtx(ctx.get(), output.data(), output.size(), input.data(), input.size());
+      }
+      if (ZSTD_isError(size) != 0 || size != output.size()) {
+        return { error{ errc::field_level_encryption::decryption_failure,
+                        fmt::format("zstd decompression failed: {}", ZSTD_getErrorName(size)) },
+                 {} };
+      }
+      return { error{}, std::move(output) };
+#else
+      return { unsupported(algorithm), {} };
+#endif
+    }
+
+    if (algorithm == lz4_name) {
+#ifdef COUCHBASE_CXX_ENCRYPTION_HAVE_LZ4
+      if (input.size() < lz4_size_prefix ||
+          input.size() - lz4_size_prefix > static_cast<std::size_t>(INT_MAX)) {
+        return { error{ errc::field_level_encryption::decryption_failure, "invalid LZ4 block" },
+                 {} };
+      }
+      std::size_t content_size = 0;
+      for (std::size_t i = 0; i < lz4_size_prefix; ++i) {
+        content_size = (content_size << CHAR_BIT) | std::to_integer<std::size_t>(input[i]);
+      }
+      if (content_size > max_size) {
+        return { error{ errc::field_level_encryption::decryption_failure, "oversized LZ4 block" },
+                 {} };
+      }
+      std::vector<std::byte> output(content_size);
+      auto* source = reinterpret_cast<const char*>(input.data() + lz4_size_prefix);
+      auto* destination = reinterpret_cast<char*>(output.data());
+      const auto source_size = static_cast<int>(input.size() - lz4_size_prefix);
+      const auto destination_size = static_cast<int>(output.size());
+      const auto size =
+        dictionary.empty()
+          ? LZ4_decompress_safe(source, destination, source_size, destination_size)
+          : LZ4_decompress_safe_usingDict(source,
+                                          destination,
+                                          source_size,
+                                          destination_size,
+                                          reinterpret_cast<const char*>(dictionary.data()),
+                                          static_cast<int>(dictionary.size()));
+      if (size < 0 || static_cast<std::size_t>(size) != output.size()) {
+        return { error{ errc::field_level_encryption::decryption_failure,
+                        "LZ4 decompression failed" },
+                 {} };
+      }
+      return { error{}, std::move(output) };
+#else
+      return { unsupported(algorithm), {} };
+#endif
+    }
+
+    return { error{ errc::field_level_encryption::decryption_failure,
+                    fmt::format("Unknown compression algorithm `{}`", algorithm) },
+             {} };
+  }
+};
+
+auto
+is_compression_supported(compression_algorithm algorithm) -> bool
+{
+  switch (algorithm) {
+    case compression_algorithm::zstd:
+#ifdef COUCHBASE_CXX_ENCRYPTION_HAVE_ZSTD
+      return true;
+#else
+      return false;
+#endif
+    case compression_algorithm::lz4:
+#ifdef COUCHBASE_CXX_ENCRYPTION_HAVE_LZ4
+      return true;
+#else
+      return false;
+#endif
+  }
+  return false;
+}
+
+compressing_encrypter::compressing_encrypter(std::shared_ptr<encrypter> encrypter,
+                                             compression_options options)
+  : encrypter_{ std::move(encrypter) }
+  , options_{ std::move(options) }
+  , compressor_{ std::make_shared<compressor>() }
+{
+  if (options_.dictionary.has_value()) {
+    const auto& id = options_.dictionary->id;
+    if (id.empty() || id.size() > max_dictionary_id_size) {
+      compressor_->setup_error = { errc::field_level_encryption::encryption_failure,
+                                   fmt::format("The ID of a compression dictionary must be 1 to {} "
+                                               "bytes long.",
+                                               max_dictionary_id_size) };
+      return;
+    }
+    compressor_->header = make_header(algorithm_name(options_.algorithm), id);
+    compressor_->dictionary = options_.dictionary->bytes;
+#ifdef COUCHBASE_CXX_ENCRYPTION_HAVE_ZSTD
+    if (options_.algorithm == compression_algorithm::zstd) {
+      compressor_->zstd_dictionary.reset(ZSTD_createCDict(
+        compressor_->dictionary.data(), compressor_->dictionary.size(), options_.level));
+      if (!compressor_->zstd_dictionary) {
+        compressor_->setup_error = { errc::field_level_encryption::encryption_failure,
+                                     fmt::format("Could not prepare zstd compression dictionary "
+                                                 "with ID `{}`.",
+                                                 options_.dictionary->id) };
+      }
+    }
+#endif
+  } else {
+    compressor_->header = make_header(algorithm_name(options_.algorithm), {});
+  }
+}
+
+auto
+compressing_encrypter::encrypt(std::vector<std::byte> plaintext)
+  -> std::pair<error, encryption_result>
+{
+  if (compressor_->setup_error) {
+    return { compressor_->setup_error, {} };
+  }
+  if (plaintext.size() < options_.min_size) {
+    return encrypter_->encrypt(std::move(plaintext));
+  }
+
+  auto [err, compressed] = compressor_->compress(options_, plaintext);
+  if (err) {
+    return { err, {} };
+  }
+  if (compressed.size() >= plaintext.size()) {
+    return encrypter_->encrypt(std::move(plaintext));
+  }
+
+  auto [enc_err, result] = encrypter_->encrypt(std::move(compressed));
+  if (enc_err) {
+    return { enc_err, {} };
+  }
+  result.put(std::string{ compression_key }, std::string{ algorithm_name(options_.algorithm) });
+  if (options_.dictionary.has_value()) {
+    result.put(std::string{ dictionary_key }, options_.dictionary->id);
+  }
+  return { error{}, std::move(result) };
+}
+
+decompressing_decrypter::decompressing_decrypter(std::shared_ptr<decrypter> decrypter,
+                                                 std::vector<compression_dictionary> dictionaries,
+                                                 std::size_t max_plaintext_size)
+  : decrypter_{ std::move(decrypter) }
+  , max_plaintext_size_{ max_plaintext_size }
+{
+  for (auto& dict : dictionaries) {
+    auto prepared = std::make_shared<decompressor>();
+    prepared->dictionary = std::move(dict.bytes);
+#ifdef COUCHBASE_CXX_ENCRYPTION_HAVE_ZSTD
+    prepared->zstd_dictionary.reset(
+      ZSTD_createDDict(prepared->dictionary.data(), prepared->dictionary.size()));
+    if (!prepared->zstd_dictionary) {
+      prepared->zstd_setup_error = { errc::field_level_encryption::decryption_failure,
+                                     fmt::format("Could not prepare zstd compression dictionary "
+                                                 "with ID `{}`.",
+                                                 dict.id) };
+    }
+#endif
+    dictionaries_[std::move(dict.id)] = std::move(prepared);
+  }
+}
+
+auto
+decompressing_decrypter::decrypt(encryption_result encrypted)
+  -> std::pair<error, std::vector<std::byte>>
+{
+  const auto algorithm = encrypted.get(std::string{ compression_key });
+  const auto dictionary_id = encrypted.get(std::string{ dictionary_key });
+
+  auto [err, plaintext] = decrypter_->decrypt(std::move(encrypted));
+  if (err) {
+    return { err, std::move(plaintext) };
+  }
+
+  const auto header = read_header(plaintext);
+  if (!algorithm.has_value()) {
+    if (header.has_value()) {
+      return { error{ errc::field_level_encryption::decryption_failure,
+                      "The field is compressed, but its encryption result does not say so." },
+               {} };
+    }
+    return { error{}, std::move(plaintext) };
+  }
+  if (!header.has_value() || header->algorithm != algorithm.value() ||
+      header->dictionary_id != dictionary_id.value_or(std::string{})) {
+    return { error{ errc::field_level_encryption::decryption_failure,
+                    "The compression header of the field does not match its encryption result." },
+             {} };
+  }
+
+  static const decompressor no_dictionary{};
+  const decompressor* prepared = &no_dictionary;
+  if (!header->dictionary_id.empty()) {
+    const auto it = dictionaries_.find(header->dictionary_id);
+    if (it == dictionaries_.end()) {
+      return { error{ errc::field_level_encryption::decryption_failure,
+                      fmt::format("Could not find compression dictionary with ID `{}`.",
+                                  header->dictionary_id) },
+               {} };
+    }
+    prepared = it->second.get();
+  }
+  plaintext.erase(plaintext.begin(), plaintext.begin() + static_cast<std::ptrdiff_t>(header->size));
+  return prepared->decompress(algorithm.value(), plaintext, max_plaintext_size_);
+}
+
+auto
+decompressing_decrypter::algorithm() const -> const std::string&
+{
+  return decrypter_->algorithm();
+}
+
+void
+decompressing_decrypter::prefetch_keys(const std::vector<std::string>& key_ids)
+{
+  decrypter_->prefetch_keys(key_ids);
+}
+} // namespace couchbase::crypto
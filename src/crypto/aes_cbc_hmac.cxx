@@ -0,0 +1,388 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include "aes_cbc_hmac.hxx"
+
+#include <couchbase/error_codes.hxx>
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace couchbase::crypto::impl::aes_cbc_hmac
+{
+namespace
+{
+constexpr std::size_t half_key_size{ key_size / 2 };
+constexpr std::size_t aes_block_size{ 16 };
+constexpr std::size_t sha512_block_size{ 128 };
+constexpr std::size_t sha512_digest_size{ 64 };
+
+struct cipher_ctx_deleter {
+  void operator()(EVP_CIPHER_CTX* ctx) const
+  {
+    EVP_CIPHER_CTX_free(ctx);
+  }
+};
+
+using cipher_ctx = std::unique_ptr<EVP_CIPHER_CTX, cipher_ctx_deleter>;
+
+struct digest_ctx_deleter {
+  void operator()(EVP_MD_CTX* ctx) const
+  {
+    EVP_MD_CTX_free(ctx);
+  }
+};
+
+using digest_ctx = std::unique_ptr<EVP_MD_CTX, digest_ctx_deleter>;
+
+auto
+as_uchar(const std::byte* p) -> const unsigned char*
+{
+  return reinterpret_cast<const unsigned char*>(p);
+}
+
+auto
+as_uchar(std::byte* p) -> unsigned char*
+{
+  return reinterpret_cast<unsigned char*>(p);
+}
+
+/// Returns a SHA-512 context that has absorbed the HMAC key padded with the given byte
+auto
+padded_key_state(const std::byte* mac_key, std::byte pad) -> digest_ctx
+{
+  std::array<std::byte, sha512_block_size> padded{};
+  std::fill(padded.begin(), padded.end(), pad);
+  for (std::size_t i = 0; i < half_key_size; ++i) {
+    padded[i] ^= mac_key[i];
+  }
+  digest_ctx ctx{ EVP_MD_CTX_new() };
+  if (ctx && (EVP_DigestInit_ex(ctx.get(), EVP_sha512(), nullptr) != 1 ||
+              EVP_DigestUpdate(ctx.get(), padded.data(), padded.size()) != 1)) {
+    ctx.reset();
+  }
+  OPENSSL_cleanse(padded.data(), padded.size());
+  return ctx;
+}
+
+/// Returns a cipher context with the key schedule expanded, to be copied and given an IV
+auto
+cipher_state(const std::byte* aes_key, bool encrypt) -> cipher_ctx
+{
+  cipher_ctx ctx{ EVP_CIPHER_CTX_new() };
+  if (ctx && EVP_CipherInit_ex(ctx.get(),
+                               EVP_aes_256_cbc(),
+                               nullptr,
+                               as_uchar(aes_key),
+                               nullptr,
+                               encrypt ? 1 : 0) != 1) {
+    ctx.reset();
+  }
+  return ctx;
+}
+class openssl_key final : public prepared_key
+{
+public:
+  openssl_key() = default;
+  openssl_key(const openssl_key&) = delete;
+  openssl_key(openssl_key&&) = delete;
+  auto operator=(const openssl_key&) -> openssl_key& = delete;
+  auto operator=(openssl_key&&) -> openssl_key& = delete;
+  ~openssl_key() override;
+
+  [[nodiscard]] auto backend() const -> crypto_backend override
+  {
+    return crypto_backend::openssl;
+  }
+
+  [[nodiscard]] auto matches(const std::vector<std::byte>& key) const -> bool override;
+
+  [[nodiscard]] auto encrypt_into(gsl::span<const std::byte> iv,
+                                  gsl::span<const std::byte> plaintext,
+                                  gsl::span<const std::byte> associated_data,
+                                  gsl::span<std::byte> output) const -> error override;
+
+  [[nodiscard]] auto decrypt_into(gsl::span<const std::byte> ciphertext,
+                                  gsl::span<const std::byte> associated_data,
+                                  gsl::span<std::byte> output) const
+    -> std::pair<error, std::size_t> override;
+
+  std::array<std::byte, key_size> key{};
+  cipher_ctx encrypt_template{};
+  cipher_ctx decrypt_template{};
+  digest_ctx inner{};
+  digest_ctx outer{};
+
+  /**
+   * Computes the truncated HMAC-SHA512 of the associated data, the IV and ciphertext, and the
+   * length of the associated data in bits, as a 64-bit big-endian integer.
+   */
+  auto tag(gsl::span<const std::byte> associated_data,
+           const std::byte* ciphertext,
+           std::size_t ciphertext_size,
+           std::array<std::byte, sha512_digest_size>& mac) const -> bool
+  {
+    std::array<std::byte, 8> associated_data_bits{};
+    const auto bits = static_cast<std::uint64_t>(associated_data.size()) * 8;
+    for (std::size_t i = 0; i < associated_data_bits.size(); ++i) {
+      associated_data_bits[i] = static_cast<std::byte>(bits >> (56 - (8 * i)));
+    }
+
+    const digest_ctx ctx{ EVP_MD_CTX_new() };
+    unsigned int size = 0;
+    return ctx && EVP_MD_CTX_copy_ex(ctx.get(), inner.get()) == 1 &&
+           EVP_DigestUpdate(ctx.get(), associated_data.data(), associated_data.size()) == 1 &&
+           EVP_DigestUpdate(ctx.get(), ciphertext, ciphertext_size) == 1 &&
+           EVP_DigestUpdate(ctx.get(), associated_data_bits.data(), associated_data_bits.size()) ==
+             1 &&
+           EVP_DigestFinal_ex(ctx.get(), as_uchar(mac.data()), &size) == 1 &&
+           EVP_MD_CTX_copy_ex(ctx.get(), outer.get()) == 1 &&
+           EVP_DigestUpdate(ctx.get(), mac.data(), mac.size()) == 1 &&
+           EVP_DigestFinal_ex(ctx.get(), as_uchar(mac.data()), &size) == 1;
+  }
+};
+} // namespace
+
+openssl_key::~openssl_key()
+{
+  OPENSSL_cleanse(key.data(), key.size());
+}
+
+auto
+prepare_openssl(const std::vector<std::byte>& key)
+  -> std::pair<error, std::shared_ptr<const prepared_key>>
+{
+  if (key.size() != key_size) {
+    return { error{ errc::field_level_encryption::invalid_crypto_key,
+                    "AEAD_AES_256_CBC_HMAC_SHA512 requires a key of 64 bytes" },
+             {} };
+  }
+  auto prepared = std::make_shared<openssl_key>();
+  std::copy(key.begin(), key.end(), prepared->key.begin());
+  prepared->encrypt_template = cipher_state(key.data() + half_key_size, true);
+  prepared->decrypt_template = cipher_state(key.data() + half_key_size, false);
+  prepared->inner = padded_key_state(key.data(), std::byte{ 0x36 });
+  prepared->outer = padded_key_state(key.data(), std::byte{ 0x5c });
+  if (!prepared->encrypt_template || !prepared->decrypt_template || !prepared->inner ||
+      !prepared->outer) {
+    return { error{ errc::field_level_encryption::generic_cryptography_failure,
+                    "unable to set up AEAD_AES_256_CBC_HMAC_SHA512 key" },
+             {} };
+  }
+  return { error{}, std::move(prepared) };
+}
+
+auto
+prepared_key::prepare(const std::vector<std::byte>& key)
+  -> std::pair<error, std::shared_ptr<const prepared_key>>
+{
+  return prepare(key, active_crypto_backend());
+}
+
+auto
+prepared_key::prepare(const std::vector<std::byte>& key, crypto_backend backend)
+  -> std::pair<error, std::shared_ptr<const prepared_key>>
+{
+  switch (backend) {
+    case crypto_backend::couchbase_sdk:
+      return prepare_couchbase_sdk(key);
+    case crypto_backend::openssl:
+      break;
+  }
+  return prepare_openssl(key);
+}
+
+auto
+prepared_key::encrypt(const std::vector<std::byte>& iv,
+                      const std::vector<std::byte>& plaintext,
+                      const std::vector<std::byte>& associated_data) const
+  -> std::pair<error, std::vector<std::byte>>
+{
+  std::vector<std::byte> output(ciphertext_size(plaintext.size()));
+  if (auto err = encrypt_into(iv, plaintext, associated_data, output); err) {
+    return { std::move(err), {} };
+  }
+  return { error{}, std::move(output) };
+}
+
+auto
+prepared_key::decrypt(const std::vector<std::byte>& ciphertext,
+                      const std::vector<std::byte>& associated_data) const
+  -> std::pair<error, std::vector<std::byte>>
+{
+  std::vector<std::byte> plaintext(
+    ciphertext.size() > iv_size + tag_size ? ciphertext.size() - iv_size - tag_size : 0);
+  auto [err, size] = decrypt_into(ciphertext, associated_data, plaintext);
+  if (err) {
+    return { std::move(err), {} };
+  }
+  plaintext.resize(size);
+  return { error{}, std::move(plaintext) };
+}
+
+auto
+openssl_key::matches(const std::vector<std::byte>& key) const -> bool
+{
+  return key.size() == key_size &&
+         CRYPTO_memcmp(key.data(), this->key.data(), this->key.size()) == 0;
+}
+
+auto
+openssl_key::encrypt_into(gsl::span<const std::byte> iv,
+                           gsl::span<const std::byte> plaintext,
+                           gsl::span<const std::byte> associated_data,
+                           gsl::span<std::byte> output) const -> error
+{
+  if (iv.size() != iv_size) {
+    return { errc::field_level_encryption::encryption_failure,
+             "AEAD_AES_256_CBC_HMAC_SHA512 requires an IV of 16 bytes" };
+  }
+  if (output.size() != ciphertext_size(plaintext.size())) {
+    return { errc::field_level_encryption::encryption_failure,
+             "output does not match the size of the ciphertext" };
+  }
+
+  // PKCS#7 padding always adds between 1 and 16 bytes
+  const auto padded_size = output.size() - iv_size - tag_size;
+  std::copy(iv.begin(), iv.end(), output.data());
+
+  const cipher_ctx ctx{ EVP_CIPHER_CTX_new() };
+  int update_size = 0;
+  int final_size = 0;
+  if (!ctx || EVP_CIPHER_CTX_copy(ctx.get(), encrypt_template.get()) != 1 ||
+      EVP_EncryptInit_ex(ctx.get(), nullptr, nullptr, nullptr, as_uchar(iv.data())) != 1 ||
+      EVP_EncryptUpdate(ctx.get(),
+                        as_uchar(output.data() + iv_size),
+                        &update_size,
+                        as_uchar(plaintext.data()),
+                        static_cast<int>(plaintext.size())) != 1 ||
+      EVP_EncryptFinal_ex(
+        ctx.get(), as_uchar(output.data() + iv_size + update_size), &final_size) != 1 ||
+      static_cast<std::size_t>(update_size + final_size) != padded_size) {
+    return { errc::field_level_encryption::encryption_failure, "unable to encrypt plaintext" };
+  }
+
+  std::array<std::byte, sha512_digest_size> mac{};
+  if (!tag(associated_data, output.data(), iv_size + padded_size, mac)) {
+    return { errc::field_level_encryption::encryption_failure,
+             "unable to compute authentication tag" };
+  }
+  std::copy_n(mac.begin(), tag_size, output.data() + iv_size + padded_size);
+  return {};
+}
+
+auto
+openssl_key::decrypt_into(gsl::span<const std::byte> ciphertext,
+                           gsl::span<const std::byte> associated_data,
+                           gsl::span<std::byte> output) const -> std::pair<error, std::size_t>
+{
+  if (ciphertext.size() < iv_size + aes_block_size + tag_size) {
+    return { error{ errc::field_level_encryption::invalid_ciphertext,
+                    "ciphertext is shorter than the IV, one block and the authentication tag" },
+             0 };
+  }
+  const auto encrypted_size = ciphertext.size() - iv_size - tag_size;
+  if (encrypted_size % aes_block_size != 0) {
+    return { error{ errc::field_level_encryption::invalid_ciphertext,
+                    "ciphertext is not a whole number of blocks" },
+             0 };
+  }
+  // every block but the last holds plaintext only, the last holds at least one byte of padding
+  const auto body_size = encrypted_size - aes_block_size;
+  if (output.size() < body_size) {
+    return { error{ errc::field_level_encryption::decryption_failure,
+                    "output is too small for the plaintext" },
+             0 };
+  }
+
+  std::array<std::byte, sha512_digest_size> mac{};
+  if (!tag(associated_data, ciphertext.data(), iv_size + encrypted_size, mac) ||
+      CRYPTO_memcmp(mac.data(), ciphertext.data() + iv_size + encrypted_size, tag_size) != 0) {
+    return { error{ errc::field_level_encryption::decryption_failure,
+                    "authentication tag mismatch" },
+             0 };
+  }
+
+  // the padding is checked by hand, as the cipher would otherwise write up to a block past the
+  // plaintext, and outputs may be regions of a larger buffer; the tag was checked first, so this
+  // cannot be used as a padding oracle
+  std::array<std::byte, aes_block_size> last_block{};
+  const cipher_ctx ctx{ EVP_CIPHER_CTX_new() };
+  int body_written = 0;
+  int last_written = 0;
+  if (!ctx || EVP_CIPHER_CTX_copy(ctx.get(), decrypt_template.get()) != 1 ||
+      EVP_DecryptInit_ex(ctx.get(), nullptr, nullptr, nullptr, as_uchar(ciphertext.data())) != 1 ||
+      EVP_CIPHER_CTX_set_padding(ctx.get(), 0) != 1 ||
+      EVP_DecryptUpdate(ctx.get(),
+                        as_uchar(output.data()),
+                        &body_written,
+                        as_uchar(ciphertext.data() + iv_size),
+                        static_cast<int>(body_size)) != 1 ||
+      EVP_DecryptUpdate(ctx.get(),
+                        as_uchar(last_block.data()),
+                        &last_written,
+                        as_uchar(ciphertext.data() + iv_size + body_size),
+                        static_cast<int>(aes_block_size)) != 1 ||
+      static_cast<std::size_t>(body_written) != body_size ||
+      static_cast<std::size_t>(last_written) != aes_block_size) {
+    OPENSSL_cleanse(output.data(), body_size);
+    OPENSSL_cleanse(last_block.data(), last_block.size());
+    return { error{ errc::field_level_encryption::decryption_failure,
+                    "unable to decrypt ciphertext" },
+             0 };
+  }
+
+  const auto padding = std::to_integer<std::size_t>(last_block.back());
+  if (padding == 0 || padding > aes_block_size ||
+      body_size + aes_block_size - padding > output.size() ||
+      std::any_of(last_block.end() - static_cast<std::ptrdiff_t>(padding),
+                  last_block.end(),
+                  [padding](std::byte b) {
+                    return std::to_integer<std::size_t>(b) != padding;
+                  })) {
+    OPENSSL_cleanse(output.data(), body_size);
+    OPENSSL_cleanse(last_block.data(), last_block.size());
+    return { error{ errc::field_level_encryption::decryption_failure,
+                    "unable to decrypt ciphertext" },
+             0 };
+  }
+  std::copy_n(last_block.begin(), aes_block_size - padding, output.data() + body_size);
+  OPENSSL_cleanse(last_block.data(), last_block.size());
+  return { error{}, body_size + aes_block_size - padding };
+}
+
+auto
+prepared_key_cache::get(const key& k) -> std::pair<error, std::shared_ptr<const prepared_key>>
+{
+  const auto backend = active_crypto_backend();
+  {
+    const std::scoped_lock lock(mutex_);
+    const auto it = keys_.find(k.id());
+    if (it != keys_.end() && it->second->backend() == backend && it->second->matches(k.bytes())) {
+      return { {}, it->second };
+    }
+  }
+
+  // keys are prepared without holding the lock, threads that race to prepare the same key store
+  // equivalent states
+  auto [err, prepared] = prepared_key::prepare(k.bytes(), backend);
+  if (err) {
+    return { std::move(err), {} };
+  }
+  const std::scoped_lock lock(mutex_);
+  if (keys_.size() >= max_keys) {
+    keys_.clear();
+  }
+  keys_[k.id()] = prepared;
+  return { error{}, std::move(prepared) };
+}
+} // namespace couchbase::crypto::impl::aes_cbc_hmac
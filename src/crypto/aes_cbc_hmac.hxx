@@ -0,0 +1,149 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#pragma once
+
+#include <couchbase/error.hxx>
+#include <couchbase_encryption/crypto_backend.hxx>
+#include <couchbase_encryption/key.hxx>
+
+#include <gsl/span>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * AEAD_AES_256_CBC_HMAC_SHA512, as described in
+ * <a href="https://tools.ietf.org/html/draft-mcgrew-aead-aes-cbc-hmac-sha2-05">Authenticated
+ * Encryption with AES-CBC and HMAC-SHA</a>, with the key set up once and reused for every value,
+ * by one of the implementations listed in couchbase::crypto::crypto_backend.
+ *
+ * The first half of the 64 byte key is the HMAC key, the second half the AES key. The output is the
+ * 16 byte IV, followed by the AES-CBC ciphertext, followed by the HMAC-SHA512 tag truncated to 32
+ * bytes.
+ */
+namespace couchbase::crypto::impl::aes_cbc_hmac
+{
+constexpr std::size_t key_size{ 64 };
+constexpr std::size_t iv_size{ 16 };
+constexpr std::size_t tag_size{ 32 };
+
+/**
+ * Returns the size of the output for a plaintext of the given size. PKCS#7 padding always adds
+ * between 1 and 16 bytes, the size of an AES block and of the IV.
+ */
+constexpr auto
+ciphertext_size(std::size_t plaintext_size) -> std::size_t
+{
+  return iv_size + (plaintext_size / iv_size + 1) * iv_size + tag_size;
+}
+
+/**
+ * A key set up for one of the implementations of the algorithm, see
+ * couchbase::crypto::crypto_backend. A prepared key can be used by any number of threads at once.
+ */
+class prepared_key
+{
+public:
+  prepared_key() = default;
+  prepared_key(const prepared_key&) = delete;
+  prepared_key(prepared_key&&) = delete;
+  auto operator=(const prepared_key&) -> prepared_key& = delete;
+  auto operator=(prepared_key&&) -> prepared_key& = delete;
+  virtual ~prepared_key() = default;
+
+  /**
+   * Sets up the given key, which must be 64 bytes long, for the active backend.
+   */
+  static auto prepare(const std::vector<std::byte>& key)
+    -> std::pair<error, std::shared_ptr<const prepared_key>>;
+
+  /**
+   * Sets up the given key, which must be 64 bytes long, for the given backend.
+   */
+  static auto prepare(const std::vector<std::byte>& key, crypto_backend backend)
+    -> std::pair<error, std::shared_ptr<const prepared_key>>;
+
+  /**
+   * Returns the backend this key was prepared for.
+   */
+  [[nodiscard]] virtual auto backend() const -> crypto_backend = 0;
+
+  /**
+   * Returns true if this key was prepared from the given bytes.
+   */
+  [[nodiscard]] virtual auto matches(const std::vector<std::byte>& key) const -> bool = 0;
+
+  [[nodiscard]] auto encrypt(const std::vector<std::byte>& iv,
+                             const std::vector<std::byte>& plaintext,
+                             const std::vector<std::byte>& associated_data) const
+    -> std::pair<error, std::vector<std::byte>>;
+
+  [[nodiscard]] auto decrypt(const std::vector<std::byte>& ciphertext,
+                             const std::vector<std::byte>& associated_data) const
+    -> std::pair<error, std::vector<std::byte>>;
+
+  /**
+   * Encrypts the plaintext into the given output, which must be exactly
+   * `ciphertext_size(plaintext.size())` bytes long.
+   */
+  [[nodiscard]] virtual auto encrypt_into(gsl::span<const std::byte> iv,
+                                          gsl::span<const std::byte> plaintext,
+                                          gsl::span<const std::byte> associated_data,
+                                          gsl::span<std::byte> output) const -> error = 0;
+
+  /**
+   * Decrypts the ciphertext into the given output, failing if the plaintext does not fit. Only the
+   * bytes of the plaintext are written, which is at most 49 bytes less than the ciphertext.
+   *
+   * @return the size of the plaintext
+   */
+  [[nodiscard]] virtual auto decrypt_into(gsl::span<const std::byte> ciphertext,
+                                          gsl::span<const std::byte> associated_data,
+                                          gsl::span<std::byte> output) const
+    -> std::pair<error, std::size_t> = 0;
+};
+
+/**
+ * Sets up the key for OpenSSL, with its AES key schedules expanded, and the HMAC-SHA512 states
+ * after the inner and outer padded keys. Every operation starts from copies of these.
+ */
+auto
+prepare_openssl(const std::vector<std::byte>& key)
+  -> std::pair<error, std::shared_ptr<const prepared_key>>;
+
+/**
+ * Sets up the key for the implementation of the C++ SDK, which sets up the cipher and the HMAC for
+ * every operation.
+ */
+auto
+prepare_couchbase_sdk(const std::vector<std::byte>& key)
+  -> std::pair<error, std::shared_ptr<const prepared_key>>;
+
+/**
+ * The prepared keys of a provider, by key ID. A key is prepared again if the keyring returns
+ * different bytes for its ID, e.g. after the key was rotated, or if another backend was pinned.
+ */
+class prepared_key_cache
+{
+public:
+  auto get(const key& k) -> std::pair<error, std::shared_ptr<const prepared_key>>;
+
+private:
+  /// Beyond this number of key IDs, the cache is emptied rather than growing without bound
+  static constexpr std::size_t max_keys{ 256 };
+
+  std::mutex mutex_{};
+  std::unordered_map<std::string, std::shared_ptr<const prepared_key>> keys_{};
+};
+} // namespace couchbase::crypto::impl::aes_cbc_hmac
@@ -0,0 +1,117 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include "aes_cbc_hmac.hxx"
+
+#include <couchbase/crypto/internal.hxx>
+#include <couchbase/error_codes.hxx>
+
+#include <openssl/crypto.h>
+
+#include <algorithm>
+
+namespace couchbase::crypto::impl::aes_cbc_hmac
+{
+namespace
+{
+/**
+ * A key for the implementation of the C++ SDK, which only takes and returns vectors.
+ */
+class couchbase_sdk_key final : public prepared_key
+{
+public:
+  explicit couchbase_sdk_key(std::vector<std::byte> key)
+    : key_{ std::move(key) }
+  {
+  }
+
+  couchbase_sdk_key(const couchbase_sdk_key&) = delete;
+  couchbase_sdk_key(couchbase_sdk_key&&) = delete;
+  auto operator=(const couchbase_sdk_key&) -> couchbase_sdk_key& = delete;
+  auto operator=(couchbase_sdk_key&&) -> couchbase_sdk_key& = delete;
+
+  ~couchbase_sdk_key() override
+  {
+    OPENSSL_cleanse(key_.data(), key_.size());
+  }
+
+  [[nodiscard]] auto backend() const -> crypto_backend override
+  {
+    return crypto_backend::couchbase_sdk;
+  }
+
+  [[nodiscard]] auto matches(const std::vector<std::byte>& key) const -> bool override
+  {
+    return key.size() == key_.size() && CRYPTO_memcmp(key.data(), key_.data(), key_.size()) == 0;
+  }
+
+  [[nodiscard]] auto encrypt_into(gsl::span<const std::byte> iv,
+                                  gsl::span<const std::byte> plaintext,
+                                  gsl::span<const std::byte> associated_data,
+                                  gsl::span<std::byte> output) const -> error override
+  {
+    if (output.size() != ciphertext_size(plaintext.size())) {
+      return { errc::field_level_encryption::encryption_failure,
+               "output does not match the size of the ciphertext" };
+    }
+    auto [err, ciphertext] = internal::aead_aes_256_cbc_hmac_sha512::encrypt(
+      key_,
+      { iv.begin(), iv.end() },
+      { plaintext.begin(), plaintext.end() },
+      { associated_data.begin(), associated_data.end() });
+    if (err) {
+      return err;
+    }
+    if (ciphertext.size() != output.size()) {
+      return { errc::field_level_encryption::encryption_failure,
+               "unexpected size of the ciphertext" };
+    }
+    std::copy(ciphertext.begin(), ciphertext.end(), output.data());
+    return {};
+  }
+
+  [[nodiscard]] auto decrypt_into(gsl::span<const std::byte> ciphertext,
+                                  gsl::span<const std::byte> associated_data,
+                                  gsl::span<std::byte> output) const
+    -> std::pair<error, std::size_t> override
+  {
+    auto [err, plaintext] = internal::aead_aes_256_cbc_hmac_sha512::decrypt(
+      key_,
+      { ciphertext.begin(), ciphertext.end() },
+      { associated_data.begin(), associated_data.end() });
+    if (err) {
+      return { std::move(err), 0 };
+    }
+    if (plaintext.size() > output.size()) {
+      OPENSSL_cleanse(plaintext.data(), plaintext.size());
+      return { error{ errc::field_level_encryption::decryption_failure,
+                      "output is too small for the plaintext" },
+               0 };
+    }
+    std::copy(plaintext.begin(), plaintext.end(), output.data());
+    OPENSSL_cleanse(plaintext.data(), plaintext.size());
+    return { error{}, plaintext.size() };
+  }
+
+private:
+  std::vector<std::byte> key_;
+};
+} // namespace
+
+auto
+prepare_couchbase_sdk(const std::vector<std::byte>& key)
+  -> std::pair<error, std::shared_ptr<const prepared_key>>
+{
+  if (key.size() != key_size) {
+    return { error{ errc::field_level_encryption::invalid_crypto_key,
+                    "AEAD_AES_256_CBC_HMAC_SHA512 requires a key of 64 bytes" },
+             {} };
+  }
+  return { error{}, std::make_shared<const couchbase_sdk_key>(key) };
+}
+} // namespace couchbase::crypto::impl::aes_cbc_hmac
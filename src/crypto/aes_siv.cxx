@@ -0,0 +1,346 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include "aes_siv.hxx"
+
+#include <couchbase/error_codes.hxx>
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+
+#include <algorithm>
+#include <array>
+#include <memory>
+
+namespace couchbase::crypto::impl::aes_siv
+{
+namespace
+{
+using block = std::array<std::byte, block_size>;
+
+struct cipher_ctx_deleter {
+  void operator()(EVP_CIPHER_CTX* ctx) const
+  {
+    EVP_CIPHER_CTX_free(ctx);
+  }
+};
+
+using cipher_ctx = std::unique_ptr<EVP_CIPHER_CTX, cipher_ctx_deleter>;
+
+auto
+as_uchar(const std::byte* p) -> const unsigned char*
+{
+  return reinterpret_cast<const unsigned char*>(p);
+}
+
+auto
+as_uchar(std::byte* p) -> unsigned char*
+{
+  return reinterpret_cast<unsigned char*>(p);
+}
+
+auto
+cbc_cipher(std::size_t key_size) -> const EVP_CIPHER*
+{
+  switch (key_size) {
+    case 16:
+      return EVP_aes_128_cbc();
+    case 24:
+      return EVP_aes_192_cbc();
+    case 32:
+      return EVP_aes_256_cbc();
+    default:
+      return nullptr;
+  }
+}
+
+auto
+ctr_cipher(std::size_t key_size) -> const EVP_CIPHER*
+{
+  switch (key_size) {
+    case 16:
+      return EVP_aes_128_ctr();
+    case 24:
+      return EVP_aes_192_ctr();
+    case 32:
+      return EVP_aes_256_ctr();
+    default:
+      return nullptr;
+  }
+}
+
+/// Doubling in GF(2^128), as defined in RFC 5297 section 2.3
+auto
+dbl(const block& in) -> block
+{
+  block out{};
+  std::uint8_t carry = 0;
+  for (std::size_t i = block_size; i-- > 0;) {
+    const auto b = std::to_integer<std::uint8_t>(in[i]);
+    out[i] = static_cast<std::byte>(static_cast<std::uint8_t>(b << 1U) | carry);
+    carry = static_cast<std::uint8_t>(b >> 7U);
+  }
+  if (carry != 0) {
+    out[block_size - 1] ^= std::byte{ 0x87 };
+  }
+  return out;
+}
+
+void
+xor_into(block& target, const std::byte* source)
+{
+  for (std::size_t i = 0; i < block_size; ++i) {
+    target[i] ^= source[i];
+  }
+}
+
+/**
+ * AES-CMAC (RFC 4493), computed incrementally. The CBC-MAC is delegated to an AES-CBC context with
+ * a zero IV, which keeps the chaining value between updates.
+ */
+class cmac
+{
+public:
+  auto init(const std::byte* key, std::size_t key_size) -> bool
+  {
+    ctx_.reset(EVP_CIPHER_CTX_new());
+    const block zero_iv{};
+    if (!ctx_ ||
+        EVP_EncryptInit_ex(
+          ctx_.get(), cbc_cipher(key_size), nullptr, as_uchar(key), as_uchar(zero_iv.data())) !=
+          1 ||
+        EVP_CIPHER_CTX_set_padding(ctx_.get(), 0) != 1) {
+      return false;
+    }
+    block l{};
+    if (!encrypt_block(l.data(), l)) {
+      return false;
+    }
+    k1_ = dbl(l);
+    k2_ = dbl(k1_);
+    return true;
+  }
+
+  auto reset() -> bool
+  {
+    buffered_ = 0;
+    const block zero_iv{};
+    return EVP_EncryptInit_ex(ctx_.get(), nullptr, nullptr, nullptr, as_uchar(zero_iv.data())) ==
+           1;
+  }
+
+  auto update(const std::byte* data, std::size_t size) -> bool
+  {
+    while (size > 0) {
+      if (buffered_ == block_size) {
+        // the buffered block is not the last one, so it can be chained now
+        if (block out{}; !encrypt_block(buffer_.data(), out)) {
+          return false;
+        }
+        buffered_ = 0;
+      }
+      const auto n = std::min(size, block_size - buffered_);
+      std::copy_n(data, n, buffer_.begin() + static_cast<std::ptrdiff_t>(buffered_));
+      buffered_ += n;
+      data += n;
+      size -= n;
+    }
+    return true;
+  }
+
+  auto final(block& mac) -> bool
+  {
+    block last{};
+    if (buffered_ == block_size) {
+      last = buffer_;
+      xor_into(last, k1_.data());
+    } else {
+      std::copy_n(buffer_.begin(), buffered_, last.begin());
+      last[buffered_] = std::byte{ 0x80 };
+      xor_into(last, k2_.data());
+    }
+    return encrypt_block(last.data(), mac);
+  }
+
+  auto compute(const std::byte* data, std::size_t size, block& mac) -> bool
+  {
+    return reset() && update(data, size) && final(mac);
+  }
+
+private:
+  auto encrypt_block(const std::byte* in, block& out) -> bool
+  {
+    int out_len = 0;
+    return EVP_EncryptUpdate(
+             ctx_.get(), as_uchar(out.data()), &out_len, as_uchar(in), block_size) == 1;
+  }
+
+  cipher_ctx ctx_{};
+  block k1_{};
+  block k2_{};
+  block buffer_{};
+  std::size_t buffered_{ 0 };
+};
+
+/// S2V, as defined in RFC 5297 section 2.4, with the plaintext as the last component
+auto
+s2v(const std::byte* key,
+    std::size_t key_size,
+    const std::vector<std::vector<std::byte>>& associated_data,
+    const std::byte* plaintext,
+    std::size_t plaintext_size,
+    block& v) -> bool
+{
+  cmac mac{};
+  if (!mac.init(key, key_size)) {
+    return false;
+  }
+  block d{};
+  if (const block zero{}; !mac.compute(zero.data(), zero.size(), d)) {
+    return false;
+  }
+  for (const auto& ad : associated_data) {
+    block ad_mac{};
+    if (!mac.compute(ad.data(), ad.size(), ad_mac)) {
+      return false;
+    }
+    d = dbl(d);
+    xor_into(d, ad_mac.data());
+  }
+
+  if (!mac.reset()) {
+    return false;
+  }
+  if (plaintext_size >= block_size) {
+    const auto prefix_size = plaintext_size - block_size;
+    block last{};
+    std::copy_n(plaintext + prefix_size, block_size, last.begin());
+    xor_into(last, d.data());
+    return mac.update(plaintext, prefix_size) && mac.update(last.data(), last.size()) &&
+           mac.final(v);
+  }
+  block t = dbl(d);
+  block padded{};
+  std::copy_n(plaintext, plaintext_size, padded.begin());
+  padded[plaintext_size] = std::byte{ 0x80 };
+  xor_into(t, padded.data());
+  return mac.update(t.data(), t.size()) && mac.final(v);
+}
+
+auto
+ctr(const std::byte* key,
+    std::size_t key_size,
+    const block& v,
+    const std::byte* input,
+    std::size_t size,
+    std::byte* output) -> bool
+{
+  // Q = V bitand (1^64 || 0^1 || 1^31 || 0^1 || 1^31)
+  block q = v;
+  q[8] &= std::byte{ 0x7f };
+  q[12] &= std::byte{ 0x7f };
+
+  const cipher_ctx ctx{ EVP_CIPHER_CTX_new() };
+  if (!ctx || EVP_EncryptInit_ex(
+                ctx.get(), ctr_cipher(key_size), nullptr, as_uchar(key), as_uchar(q.data())) != 1) {
+    return false;
+  }
+  int out_len = 0;
+  if (size > 0 &&
+      EVP_EncryptUpdate(
+        ctx.get(), as_uchar(output), &out_len, as_uchar(input), static_cast<int>(size)) != 1) {
+    return false;
+  }
+  return EVP_EncryptFinal_ex(ctx.get(), as_uchar(output) + out_len, &out_len) == 1;
+}
+
+auto
+check_key(const std::vector<std::byte>& key) -> error
+{
+  if (cbc_cipher(key.size() / 2) == nullptr || key.size() % 2 != 0) {
+    return { errc::field_level_encryption::invalid_crypto_key,
+             "AES-SIV requires a key of 32, 48 or 64 bytes" };
+  }
+  return {};
+}
+} // namespace
+
+auto
+encrypt(const std::vector<std::byte>& key,
+        const std::vector<std::byte>& plaintext,
+        const std::vector<std::vector<std::byte>>& associated_data)
+  -> std::pair<error, std::vector<std::byte>>
+{
+  if (auto err = check_key(key); err) {
+    return { std::move(err), {} };
+  }
+  const auto half = key.size() / 2;
+
+  block v{};
+  if (!s2v(key.data(), half, associated_data, plaintext.data(), plaintext.size(), v)) {
+    return { error{ errc::field_level_encryption::encryption_failure,
+                    "unable to compute synthetic initialization vector" },
+             {} };
+  }
+
+  std::vector<std::byte> ciphertext(block_size + plaintext.size());
+  std::copy(v.begin(), v.end(), ciphertext.begin());
+  if (!ctr(key.data() + half,
+           half,
+           v,
+           plaintext.data(),
+           plaintext.size(),
+           ciphertext.data() + block_size)) {
+    return { error{ errc::field_level_encryption::encryption_failure,
+                    "unable to encrypt plaintext" },
+             {} };
+  }
+  return { error{}, std::move(ciphertext) };
+}
+
+auto
+decrypt(const std::vector<std::byte>& key,
+        const std::vector<std::byte>& ciphertext,
+        const std::vector<std::vector<std::byte>>& associated_data)
+  -> std::pair<error, std::vector<std::byte>>
+{
+  if (auto err = check_key(key); err) {
+    return { std::move(err), {} };
+  }
+  if (ciphertext.size() < block_size) {
+    return { error{ errc::field_level_encryption::invalid_ciphertext,
+                    "ciphertext is shorter than the synthetic initialization vector" },
+             {} };
+  }
+  const auto half = key.size() / 2;
+
+  block v{};
+  std::copy_n(ciphertext.begin(), block_size, v.begin());
+  std::vector<std::byte> plaintext(ciphertext.size() - block_size);
+  if (!ctr(key.data() + half,
+           half,
+           v,
+           ciphertext.data() + block_size,
+           plaintext.size(),
+           plaintext.data())) {
+    return { error{ errc::field_level_encryption::decryption_failure,
+                    "unable to decrypt ciphertext" },
+             {} };
+  }
+
+  block t{};
+  if (!s2v(key.data(), half, associated_data, plaintext.data(), plaintext.size(), t) ||
+      CRYPTO_memcmp(t.data(), v.data(), block_size) != 0) {
+    OPENSSL_cleanse(plaintext.data(), plaintext.size());
+    return { error{ errc::field_level_encryption::decryption_failure,
+                    "synthetic initialization vector mismatch" },
+             {} };
+  }
+  return { error{}, std::move(plaintext) };
+}
+} // namespace couchbase::crypto::impl::aes_siv
@@ -0,0 +1,51 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#pragma once
+
+#include <couchbase/error.hxx>
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * Deterministic authenticated encryption using AES-SIV, as described in
+ * <a href="https://tools.ietf.org/html/rfc5297">RFC 5297</a>.
+ *
+ * The key is split in two halves: the first is used for S2V (AES-CMAC), the second for AES-CTR.
+ * The half-key length selects the AES variant, so a 64 byte key gives AEAD_AES_SIV_CMAC_512.
+ *
+ * The output is the 16 byte synthetic IV followed by the ciphertext, which has the same length as
+ * the plaintext.
+ */
+namespace couchbase::crypto::impl::aes_siv
+{
+constexpr std::size_t block_size{ 16 };
+
+/**
+ * Returns the size of the output for a plaintext of the given size.
+ */
+constexpr auto
+ciphertext_size(std::size_t plaintext_size) -> std::size_t
+{
+  return block_size + plaintext_size;
+}
+
+auto
+encrypt(const std::vector<std::byte>& key,
+        const std::vector<std::byte>& plaintext,
+        const std::vector<std::vector<std::byte>>& associated_data)
+  -> std::pair<error, std::vector<std::byte>>;
+
+auto
+decrypt(const std::vector<std::byte>& key,
+        const std::vector<std::byte>& ciphertext,
+        const std::vector<std::vector<std::byte>>& associated_data)
+  -> std::pair<error, std::vector<std::byte>>;
+} // namespace couchbase::crypto::impl::aes_siv
@@ -0,0 +1,292 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include "chunked_cbc_hmac.hxx"
+
+#include "../utils/base64.h"
+
+#include <couchbase/error_codes.hxx>
+#include <couchbase_encryption/crypto_executor.hxx>
+
+#include <openssl/crypto.h>
+#include <openssl/rand.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace couchbase::crypto::impl::chunked_cbc_hmac
+{
+namespace
+{
+/// Base64 is encoded and decoded in slices of 64 Ki groups of 3 bytes and 4 characters
+constexpr std::size_t binary_slice_size{ 3 * 64 * 1024 };
+constexpr std::size_t text_slice_size{ 4 * 64 * 1024 };
+constexpr std::size_t associated_data_size{ aes_cbc_hmac::iv_size + 8 + 1 };
+constexpr std::size_t min_segment_size{ aes_cbc_hmac::ciphertext_size(0) };
+
+/**
+ * The indices that remain to be processed by a call to for_each_index(), shared with the tasks
+ * posted to the executor, which may only start once the call has returned.
+ */
+struct shared_progress {
+  std::size_t count;
+  const std::function<error(std::size_t)>* task;
+  std::atomic<std::size_t> next{ 0 };
+  std::atomic<bool> failed{ false };
+  std::mutex mutex{};
+  std::condition_variable all_done{};
+  std::size_t done{ 0 };
+  error first_error{};
+
+  shared_progress(std::size_t count, const std::function<error(std::size_t)>* task)
+    : count{ count }
+    , task{ task }
+  {
+  }
+
+  void work()
+  {
+    for (auto index = next++; index < count; index = next++) {
+      error err{};
+      if (!failed) {
+        try {
+          err = (*task)(index);
+        } catch (const std::exception& e) {
+          err = { errc::field_level_encryption::generic_cryptography_failure, e.what() };
+        }
+      }
+      const std::scoped_lock lock(mutex);
+      if (err && !failed) {
+        failed = true;
+        first_error = std::move(err);
+      }
+      if (++done == count) {
+        all_done.notify_all();
+      }
+    }
+  }
+};
+
+/**
+ * Calls the task with every index below the count, on the calling thread and, if an executor is
+ * given, on its worker threads as well, and returns the first error. Indices are claimed one at a
+ * time, and the calling thread only waits for the indices claimed by a worker, so this does not
+ * deadlock when called from a task of the same executor.
+ */
+auto
+for_each_index(crypto_executor* executor,
+               std::size_t count,
+               const std::function<error(std::size_t)>& task) -> error
+{
+  if (executor == nullptr || count < 2) {
+    for (std::size_t index = 0; index < count; ++index) {
+      if (auto err = task(index); err) {
+        return err;
+      }
+    }
+    return {};
+  }
+
+  auto progress = std::make_shared<shared_progress>(count, &task);
+  const auto helpers = std::min(count - 1, executor->threads());
+  for (std::size_t i = 0; i < helpers; ++i) {
+    executor->post([progress] {
+      progress->work();
+    });
+  }
+  progress->work();
+  std::unique_lock lock(progress->mutex);
+  progress->all_done.wait(lock, [&progress] {
+    return progress->done == progress->count;
+  });
+  return std::move(progress->first_error);
+}
+
+auto
+associated_data(gsl::span<const std::byte> first_iv, std::size_t index, bool last)
+  -> std::array<std::byte, associated_data_size>
+{
+  std::array<std::byte, associated_data_size> data{};
+  std::copy(first_iv.begin(), first_iv.end(), data.begin());
+  const auto index_bits = static_cast<std::uint64_t>(index);
+  for (std::size_t i = 0; i < 8; ++i) {
+    data[aes_cbc_hmac::iv_size + i] = static_cast<std::byte>(index_bits >> (56 - (8 * i)));
+  }
+  data.back() = last ? std::byte{ 1 } : std::byte{ 0 };
+  return data;
+}
+
+auto
+base64_size(std::size_t size) -> std::size_t
+{
+  return (size + 2) / 3 * 4;
+}
+
+auto
+encode_base64(const std::vector<std::byte>& binary, crypto_executor* executor)
+  -> std::pair<error, std::string>
+{
+  std::string text(base64_size(binary.size()), '\0');
+  const auto slices = (binary.size() + binary_slice_size - 1) / binary_slice_size;
+  auto err = for_each_index(executor, slices, [&binary, &text](std::size_t slice) -> error {
+    const auto offset = slice * binary_slice_size;
+    const auto encoded = utils::base64::encode(
+      gsl::span{ binary.data() + offset, std::min(binary_slice_size, binary.size() - offset) });
+    std::copy(encoded.begin(), encoded.end(), text.data() + base64_size(offset));
+    return {};
+  });
+  if (err) {
+    return { std::move(err), {} };
+  }
+  return { error{}, std::move(text) };
+}
+
+auto
+decode_base64(std::string_view text, crypto_executor* executor)
+  -> std::pair<error, std::vector<std::byte>>
+{
+  if (text.empty() || text.size() % 4 != 0) {
+    return { error{ errc::field_level_encryption::invalid_ciphertext,
+                    "ciphertext is not base64 without line breaks" },
+             {} };
+  }
+  const auto padding = text.size() - text.find_last_not_of('=') - 1;
+  if (padding > 2) {
+    return { error{ errc::field_level_encryption::invalid_ciphertext,
+                    "ciphertext is not base64 without line breaks" },
+             {} };
+  }
+  std::vector<std::byte> binary(text.size() / 4 * 3 - padding);
+  const auto slices = (text.size() + text_slice_size - 1) / text_slice_size;
+  auto err = for_each_index(executor, slices, [text, &binary](std::size_t slice) -> error {
+    const auto offset = slice * text_slice_size;
+    std::vector<std::byte> decoded{};
+    try {
+      decoded = utils::base64::decode(text.substr(offset, text_slice_size));
+    } catch (const std::invalid_argument& e) {
+      return { errc::field_level_encryption::invalid_ciphertext, e.what() };
+    }
+    const auto binary_offset = offset / 4 * 3;
+    if (decoded.size() != std::min(binary_slice_size, binary.size() - binary_offset)) {
+      return { errc::field_level_encryption::invalid_ciphertext,
+               "ciphertext is not base64 without line breaks" };
+    }
+    std::copy(decoded.begin(), decoded.end(), binary.data() + binary_offset);
+    return {};
+  });
+  if (err) {
+    return { std::move(err), {} };
+  }
+  return { error{}, std::move(binary) };
+}
+} // namespace
+
+auto
+encrypt(const aes_cbc_hmac::prepared_key& key,
+        std::size_t chunk_size,
+        const std::vector<std::byte>& plaintext,
+        crypto_executor* executor) -> std::pair<error, std::string>
+{
+  if (chunk_size == 0 || chunk_size > max_chunk_size) {
+    return { error{ errc::field_level_encryption::encryption_failure,
+                    "chunk size must be between 1 byte and 1 GiB" },
+             {} };
+  }
+
+  const auto segments = segment_count(plaintext.size(), chunk_size);
+  const auto segment_size = aes_cbc_hmac::ciphertext_size(chunk_size);
+  std::vector<std::byte> ivs(segments * aes_cbc_hmac::iv_size);
+  if (RAND_bytes(reinterpret_cast<unsigned char*>(ivs.data()), static_cast<int>(ivs.size())) !=
+      1) {
+    return { error{ errc::field_level_encryption::encryption_failure,
+                    "unable to generate initialization vectors" },
+             {} };
+  }
+
+  std::vector<std::byte> ciphertext(ciphertext_size(plaintext.size(), chunk_size));
+  const gsl::span<const std::byte> first_iv{ ivs.data(), aes_cbc_hmac::iv_size };
+  auto err = for_each_index(executor, segments, [&](std::size_t index) -> error {
+    const auto offset = index * chunk_size;
+    const auto size = std::min(chunk_size, plaintext.size() - offset);
+    const auto data = associated_data(first_iv, index, index + 1 == segments);
+    return key.encrypt_into(
+      gsl::span{ ivs.data() + (index * aes_cbc_hmac::iv_size), aes_cbc_hmac::iv_size },
+      gsl::span{ plaintext.data() + offset, size },
+      data,
+      gsl::span{ ciphertext.data() + (index * segment_size), aes_cbc_hmac::ciphertext_size(size) });
+  });
+  if (err) {
+    return { std::move(err), {} };
+  }
+  return encode_base64(ciphertext, executor);
+}
+
+auto
+decrypt(const aes_cbc_hmac::prepared_key& key,
+        std::size_t chunk_size,
+        std::string_view ciphertext,
+        crypto_executor* executor) -> std::pair<error, std::vector<std::byte>>
+{
+  if (chunk_size == 0 || chunk_size > max_chunk_size) {
+    return { error{ errc::field_level_encryption::invalid_ciphertext,
+                    "chunk size must be between 1 byte and 1 GiB" },
+             {} };
+  }
+  auto [decode_err, binary] = decode_base64(ciphertext, executor);
+  if (decode_err) {
+    return { std::move(decode_err), {} };
+  }
+
+  const auto segment_size = aes_cbc_hmac::ciphertext_size(chunk_size);
+  const auto segments = (binary.size() + segment_size - 1) / segment_size;
+  const auto last_segment_size = binary.size() - ((segments - 1) * segment_size);
+  if (last_segment_size < min_segment_size) {
+    return { error{ errc::field_level_encryption::invalid_ciphertext,
+                    "last segment is shorter than the IV, one block and the authentication tag" },
+             {} };
+  }
+
+  // the last chunk holds at most 49 bytes less than its segment, see aes_cbc_hmac::decrypt_into()
+  const auto last_chunk_capacity = last_segment_size - min_segment_size + 15;
+  std::vector<std::byte> plaintext(((segments - 1) * chunk_size) + last_chunk_capacity);
+  std::size_t last_chunk_size{ 0 };
+  const gsl::span<const std::byte> first_iv{ binary.data(), aes_cbc_hmac::iv_size };
+  auto err = for_each_index(executor, segments, [&](std::size_t index) -> error {
+    const auto last = index + 1 == segments;
+    const auto data = associated_data(first_iv, index, last);
+    const auto segment = gsl::span{ binary.data() + (index * segment_size),
+                                    last ? last_segment_size : segment_size };
+    const auto chunk = gsl::span{ plaintext.data() + (index * chunk_size),
+                                  last ? last_chunk_capacity : chunk_size };
+    auto [segment_err, size] = key.decrypt_into(segment, data, chunk);
+    if (segment_err) {
+      return segment_err;
+    }
+    if (last) {
+      last_chunk_size = size;
+    } else if (size != chunk_size) {
+      return { errc::field_level_encryption::decryption_failure,
+               "segment does not hold a whole chunk" };
+    }
+    return {};
+  });
+  if (err) {
+    OPENSSL_cleanse(plaintext.data(), plaintext.size());
+    return { std::move(err), {} };
+  }
+  plaintext.resize(((segments - 1) * chunk_size) + last_chunk_size);
+  return { error{}, std::move(plaintext) };
+}
+} // namespace couchbase::crypto::impl::chunked_cbc_hmac
@@ -0,0 +1,85 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#pragma once
+
+#include "aes_cbc_hmac.hxx"
+
+#include <couchbase/error.hxx>
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace couchbase::crypto
+{
+class crypto_executor;
+} // namespace couchbase::crypto
+
+/**
+ * AEAD_AES_256_CBC_HMAC_SHA512 applied to consecutive chunks of a plaintext, so that large values
+ * can be encrypted and decrypted on several threads at once.
+ *
+ * Every chunk but the last holds `chunk_size` bytes of plaintext, and the last holds the rest,
+ * which is empty only if the whole plaintext is. Each chunk is encrypted into a segment with its
+ * own random IV, and authenticated with the IV of the first segment, its index, as a 64-bit
+ * big-endian integer, and whether it is the last chunk, as associated data. Segments therefore
+ * cannot be reordered, dropped, or moved from one value to another.
+ *
+ * The output is the concatenation of the segments, each laid out as described in aes_cbc_hmac.hxx,
+ * encoded as base64 without line breaks.
+ */
+namespace couchbase::crypto::impl::chunked_cbc_hmac
+{
+/// Chunks larger than this are rejected, which keeps segment sizes far from overflowing
+constexpr std::size_t max_chunk_size{ std::size_t{ 1 } << 30 };
+
+/**
+ * Returns the number of segments for a plaintext of the given size.
+ */
+constexpr auto
+segment_count(std::size_t plaintext_size, std::size_t chunk_size) -> std::size_t
+{
+  return plaintext_size == 0 ? 1 : (plaintext_size + chunk_size - 1) / chunk_size;
+}
+
+/**
+ * Returns the size of the output, before base64 encoding, for a plaintext of the given size.
+ */
+constexpr auto
+ciphertext_size(std::size_t plaintext_size, std::size_t chunk_size) -> std::size_t
+{
+  const auto full_segments = segment_count(plaintext_size, chunk_size) - 1;
+  return full_segments * aes_cbc_hmac::ciphertext_size(chunk_size) +
+         aes_cbc_hmac::ciphertext_size(plaintext_size - full_segments * chunk_size);
+}
+
+/**
+ * Encrypts the plaintext, on the calling thread and, if an executor is given, on its worker threads
+ * as well.
+ *
+ * @return the base64 encoded segments
+ */
+auto
+encrypt(const aes_cbc_hmac::prepared_key& key,
+        std::size_t chunk_size,
+        const std::vector<std::byte>& plaintext,
+        crypto_executor* executor) -> std::pair<error, std::string>;
+
+/**
+ * Decrypts the base64 encoded segments, on the calling thread and, if an executor is given, on its
+ * worker threads as well.
+ */
+auto
+decrypt(const aes_cbc_hmac::prepared_key& key,
+        std::size_t chunk_size,
+        std::string_view ciphertext,
+        crypto_executor* executor) -> std::pair<error, std::vector<std::byte>>;
+} // namespace couchbase::crypto::impl::chunked_cbc_hmac
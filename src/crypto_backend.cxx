@@ -0,0 +1,259 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include <couchbase_encryption/crypto_backend.hxx>
+
+#include "crypto/aes_cbc_hmac.hxx"
+
+#include <spdlog/details/os.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace couchbase::crypto
+{
+namespace
+{
+constexpr std::array<std::pair<crypto_backend, std::string_view>, 2> backend_names{ {
+  { crypto_backend::openssl, "openssl" },
+  { crypto_backend::couchbase_sdk, "couchbase_sdk" },
+} };
+
+/// The value of the environment variable that selects the fastest backend
+constexpr std::string_view fastest_backend_name{ "auto" };
+
+/// The size of the values encrypted by the benchmark, typical of a large field
+constexpr std::size_t benchmark_value_size{ 16 * 1024 };
+
+/// The time each backend is measured for in each round when selecting the fastest one
+constexpr std::chrono::milliseconds selection_duration{ 1 };
+
+/// The number of rounds run when selecting the fastest backend
+constexpr std::size_t selection_rounds{ 5 };
+
+struct selection {
+  std::mutex mutex{};
+  std::once_flag selected_once{};
+  std::atomic<bool> selected{ false };
+  std::atomic<crypto_backend> backend{ crypto_backend::openssl };
+
+  void select(crypto_backend selected_backend)
+  {
+    const std::scoped_lock lock(mutex);
+    backend = selected_backend;
+    selected = true;
+  }
+};
+
+auto
+global_selection() -> selection&
+{
+  static selection instance{};
+  return instance;
+}
+
+/**
+ * Returns the fastest backend on the current CPU, or the default one if none could be measured.
+ */
+auto
+fastest_backend() -> crypto_backend
+{
+  const auto measurements = benchmark_crypto_backends(selection_duration, selection_rounds);
+  const auto fastest = std::max_element(
+    measurements.begin(), measurements.end(), [](const auto& a, const auto& b) {
+      return a.bytes_per_second < b.bytes_per_second;
+    });
+  if (fastest == measurements.end() || fastest->bytes_per_second == 0) {
+    return crypto_backend::openssl;
+  }
+  return fastest->backend;
+}
+
+/**
+ * Returns the backend named by the environment, the fastest one if the environment asks for it, or
+ * the default one.
+ */
+auto
+initial_backend() -> crypto_backend
+{
+  const auto name = spdlog::details::os::getenv("COUCHBASE_CXX_ENCRYPTION_CRYPTO_BACKEND");
+  if (name.empty()) {
+    return crypto_backend::openssl;
+  }
+  if (const auto backend = crypto_backend_from_name(name); backend.has_value()) {
+    return backend.value();
+  }
+  if (name == fastest_backend_name) {
+    return fastest_backend();
+  }
+  std::string accepted{};
+  for (const auto& [backend, accepted_name] : backend_names) {
+    accepted += accepted_name;
+    accepted += ", ";
+  }
+  accepted += fastest_backend_name;
+  spdlog::warn("ignoring COUCHBASE_CXX_ENCRYPTION_CRYPTO_BACKEND=\"{}\", which is not one of {}; "
+               "using {}",
+               name,
+               accepted,
+               crypto_backend_name(crypto_backend::openssl));
+  return crypto_backend::openssl;
+}
+
+/**
+ * Encrypts and decrypts with the given key until the duration has elapsed, and returns the number
+ * of bytes of plaintext processed per second, or 0 on failure.
+ */
+auto
+measure(const impl::aes_cbc_hmac::prepared_key& key,
+        const std::vector<std::byte>& plaintext,
+        std::chrono::microseconds duration) -> double
+{
+  using clock = std::chrono::steady_clock;
+  const std::vector<std::byte> iv(impl::aes_cbc_hmac::iv_size, std::byte{ 1 });
+  std::vector<std::byte> ciphertext(impl::aes_cbc_hmac::ciphertext_size(plaintext.size()));
+  std::vector<std::byte> decrypted(plaintext.size());
+  std::size_t processed{ 0 };
+  const auto start = clock::now();
+  auto elapsed = clock::duration::zero();
+  do {
+    if (key.encrypt_into(iv, plaintext, {}, ciphertext)) {
+      return 0;
+    }
+    if (const auto [err, size] = key.decrypt_into(ciphertext, {}, decrypted);
+        err || size != plaintext.size()) {
+      return 0;
+    }
+    processed += plaintext.size();
+    elapsed = clock::now() - start;
+  } while (elapsed < duration);
+  return static_cast<double>(processed) / std::chrono::duration<double>(elapsed).count();
+}
+} // namespace
+
+auto
+crypto_backend_name(crypto_backend backend) -> std::string_view
+{
+  for (const auto& [candidate, name] : backend_names) {
+    if (candidate == backend) {
+      return name;
+    }
+  }
+  return {};
+}
+
+auto
+crypto_backend_from_name(std::string_view name) -> std::optional<crypto_backend>
+{
+  for (const auto& [backend, candidate] : backend_names) {
+    if (candidate == name) {
+      return backend;
+    }
+  }
+  return std::nullopt;
+}
+
+auto
+benchmark_crypto_backends(std::chrono::microseconds duration, std::size_t rounds)
+  -> std::vector<crypto_backend_measurement>
+{
+  std::vector<std::byte> key_bytes(impl::aes_cbc_hmac::key_size);
+  for (std::size_t i = 0; i < key_bytes.size(); ++i) {
+    key_bytes[i] = static_cast<std::byte>(i);
+  }
+  std::vector<std::byte> plaintext(benchmark_value_size);
+  for (std::size_t i = 0; i < plaintext.size(); ++i) {
+    plaintext[i] = static_cast<std::byte>(i * 7);
+  }
+
+  std::vector<std::shared_ptr<const impl::aes_cbc_hmac::prepared_key>> keys{};
+  std::vector<crypto_backend_measurement> measurements{};
+  for (const auto& [backend, name] : backend_names) {
+    auto [err, key] = impl::aes_cbc_hmac::prepared_key::prepare(key_bytes, backend);
+    keys.push_back(err ? nullptr : std::move(key));
+    measurements.push_back({ backend, 0 });
+  }
+
+  // a backend is only eligible if every other backend can decrypt its ciphertexts
+  const std::vector<std::byte> iv(impl::aes_cbc_hmac::iv_size, std::byte{ 2 });
+  std::vector<bool> compatible(keys.size(), false);
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    if (keys[i] == nullptr) {
+      continue;
+    }
+    auto [enc_err, ciphertext] = keys[i]->encrypt(iv, plaintext, {});
+    compatible[i] = !enc_err && std::all_of(keys.begin(), keys.end(), [&](const auto& other) {
+      if (other == nullptr) {
+        return true;
+      }
+      const auto [dec_err, decrypted] = other->decrypt(ciphertext, {});
+      return !dec_err && decrypted == plaintext;
+    });
+  }
+
+  // the rounds start with a different backend each, so that none is always measured first
+  rounds = std::max<std::size_t>(rounds, 1);
+  std::vector<std::vector<double>> throughputs(keys.size());
+  for (std::size_t round = 0; round < rounds; ++round) {
+    for (std::size_t n = 0; n < keys.size(); ++n) {
+      const auto i = (round + n) % keys.size();
+      if (compatible[i]) {
+        throughputs[i].push_back(measure(*keys[i], plaintext, duration));
+      }
+    }
+  }
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    auto& samples = throughputs[i];
+    if (samples.empty() || std::find(samples.begin(), samples.end(), 0.0) != samples.end()) {
+      continue;
+    }
+    const auto median = samples.begin() + static_cast<std::ptrdiff_t>(samples.size() / 2);
+    std::nth_element(samples.begin(), median, samples.end());
+    measurements[i].bytes_per_second = *median;
+  }
+  return measurements;
+}
+
+void
+pin_crypto_backend(crypto_backend backend)
+{
+  global_selection().select(backend);
+}
+
+auto
+select_crypto_backend() -> crypto_backend
+{
+  const auto backend = fastest_backend();
+  global_selection().select(backend);
+  return backend;
+}
+
+auto
+active_crypto_backend() -> crypto_backend
+{
+  auto& state = global_selection();
+  if (!state.selected) {
+    std::call_once(state.selected_once, [&state] {
+      // the benchmark, if any, runs without the lock, a backend pinned meanwhile takes precedence
+      const auto backend = initial_backend();
+      const std::scoped_lock lock(state.mutex);
+      if (!state.selected) {
+        state.backend = backend;
+        state.selected = true;
+      }
+    });
+  }
+  return state.backend;
+}
+} // namespace couchbase::crypto
@@ -0,0 +1,129 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include <couchbase_encryption/crypto_executor.hxx>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace couchbase::crypto
+{
+namespace
+{
+/// After this number of interactive tasks in a row, a waiting bulk task goes next
+constexpr std::size_t max_interactive_burst{ 8 };
+} // namespace
+
+struct crypto_executor::state {
+  std::mutex mutex{};
+  std::condition_variable ready{};
+  std::deque<std::function<void()>> interactive{};
+  std::deque<std::function<void()>> bulk{};
+  std::size_t interactive_burst{ 0 };
+  bool stopping{ false };
+  std::vector<std::thread> workers{};
+
+  /**
+   * Returns the next task to run, or std::nullopt once the executor is stopping and every task has
+   * run.
+   */
+  auto next_task() -> std::optional<std::function<void()>>
+  {
+    std::unique_lock lock(mutex);
+    ready.wait(lock, [this] {
+      return !interactive.empty() || !bulk.empty() || stopping;
+    });
+    const auto bulk_turn = !bulk.empty() && interactive_burst >= max_interactive_burst;
+    auto& queue = !interactive.empty() && !bulk_turn ? interactive : bulk;
+    if (queue.empty()) {
+      return std::nullopt;
+    }
+    interactive_burst = &queue == &interactive ? interactive_burst + 1 : 0;
+    auto task = std::move(queue.front());
+    queue.pop_front();
+    return task;
+  }
+
+  void run()
+  {
+    while (auto task = next_task()) {
+      // the worker thread must outlive the task that failed
+      try {
+        task.value()();
+      } catch (const std::exception& e) {
+        spdlog::error("crypto_executor task failed: {}", e.what());
+      } catch (...) {
+        spdlog::error("crypto_executor task failed with an unknown exception");
+      }
+    }
+  }
+};
+
+crypto_executor::crypto_executor(crypto_executor_options options)
+  : options_{ options }
+  , state_{ std::make_unique<state>() }
+{
+  const auto threads = std::max<std::size_t>(options_.threads, 1);
+  state_->workers.reserve(threads);
+  for (std::size_t i = 0; i < threads; ++i) {
+    state_->workers.emplace_back([s = state_.get()] {
+      s->run();
+    });
+  }
+}
+
+crypto_executor::~crypto_executor()
+{
+  {
+    const std::scoped_lock lock(state_->mutex);
+    state_->stopping = true;
+  }
+  state_->ready.notify_all();
+  for (auto& worker : state_->workers) {
+    worker.join();
+  }
+}
+
+void
+crypto_executor::post(std::function<void()> task, crypto_priority priority)
+{
+  if (!task) {
+    throw std::invalid_argument("crypto_executor cannot run an empty task");
+  }
+  {
+    const std::scoped_lock lock(state_->mutex);
+    (priority == crypto_priority::interactive ? state_->interactive : state_->bulk)
+      .push_back(std::move(task));
+  }
+  state_->ready.notify_one();
+}
+
+auto
+crypto_executor::should_offload(std::size_t document_size, std::size_t encrypted_fields) const
+  -> bool
+{
+  return document_size >= options_.min_document_size ||
+         encrypted_fields >= options_.min_encrypted_fields;
+}
+
+auto
+crypto_executor::threads() const -> std::size_t
+{
+  return state_->workers.size();
+}
+} // namespace couchbase::crypto
@@ -0,0 +1,130 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include <couchbase_encryption/decode_handle.hxx>
+
+#include "decode_state.hxx"
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+
+#include <optional>
+#include <stdexcept>
+
+namespace couchbase::crypto
+{
+namespace internal
+{
+decode_state::decode_state()
+{
+  if (RAND_bytes(reinterpret_cast<unsigned char*>(digest_key.data()),
+                 static_cast<int>(digest_key.size())) != 1) {
+    throw std::runtime_error("unable to generate a random key for the decode handle");
+  }
+}
+
+auto
+decode_state::keyed_digest(const std::vector<std::byte>& plaintext) const -> std::optional<digest>
+{
+  digest result{};
+  unsigned int result_size = 0;
+  if (HMAC(EVP_sha256(),
+           digest_key.data(),
+           static_cast<int>(digest_key.size()),
+           reinterpret_cast<const unsigned char*>(plaintext.data()),
+           plaintext.size(),
+           reinterpret_cast<unsigned char*>(result.data()),
+           &result_size) == nullptr ||
+      result_size != result.size()) {
+    return std::nullopt;
+  }
+  return result;
+}
+
+void
+decode_state::remember(std::string pointer,
+                       const std::vector<std::byte>& plaintext,
+                       const impl::utils::flat_json::value& node,
+                       document_format format)
+{
+  auto plaintext_digest = keyed_digest(plaintext);
+  if (!plaintext_digest.has_value()) {
+    // the field is encrypted again rather than compared with an unknown digest
+    fields.erase(pointer);
+    return;
+  }
+  if (fields.empty()) {
+    fields_format = format;
+  }
+  fields.insert_or_assign(std::move(pointer),
+                          field{ plaintext_digest.value(), node.clone(strings) });
+}
+
+auto
+decode_state::reusable_node(const std::string& pointer,
+                            const std::vector<std::byte>& plaintext,
+                            document_format format) const -> const impl::utils::flat_json::value*
+{
+  if (format != fields_format) {
+    return nullptr;
+  }
+  const auto it = fields.find(pointer);
+  if (it == fields.end()) {
+    return nullptr;
+  }
+  const auto current = keyed_digest(plaintext);
+  const auto& remembered = it->second.plaintext_digest;
+  if (!current.has_value() ||
+      CRYPTO_memcmp(current->data(), remembered.data(), remembered.size()) != 0) {
+    return nullptr;
+  }
+  return &it->second.node;
+}
+
+void
+decode_state::clear()
+{
+  fields.clear();
+  strings.clear();
+}
+
+void
+append_pointer_token(std::string& pointer, std::string_view token)
+{
+  pointer += '/';
+  for (const auto c : token) {
+    if (c == '~') {
+      pointer += "~0";
+    } else if (c == '/') {
+      pointer += "~1";
+    } else {
+      pointer += c;
+    }
+  }
+}
+} // namespace internal
+
+decode_handle::decode_handle()
+  : state_{ std::make_shared<internal::decode_state>() }
+{
+}
+
+auto
+decode_handle::size() const -> std::size_t
+{
+  return state_->fields.size();
+}
+
+void
+decode_handle::clear()
+{
+  state_->clear();
+}
+} // namespace couchbase::crypto
@@ -0,0 +1,76 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#pragma once
+
+#include <couchbase_encryption/transcoder.hxx>
+
+#include "utils/flat_json.hxx"
+
+#include <array>
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace couchbase::crypto::internal
+{
+/**
+ * The encrypted fields of a decoded document, by JSON pointer (RFC 6901) to the demangled field.
+ */
+struct decode_state {
+  using digest = std::array<std::byte, 32>;
+
+  struct field {
+    digest plaintext_digest{};
+    impl::utils::flat_json::value node{};
+  };
+
+  decode_state();
+
+  /**
+   * Remembers a copy of the encrypted node of the field at the given pointer, and the digest of its
+   * plaintext. The field is forgotten instead if the digest cannot be computed.
+   */
+  void remember(std::string pointer,
+                const std::vector<std::byte>& plaintext,
+                const impl::utils::flat_json::value& node,
+                document_format format);
+
+  /**
+   * Returns the encrypted node of the field at the given pointer, if the field was decoded from a
+   * document of the same format and its plaintext is unchanged.
+   */
+  [[nodiscard]] auto reusable_node(const std::string& pointer,
+                                   const std::vector<std::byte>& plaintext,
+                                   document_format format) const
+    -> const impl::utils::flat_json::value*;
+
+  void clear();
+
+  /**
+   * Returns the HMAC-SHA256 of the given plaintext, keyed with a random key of this state, or
+   * std::nullopt if it cannot be computed, in which case no node is reused.
+   */
+  [[nodiscard]] auto keyed_digest(const std::vector<std::byte>& plaintext) const
+    -> std::optional<digest>;
+
+  std::array<std::byte, 32> digest_key{};
+  std::map<std::string, field> fields{};
+  impl::utils::flat_json::arena strings{};
+  document_format fields_format{ document_format::json };
+};
+
+/**
+ * Appends a reference token for the given object member name to a JSON pointer.
+ */
+void
+append_pointer_token(std::string& pointer, std::string_view token);
+} // namespace couchbase::crypto::internal
@@ -7,6 +7,7 @@
  */
 
 #include <couchbase/error_codes.hxx>
+#include <couchbase_encryption/blind_indexer.hxx>
 #include <couchbase_encryption/default_manager.hxx>
 
 #include <spdlog/fmt/bundled/format.h>
@@ -39,38 +40,121 @@ default_manager::register_default_encrypter(std::shared_ptr<encrypter> encrypter
   return register_encrypter(default_encrypter_alias, std::move(encrypter));
 }
 
+auto
+default_manager::register_blind_indexer(std::string alias, std::shared_ptr<blind_indexer> indexer)
+  -> error
+{
+  alias_to_blind_indexer_[std::move(alias)] = std::move(indexer);
+  return {};
+}
+
+auto
+default_manager::register_default_blind_indexer(std::shared_ptr<blind_indexer> indexer) -> error
+{
+  return register_blind_indexer(default_encrypter_alias, std::move(indexer));
+}
+
 auto
 default_manager::encrypt(std::vector<std::byte> plaintext,
                          const std::optional<std::string>& encrypter_alias)
   -> std::pair<error, std::map<std::string, std::string>>
 {
-  const auto alias = encrypter_alias.value_or(default_encrypter_alias);
-  if (alias_to_encrypter_.find(alias) == alias_to_encrypter_.end()) {
+  const auto& alias =
+    encrypter_alias.has_value() ? encrypter_alias.value() : default_encrypter_alias;
+  const auto it = alias_to_encrypter_.find(alias);
+  if (it == alias_to_encrypter_.end()) {
     return { error{ errc::field_level_encryption::encrypter_not_found,
                     fmt::format("Could not find encrypter with alias `{}`.", alias) },
              {} };
   }
 
-  auto [err, res] = alias_to_encrypter_.at(alias)->encrypt(std::move(plaintext));
+  auto [err, res] = it->second->encrypt(std::move(plaintext));
   if (err) {
     return { err, {} };
   }
-  return { {}, res.as_map() };
+  return { error{}, std::move(res).take_map() };
 }
 
 auto
 default_manager::decrypt(std::map<std::string, std::string> encrypted_node)
   -> std::pair<error, std::vector<std::byte>>
 {
-  auto enc_result = encryption_result{ std::move(encrypted_node) };
-  if (algorithm_to_decrypter_.find(enc_result.algorithm()) == algorithm_to_decrypter_.end()) {
+  const auto algorithm = encrypted_node.find("alg");
+  if (algorithm == encrypted_node.end()) {
+    return { error{ errc::field_level_encryption::decryption_failure,
+                    "Encrypted field does not name its algorithm" },
+             {} };
+  }
+  const auto it = algorithm_to_decrypter_.find(algorithm->second);
+  if (it == algorithm_to_decrypter_.end()) {
     return { error{ errc::field_level_encryption::decrypter_not_found,
                     fmt::format("Could not find decrypter for algorithm `{}`.",
-                                enc_result.algorithm()) },
+                                algorithm->second) },
              {} };
   }
-  const auto decrypter = algorithm_to_decrypter_.at(enc_result.algorithm());
-  return decrypter->decrypt(std::move(enc_result));
+  return it->second->decrypt(encryption_result{ std::move(encrypted_node) });
+}
+
+auto
+default_manager::blind_index(const std::vector<std::byte>& plaintext,
+                             const std::optional<std::string>& indexer_alias)
+  -> std::pair<error, std::vector<std::byte>>
+{
+  const auto& alias = indexer_alias.has_value() ? indexer_alias.value() : default_encrypter_alias;
+  const auto it = alias_to_blind_indexer_.find(alias);
+  if (it == alias_to_blind_indexer_.end()) {
+    return { error{ blind_index_errc::blind_indexer_not_found,
+                    fmt::format("Could not find blind indexer with alias `{}`.", alias) },
+             {} };
+  }
+  return it->second->index(plaintext);
+}
+
+auto
+default_manager::placeholder(std::size_t plaintext_size,
+                             const std::optional<std::string>& encrypter_alias)
+  -> std::pair<error, std::map<std::string, std::string>>
+{
+  const auto& alias =
+    encrypter_alias.has_value() ? encrypter_alias.value() : default_encrypter_alias;
+  const auto it = alias_to_encrypter_.find(alias);
+  if (it == alias_to_encrypter_.end()) {
+    return { error{ errc::field_level_encryption::encrypter_not_found,
+                    fmt::format("Could not find encrypter with alias `{}`.", alias) },
+             {} };
+  }
+
+  auto res = it->second->placeholder(plaintext_size);
+  if (!res.has_value()) {
+    return { error{ errc::field_level_encryption::generic_cryptography_failure,
+                    fmt::format("Encrypter with alias `{}` cannot tell the size of its ciphertext "
+                                "in advance.",
+                                alias) },
+             {} };
+  }
+  return { error{}, std::move(res.value()).take_map() };
+}
+
+auto
+default_manager::blind_index_size(const std::optional<std::string>& indexer_alias)
+  -> std::pair<error, std::size_t>
+{
+  const auto& alias = indexer_alias.has_value() ? indexer_alias.value() : default_encrypter_alias;
+  const auto it = alias_to_blind_indexer_.find(alias);
+  if (it == alias_to_blind_indexer_.end()) {
+    return { error{ blind_index_errc::blind_indexer_not_found,
+                    fmt::format("Could not find blind indexer with alias `{}`.", alias) },
+             {} };
+  }
+  const auto size = it->second->index_size();
+  if (!size.has_value()) {
+    return { error{ errc::field_level_encryption::generic_cryptography_failure,
+                    fmt::format("Blind indexer with alias `{}` cannot tell the size of its hashes "
+                                "in advance.",
+                                alias) },
+             {} };
+  }
+  return { error{}, size.value() };
 }
 
 auto
@@ -94,4 +178,16 @@ default_manager::is_mangled(const std::string& field_name) -> bool
   return field_name.compare(0, encrypted_field_name_prefix_.size(), encrypted_field_name_prefix_) ==
          0;
 }
+
+void
+default_manager::prefetch_keys(
+  const std::map<std::string, std::vector<std::string>>& key_ids_by_algorithm)
+{
+  for (const auto& [algorithm, key_ids] : key_ids_by_algorithm) {
+    if (const auto it = algorithm_to_decrypter_.find(algorithm);
+        it != algorithm_to_decrypter_.end()) {
+      it->second->prefetch_keys(key_ids);
+    }
+  }
+}
 } // namespace couchbase::crypto
@@ -0,0 +1,289 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include "encrypted_node.hxx"
+
+#include <couchbase/error_codes.hxx>
+#include <couchbase_encryption/blind_indexer.hxx>
+
+#include "utils/base64.h"
+
+#include <algorithm>
+#include <array>
+#include <optional>
+
+namespace couchbase::crypto::internal
+{
+auto
+encrypt_plaintext(std::vector<std::byte> plaintext,
+                  const encrypted_field& field,
+                  const std::shared_ptr<manager>& crypto_manager)
+  -> std::pair<error, std::map<std::string, std::string>>
+{
+  std::optional<std::string> index_token{};
+  if (field.blind_index.has_value()) {
+    auto [err, token] = blind_index_token(crypto_manager, plaintext, field.blind_index.value());
+    if (err) {
+      return { err, {} };
+    }
+    index_token = std::move(token);
+  }
+
+  auto [err, encrypted] = crypto_manager->encrypt(std::move(plaintext), field.encrypter_alias);
+  if (err) {
+    return { err, {} };
+  }
+  if (index_token.has_value()) {
+    encrypted.insert_or_assign(std::string{ blind_index_key }, std::move(index_token.value()));
+  }
+  return { error{}, std::move(encrypted) };
+}
+
+auto
+placeholder_members(std::size_t plaintext_size,
+                    const encrypted_field& field,
+                    const std::shared_ptr<manager>& crypto_manager)
+  -> std::pair<error, std::map<std::string, std::string>>
+{
+  std::optional<std::string> index_token{};
+  if (field.blind_index.has_value()) {
+    const auto& options = field.blind_index.value();
+    auto [err, size] = crypto_manager->blind_index_size(options.indexer_alias);
+    if (err) {
+      return { err, {} };
+    }
+    if (options.length > 0 && options.length < size) {
+      size = options.length;
+    }
+    index_token = impl::utils::base64::encode(std::vector<std::byte>(size));
+  }
+
+  auto [err, placeholder] = crypto_manager->placeholder(plaintext_size, field.encrypter_alias);
+  if (err) {
+    return { err, {} };
+  }
+  if (index_token.has_value()) {
+    placeholder.insert_or_assign(std::string{ blind_index_key }, std::move(index_token.value()));
+  }
+  return { error{}, std::move(placeholder) };
+}
+
+namespace
+{
+/// The algorithms that have a short ID in compact envelopes, which must never change
+constexpr std::array<std::pair<std::string_view, std::string_view>, 2> compact_algorithm_ids{ {
+  { "1", "AEAD_AES_256_CBC_HMAC_SHA512" },
+  { "2", "AEAD_AES_SIV_CMAC_512" },
+} };
+
+constexpr char compact_separator{ ':' };
+} // namespace
+
+auto
+compact_envelope(const std::map<std::string, std::string>& members) -> std::optional<std::string>
+{
+  const auto algorithm = members.find(std::string{ algorithm_key });
+  const auto key_id = members.find(std::string{ key_id_key });
+  const auto ciphertext = members.find(std::string{ ciphertext_key });
+  if (members.size() != 3 || algorithm == members.end() || key_id == members.end() ||
+      ciphertext == members.end()) {
+    return std::nullopt;
+  }
+  const auto id = std::find_if(
+    compact_algorithm_ids.begin(), compact_algorithm_ids.end(), [&algorithm](const auto& entry) {
+      return entry.second == algorithm->second;
+    });
+  if (id == compact_algorithm_ids.end()) {
+    return std::nullopt;
+  }
+
+  std::string envelope{};
+  envelope.reserve(id->first.size() + key_id->second.size() + ciphertext->second.size() + 2);
+  envelope.append(id->first);
+  envelope.push_back(compact_separator);
+  envelope.append(key_id->second);
+  envelope.push_back(compact_separator);
+  envelope.append(ciphertext->second);
+  return envelope;
+}
+
+auto
+parse_array_index(std::string_view segment) -> std::optional<std::size_t>
+{
+  // at most 9 digits, which cannot overflow
+  if (segment.size() < 3 || segment.size() > 11 || segment.front() != '[' ||
+      segment.back() != ']') {
+    return std::nullopt;
+  }
+  std::size_t index = 0;
+  for (const auto c : segment.substr(1, segment.size() - 2)) {
+    if (c < '0' || c > '9') {
+      return std::nullopt;
+    }
+    index = index * 10 + static_cast<std::size_t>(c - '0');
+  }
+  return index;
+}
+
+auto
+parse_compact_envelope(std::string_view envelope)
+  -> std::optional<std::map<std::string, std::string>>
+{
+  // the key ID may contain the separator, but neither the algorithm ID nor the base64 ciphertext
+  const auto first = envelope.find(compact_separator);
+  const auto last = envelope.rfind(compact_separator);
+  if (first == std::string_view::npos || first == last) {
+    return std::nullopt;
+  }
+  const auto id = envelope.substr(0, first);
+  const auto algorithm = std::find_if(
+    compact_algorithm_ids.begin(), compact_algorithm_ids.end(), [id](const auto& entry) {
+      return entry.first == id;
+    });
+  if (algorithm == compact_algorithm_ids.end()) {
+    return std::nullopt;
+  }
+  return std::map<std::string, std::string>{
+    { std::string{ algorithm_key }, std::string{ algorithm->second } },
+    { std::string{ key_id_key }, std::string{ envelope.substr(first + 1, last - first - 1) } },
+    { std::string{ ciphertext_key }, std::string{ envelope.substr(last + 1) } },
+  };
+}
+
+auto
+encrypted_node_key(const impl::utils::flat_json::value& node)
+  -> std::optional<std::pair<std::string, std::string>>
+{
+  if (node.is_string()) {
+    auto members = parse_compact_envelope(node.get_string());
+    if (!members.has_value()) {
+      return std::nullopt;
+    }
+    return std::make_pair(std::move(members.value()[std::string{ algorithm_key }]),
+                          std::move(members.value()[std::string{ key_id_key }]));
+  }
+  const auto* algorithm = node.find(algorithm_key);
+  const auto* key_id = node.find(key_id_key);
+  if (algorithm == nullptr || !algorithm->is_string() || key_id == nullptr ||
+      !key_id->is_string()) {
+    return std::nullopt;
+  }
+  return std::make_pair(algorithm->get_string(), key_id->get_string());
+}
+
+auto
+node_matches_field(const impl::utils::flat_json::value& node,
+                   const std::vector<std::byte>& plaintext,
+                   const encrypted_field& field,
+                   const std::shared_ptr<manager>& crypto_manager) -> bool
+{
+  const auto key = encrypted_node_key(node);
+  if (!key.has_value()) {
+    return false;
+  }
+  // the placeholder names the algorithm and the key the encrypter would use, without encrypting
+  auto [err, expected] = crypto_manager->placeholder(plaintext.size(), field.encrypter_alias);
+  if (err || expected[std::string{ algorithm_key }] != key->first ||
+      expected[std::string{ key_id_key }] != key->second) {
+    return false;
+  }
+
+  const auto* index_token = node.is_object() ? node.find(blind_index_key) : nullptr;
+  if (!field.blind_index.has_value()) {
+    return index_token == nullptr;
+  }
+  if (index_token == nullptr || !index_token->is_string()) {
+    return false;
+  }
+  auto [token_err, token] = blind_index_token(crypto_manager, plaintext, field.blind_index.value());
+  return !token_err && token == index_token->get_string();
+}
+
+auto
+make_encrypted_node(const std::map<std::string, std::string>& members,
+                    document_format format,
+                    envelope_format envelope,
+                    impl::utils::flat_json::arena& strings) -> impl::utils::flat_json::value
+{
+  if (envelope == envelope_format::compact) {
+    if (auto compact = compact_envelope(members); compact.has_value()) {
+      return impl::utils::flat_json::value::make_string(compact.value(), strings);
+    }
+  }
+
+  auto node = impl::utils::flat_json::value::make_object();
+  node.children().reserve(members.size());
+  for (const auto& [k, v] : members) {
+    auto& member = node.children().emplace_back(
+      format != document_format::json && k == ciphertext_key
+        ? impl::utils::flat_json::value::make_binary(
+            strings.store(impl::utils::base64::decode(v)))
+        : impl::utils::flat_json::value::make_string(v, strings));
+    member.set_key(k, strings);
+  }
+  return node;
+}
+
+auto
+encrypt_node(const impl::utils::flat_json::value& value,
+             const encrypted_field& field,
+             const std::shared_ptr<manager>& crypto_manager,
+             document_format format,
+             impl::utils::flat_json::arena& strings)
+  -> std::pair<error, impl::utils::flat_json::value>
+{
+  auto [err, members] =
+    encrypt_plaintext(impl::utils::flat_json::generate(value), field, crypto_manager);
+  if (err) {
+    return { err, {} };
+  }
+  return { error{}, make_encrypted_node(members, format, field.envelope, strings) };
+}
+
+auto
+decrypt_node_plaintext(const impl::utils::flat_json::value& node,
+                       const std::shared_ptr<manager>& crypto_manager)
+  -> std::pair<error, std::vector<std::byte>>
+{
+  if (node.is_string()) {
+    auto members = parse_compact_envelope(node.get_string());
+    if (!members.has_value()) {
+      return { error{ errc::field_level_encryption::invalid_ciphertext,
+                      "Expected a compact envelope for encrypted field" },
+               {} };
+    }
+    return crypto_manager->decrypt(std::move(members.value()));
+  }
+  if (!node.is_object()) {
+    return { error{ errc::field_level_encryption::invalid_ciphertext,
+                    "Expected an object or a compact envelope for encrypted field" },
+             {} };
+  }
+
+  std::map<std::string, std::string> encrypted_node;
+  for (const auto& member : node.children()) {
+    auto key = member.get_key();
+    if (key == blind_index_key) {
+      // only used by the server for matching, not needed for decryption
+      continue;
+    }
+    if (member.is_binary()) {
+      encrypted_node.insert_or_assign(std::move(key),
+                                      impl::utils::base64::encode(member.text()));
+    } else if (member.is_string()) {
+      encrypted_node.insert_or_assign(std::move(key), member.get_string());
+    } else {
+      return { error{ errc::field_level_encryption::invalid_ciphertext,
+                      "Expected only strings in encrypted field" },
+               {} };
+    }
+  }
+
+  return crypto_manager->decrypt(std::move(encrypted_node));
+}
+} // namespace couchbase::crypto::internal
@@ -0,0 +1,135 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#pragma once
+
+#include <couchbase/error.hxx>
+#include <couchbase_encryption/encrypted_fields.hxx>
+#include <couchbase_encryption/manager.hxx>
+#include <couchbase_encryption/transcoder.hxx>
+
+#include "utils/flat_json.hxx"
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace couchbase::crypto::internal
+{
+/// The member of the encrypted node that holds the blind index token, if any
+constexpr std::string_view blind_index_key{ "bix" };
+
+/// The member of the encrypted node that is stored as binary data in binary document formats
+constexpr std::string_view ciphertext_key{ "ciphertext" };
+
+/// The members of the encrypted node that name the algorithm and the key
+constexpr std::string_view algorithm_key{ "alg" };
+constexpr std::string_view key_id_key{ "kid" };
+
+/// The segment of an encrypted field path that matches every member or element
+constexpr std::string_view wildcard_segment{ "*" };
+
+/**
+ * Returns the index of the array element that the given segment of an encrypted field path
+ * addresses, e.g. 3 for `[3]`, or std::nullopt if the segment names an object member.
+ */
+auto
+parse_array_index(std::string_view segment) -> std::optional<std::size_t>;
+
+/**
+ * Encrypts the given JSON-encoded value as specified by the encrypted field, and returns the
+ * members of the encrypted node that replaces it in the document.
+ */
+auto
+encrypt_plaintext(std::vector<std::byte> plaintext,
+                  const encrypted_field& field,
+                  const std::shared_ptr<manager>& crypto_manager)
+  -> std::pair<error, std::map<std::string, std::string>>;
+
+/**
+ * Returns the members of an encrypted node of the same size as the one encrypt_plaintext() would
+ * return for a plaintext of the given size, with a ciphertext (and blind index token) of zero
+ * bytes, without retrieving any key or encrypting anything.
+ */
+auto
+placeholder_members(std::size_t plaintext_size,
+                    const encrypted_field& field,
+                    const std::shared_ptr<manager>& crypto_manager)
+  -> std::pair<error, std::map<std::string, std::string>>;
+
+/**
+ * Builds the encrypted node with the given members, in the given envelope if the members allow it.
+ * With binary document formats, the ciphertext of object envelopes is stored as binary data.
+ */
+auto
+make_encrypted_node(const std::map<std::string, std::string>& members,
+                    document_format format,
+                    envelope_format envelope,
+                    impl::utils::flat_json::arena& strings) -> impl::utils::flat_json::value;
+
+/**
+ * Returns the compact envelope for the given members of an encrypted node, or std::nullopt if they
+ * cannot be stored in a compact envelope.
+ */
+auto
+compact_envelope(const std::map<std::string, std::string>& members) -> std::optional<std::string>;
+
+/**
+ * Returns the members of the encrypted node that the given compact envelope stands for, or
+ * std::nullopt if it is malformed.
+ */
+auto
+parse_compact_envelope(std::string_view envelope)
+  -> std::optional<std::map<std::string, std::string>>;
+
+/**
+ * Returns the algorithm and the key ID named by the given encrypted node, whatever its envelope, or
+ * std::nullopt if it does not name them.
+ */
+auto
+encrypted_node_key(const impl::utils::flat_json::value& node)
+  -> std::optional<std::pair<std::string, std::string>>;
+
+/**
+ * Returns whether encrypting the given JSON-encoded plaintext as specified by the encrypted field
+ * would now use the algorithm and the key of the given encrypted node, and produce its blind index
+ * token, if any. Only then can the node be reused instead, as the encrypter alias or the blind
+ * index of the field may have changed, or its key been rotated, since the node was written.
+ */
+auto
+node_matches_field(const impl::utils::flat_json::value& node,
+                   const std::vector<std::byte>& plaintext,
+                   const encrypted_field& field,
+                   const std::shared_ptr<manager>& crypto_manager) -> bool;
+
+/**
+ * Encrypts the given value as specified by the encrypted field, and returns the encrypted node that
+ * replaces it in the document.
+ */
+auto
+encrypt_node(const impl::utils::flat_json::value& value,
+             const encrypted_field& field,
+             const std::shared_ptr<manager>& crypto_manager,
+             document_format format,
+             impl::utils::flat_json::arena& strings)
+  -> std::pair<error, impl::utils::flat_json::value>;
+
+/**
+ * Decrypts the given encrypted node, and returns the JSON-encoded value it replaced in the
+ * document.
+ */
+auto
+decrypt_node_plaintext(const impl::utils::flat_json::value& node,
+                       const std::shared_ptr<manager>& crypto_manager)
+  -> std::pair<error, std::vector<std::byte>>;
+} // namespace couchbase::crypto::internal
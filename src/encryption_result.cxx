@@ -30,23 +30,29 @@ encryption_result::algorithm() const -> std::string
   return internal_.at("alg");
 }
 
+auto
+encryption_result::algorithm_ref() const -> const std::string&
+{
+  return internal_.at("alg");
+}
+
 auto
 encryption_result::get(const std::string& field_name) const -> std::optional<std::string>
 {
-  if (internal_.count(field_name) == 0) {
-    return std::nullopt;
+  if (const auto it = internal_.find(field_name); it != internal_.end()) {
+    return it->second;
   }
-  return internal_.at(field_name);
+  return std::nullopt;
 }
 
 auto
 encryption_result::get_bytes(const std::string& field_name) const
   -> std::optional<std::vector<std::byte>>
 {
-  if (internal_.count(field_name) == 0) {
-    return std::nullopt;
+  if (const auto it = internal_.find(field_name); it != internal_.end()) {
+    return impl::utils::base64::decode(it->second);
   }
-  return impl::utils::base64::decode(internal_.at(field_name));
+  return std::nullopt;
 }
 
 auto
@@ -55,6 +61,18 @@ encryption_result::as_map() const -> std::map<std::string, std::string>
   return internal_;
 }
 
+auto
+encryption_result::map_ref() const -> const std::map<std::string, std::string>&
+{
+  return internal_;
+}
+
+auto
+encryption_result::take_map() && -> std::map<std::string, std::string>
+{
+  return std::move(internal_);
+}
+
 void
 encryption_result::put(std::string field_name, std::string value)
 {
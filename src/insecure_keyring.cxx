@@ -21,12 +21,13 @@ insecure_keyring::insecure_keyring(const std::vector<key>& keys)
 auto
 insecure_keyring::get(const std::string& key_id) const -> std::pair<error, key>
 {
-  if (const auto it = keys_.find(key_id); it == keys_.end()) {
+  const auto it = keys_.find(key_id);
+  if (it == keys_.end()) {
     return {
       error{ errc::field_level_encryption::crypto_key_not_found, "Key not found: " + key_id }, {}
     };
   }
-  return { {}, keys_.at(key_id) };
+  return { {}, it->second };
 }
 
 void
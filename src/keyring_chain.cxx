@@ -0,0 +1,75 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include <couchbase/error_codes.hxx>
+#include <couchbase_encryption/keyring_chain.hxx>
+
+namespace couchbase::crypto
+{
+keyring_chain::keyring_chain(std::vector<std::shared_ptr<keyring>> keyrings)
+  : keyrings_{ std::move(keyrings) }
+{
+}
+
+auto
+keyring_chain::get(const std::string& key_id) const -> std::pair<error, key>
+{
+  for (const auto& k : keyrings_) {
+    auto res = k->get(key_id);
+    if (res.first.ec() != errc::field_level_encryption::crypto_key_not_found) {
+      return res;
+    }
+  }
+  return {
+    error{ errc::field_level_encryption::crypto_key_not_found, "Key not found: " + key_id }, {}
+  };
+}
+
+auto
+keyring_chain::get_many(const std::vector<std::string>& key_ids) const
+  -> std::vector<std::pair<error, key>>
+{
+  std::vector<std::pair<error, key>> results(key_ids.size());
+  for (std::size_t i = 0; i < key_ids.size(); ++i) {
+    results[i].first =
+      error{ errc::field_level_encryption::crypto_key_not_found, "Key not found: " + key_ids[i] };
+  }
+  std::vector<std::string> pending_key_ids{ key_ids };
+  std::vector<std::size_t> pending_positions(key_ids.size());
+  for (std::size_t i = 0; i < pending_positions.size(); ++i) {
+    pending_positions[i] = i;
+  }
+
+  for (const auto& k : keyrings_) {
+    if (pending_key_ids.empty()) {
+      break;
+    }
+    auto fetched = k->get_many(pending_key_ids);
+    std::vector<std::string> still_pending_key_ids{};
+    std::vector<std::size_t> still_pending_positions{};
+    for (std::size_t i = 0; i < pending_key_ids.size(); ++i) {
+      if (i >= fetched.size() ||
+          fetched[i].first.ec() == errc::field_level_encryption::crypto_key_not_found) {
+        still_pending_key_ids.push_back(std::move(pending_key_ids[i]));
+        still_pending_positions.push_back(pending_positions[i]);
+      } else {
+        results[pending_positions[i]] = std::move(fetched[i]);
+      }
+    }
+    pending_key_ids = std::move(still_pending_key_ids);
+    pending_positions = std::move(still_pending_positions);
+  }
+  return results;
+}
+
+void
+keyring_chain::prefetch(const std::vector<std::string>& key_ids) const
+{
+  [[maybe_unused]] auto results = get_many(key_ids);
+}
+} // namespace couchbase::crypto
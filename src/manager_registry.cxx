@@ -0,0 +1,120 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include <couchbase_encryption/default_manager.hxx>
+#include <couchbase_encryption/manager_registry.hxx>
+
+#include <mutex>
+
+namespace couchbase::crypto
+{
+namespace
+{
+template<typename Map>
+auto
+find_or_null(const Map& map, const std::string& key) -> typename Map::mapped_type
+{
+  if (const auto it = map.find(key); it != map.end()) {
+    return it->second;
+  }
+  return nullptr;
+}
+} // namespace
+
+auto
+manager_registry::register_encrypter_factory(encrypter_factory factory) -> error
+{
+  const std::unique_lock lock(mutex_);
+  encrypter_factory_ = std::move(factory);
+  key_id_to_encrypter_.clear();
+  return {};
+}
+
+auto
+manager_registry::register_encrypter(std::string alias, std::shared_ptr<encrypter> encrypter)
+  -> error
+{
+  const std::unique_lock lock(mutex_);
+  alias_to_encrypter_[std::move(alias)] = std::move(encrypter);
+  return {};
+}
+
+auto
+manager_registry::register_default_encrypter(std::shared_ptr<encrypter> encrypter) -> error
+{
+  return register_encrypter(default_manager::default_encrypter_alias, std::move(encrypter));
+}
+
+auto
+manager_registry::register_decrypter(std::shared_ptr<decrypter> decrypter) -> error
+{
+  const std::unique_lock lock(mutex_);
+  algorithm_to_decrypter_[decrypter->algorithm()] = std::move(decrypter);
+  return {};
+}
+
+auto
+manager_registry::register_blind_indexer(std::string alias, std::shared_ptr<blind_indexer> indexer)
+  -> error
+{
+  const std::unique_lock lock(mutex_);
+  alias_to_blind_indexer_[std::move(alias)] = std::move(indexer);
+  return {};
+}
+
+auto
+manager_registry::register_default_blind_indexer(std::shared_ptr<blind_indexer> indexer) -> error
+{
+  return register_blind_indexer(default_manager::default_encrypter_alias, std::move(indexer));
+}
+
+auto
+manager_registry::encrypter_for_key(const std::string& key_id) const -> std::shared_ptr<encrypter>
+{
+  {
+    const std::shared_lock lock(mutex_);
+    if (auto encrypter = find_or_null(key_id_to_encrypter_, key_id); encrypter != nullptr) {
+      return encrypter;
+    }
+  }
+
+  const std::unique_lock lock(mutex_);
+  if (!encrypter_factory_) {
+    return nullptr;
+  }
+  // another thread may have created the encrypter since the shared lock was released
+  auto& encrypter = key_id_to_encrypter_[key_id];
+  if (encrypter == nullptr) {
+    encrypter = encrypter_factory_(key_id);
+  }
+  return encrypter;
+}
+
+auto
+manager_registry::encrypter_for_alias(const std::string& alias) const -> std::shared_ptr<encrypter>
+{
+  const std::shared_lock lock(mutex_);
+  return find_or_null(alias_to_encrypter_, alias);
+}
+
+auto
+manager_registry::decrypter_for_algorithm(const std::string& algorithm) const
+  -> std::shared_ptr<decrypter>
+{
+  const std::shared_lock lock(mutex_);
+  return find_or_null(algorithm_to_decrypter_, algorithm);
+}
+
+auto
+manager_registry::blind_indexer_for_alias(const std::string& alias) const
+  -> std::shared_ptr<blind_indexer>
+{
+  const std::shared_lock lock(mutex_);
+  return find_or_null(alias_to_blind_indexer_, alias);
+}
+} // namespace couchbase::crypto
@@ -0,0 +1,210 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include <couchbase/error_codes.hxx>
+#include <couchbase_encryption/blind_indexer.hxx>
+#include <couchbase_encryption/manager_view.hxx>
+
+#include <spdlog/fmt/bundled/format.h>
+
+#include <algorithm>
+
+namespace couchbase::crypto
+{
+namespace
+{
+template<typename Aliases>
+auto
+find_alias(Aliases& aliases, const std::string& alias)
+{
+  return std::find_if(aliases.begin(), aliases.end(), [&alias](const auto& entry) {
+    return entry.first == alias;
+  });
+}
+} // namespace
+
+manager_view::manager_view(std::shared_ptr<const manager_registry> registry,
+                           std::string encrypted_field_name_prefix)
+  : registry_{ std::move(registry) }
+  , encrypted_field_name_prefix_{ std::move(encrypted_field_name_prefix) }
+{
+}
+
+auto
+manager_view::register_key(std::string alias, std::string key_id) -> error
+{
+  if (const auto it = find_alias(alias_to_key_id_, alias); it != alias_to_key_id_.end()) {
+    it->second = std::move(key_id);
+  } else {
+    alias_to_key_id_.emplace_back(std::move(alias), std::move(key_id));
+  }
+  return {};
+}
+
+auto
+manager_view::register_default_key(std::string key_id) -> error
+{
+  return register_key(default_manager::default_encrypter_alias, std::move(key_id));
+}
+
+auto
+manager_view::select_encrypter(const std::string& alias) const
+  -> std::pair<error, std::shared_ptr<encrypter>>
+{
+  if (const auto it = find_alias(alias_to_key_id_, alias); it != alias_to_key_id_.end()) {
+    auto selected = registry_->encrypter_for_key(it->second);
+    if (selected == nullptr) {
+      return { error{ errc::field_level_encryption::encrypter_not_found,
+                      fmt::format("Could not create encrypter for key `{}` of alias `{}`.",
+                                  it->second,
+                                  alias) },
+               {} };
+    }
+    return { error{}, std::move(selected) };
+  }
+  auto selected = registry_->encrypter_for_alias(alias);
+  if (selected == nullptr) {
+    return { error{ errc::field_level_encryption::encrypter_not_found,
+                    fmt::format("Could not find encrypter with alias `{}`.", alias) },
+             {} };
+  }
+  return { error{}, std::move(selected) };
+}
+
+auto
+manager_view::encrypt(std::vector<std::byte> plaintext,
+                      const std::optional<std::string>& encrypter_alias)
+  -> std::pair<error, std::map<std::string, std::string>>
+{
+  const auto& alias = encrypter_alias.has_value() ? encrypter_alias.value()
+                                                  : default_manager::default_encrypter_alias;
+  auto [select_err, selected] = select_encrypter(alias);
+  if (select_err) {
+    return { select_err, {} };
+  }
+
+  auto [err, res] = selected->encrypt(std::move(plaintext));
+  if (err) {
+    return { err, {} };
+  }
+  return { error{}, std::move(res).take_map() };
+}
+
+auto
+manager_view::decrypt(std::map<std::string, std::string> encrypted_node)
+  -> std::pair<error, std::vector<std::byte>>
+{
+  const auto algorithm = encrypted_node.find("alg");
+  if (algorithm == encrypted_node.end()) {
+    return { error{ errc::field_level_encryption::decryption_failure,
+                    "Encrypted field does not name its algorithm" },
+             {} };
+  }
+  const auto decrypter = registry_->decrypter_for_algorithm(algorithm->second);
+  if (decrypter == nullptr) {
+    return { error{ errc::field_level_encryption::decrypter_not_found,
+                    fmt::format("Could not find decrypter for algorithm `{}`.",
+                                algorithm->second) },
+             {} };
+  }
+  return decrypter->decrypt(encryption_result{ std::move(encrypted_node) });
+}
+
+auto
+manager_view::blind_index(const std::vector<std::byte>& plaintext,
+                          const std::optional<std::string>& indexer_alias)
+  -> std::pair<error, std::vector<std::byte>>
+{
+  const auto& alias =
+    indexer_alias.has_value() ? indexer_alias.value() : default_manager::default_encrypter_alias;
+  const auto indexer = registry_->blind_indexer_for_alias(alias);
+  if (indexer == nullptr) {
+    return { error{ blind_index_errc::blind_indexer_not_found,
+                    fmt::format("Could not find blind indexer with alias `{}`.", alias) },
+             {} };
+  }
+  return indexer->index(plaintext);
+}
+
+auto
+manager_view::placeholder(std::size_t plaintext_size,
+                          const std::optional<std::string>& encrypter_alias)
+  -> std::pair<error, std::map<std::string, std::string>>
+{
+  const auto& alias = encrypter_alias.has_value() ? encrypter_alias.value()
+                                                  : default_manager::default_encrypter_alias;
+  auto [select_err, selected] = select_encrypter(alias);
+  if (select_err) {
+    return { select_err, {} };
+  }
+
+  auto res = selected->placeholder(plaintext_size);
+  if (!res.has_value()) {
+    return { error{ errc::field_level_encryption::generic_cryptography_failure,
+                    fmt::format("Encrypter with alias `{}` cannot tell the size of its ciphertext "
+                                "in advance.",
+                                alias) },
+             {} };
+  }
+  return { error{}, std::move(res.value()).take_map() };
+}
+
+auto
+manager_view::blind_index_size(const std::optional<std::string>& indexer_alias)
+  -> std::pair<error, std::size_t>
+{
+  const auto& alias =
+    indexer_alias.has_value() ? indexer_alias.value() : default_manager::default_encrypter_alias;
+  const auto indexer = registry_->blind_indexer_for_alias(alias);
+  if (indexer == nullptr) {
+    return { error{ blind_index_errc::blind_indexer_not_found,
+                    fmt::format("Could not find blind indexer with alias `{}`.", alias) },
+             {} };
+  }
+  const auto size = indexer->index_size();
+  if (!size.has_value()) {
+    return { error{ errc::field_level_encryption::generic_cryptography_failure,
+                    fmt::format("Blind indexer with alias `{}` cannot tell the size of its hashes "
+                                "in advance.",
+                                alias) },
+             {} };
+  }
+  return { error{}, size.value() };
+}
+
+auto
+manager_view::mangle(std::string field_name) -> std::string
+{
+  return encrypted_field_name_prefix_ + std::move(field_name);
+}
+
+auto
+manager_view::demangle(std::string field_name) -> std::string
+{
+  return field_name.substr(encrypted_field_name_prefix_.size());
+}
+
+auto
+manager_view::is_mangled(const std::string& field_name) -> bool
+{
+  return field_name.compare(0, encrypted_field_name_prefix_.size(), encrypted_field_name_prefix_) ==
+         0;
+}
+
+void
+manager_view::prefetch_keys(
+  const std::map<std::string, std::vector<std::string>>& key_ids_by_algorithm)
+{
+  for (const auto& [algorithm, key_ids] : key_ids_by_algorithm) {
+    const auto decrypter = registry_->decrypter_for_algorithm(algorithm);
+    if (decrypter != nullptr) {
+      decrypter->prefetch_keys(key_ids);
+    }
+  }
+}
+} // namespace couchbase::crypto
@@ -0,0 +1,108 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include <couchbase_encryption/subdoc.hxx>
+
+#include <couchbase/error_codes.hxx>
+
+#include "encrypted_node.hxx"
+#include "utils/flat_json.hxx"
+
+#include <spdlog/fmt/bundled/format.h>
+#include <spdlog/fmt/bundled/ranges.h>
+
+namespace couchbase::crypto::subdoc
+{
+namespace
+{
+void
+append_member_name(std::string& path, const std::string& name)
+{
+  if (!path.empty()) {
+    path += '.';
+  }
+  if (name.find_first_of(".[]`") == std::string::npos) {
+    path += name;
+    return;
+  }
+  path += '`';
+  for (const auto c : name) {
+    if (c == '`') {
+      path += '`';
+    }
+    path += c;
+  }
+  path += '`';
+}
+} // namespace
+
+auto
+encrypted_path(const std::vector<std::string>& field_path,
+               const std::shared_ptr<manager>& crypto_manager) -> std::pair<error, std::string>
+{
+  if (field_path.empty()) {
+    return { error{ errc::field_level_encryption::encryption_failure,
+                    "Empty path is not allowed for encryption" },
+             {} };
+  }
+
+  std::string path{};
+  for (std::size_t i = 0; i < field_path.size(); ++i) {
+    const auto& segment = field_path[i];
+    if (segment == internal::wildcard_segment) {
+      return { error{ errc::field_level_encryption::encryption_failure,
+                      "Wildcard segments cannot be used in sub-document paths" },
+               {} };
+    }
+    const auto index = internal::parse_array_index(segment);
+    if (!index.has_value()) {
+      append_member_name(path, i + 1 == field_path.size() ? crypto_manager->mangle(segment)
+                                                          : segment);
+    } else if (i == 0 || i + 1 == field_path.size()) {
+      // documents are objects, and only object members can be encrypted
+      return { error{ errc::field_level_encryption::encryption_failure,
+                      fmt::format("Path '{}' addresses an array element, only object members "
+                                  "can be encrypted",
+                                  fmt::join(field_path, ".")) },
+               {} };
+    } else {
+      path += fmt::format("[{}]", index.value());
+    }
+  }
+  return { error{}, std::move(path) };
+}
+
+auto
+encrypt_value(const encrypted_field& field,
+              const codec::binary& value,
+              const std::shared_ptr<manager>& crypto_manager) -> std::pair<error, codec::binary>
+{
+  auto [parse_err, parsed] = impl::utils::flat_json::parse(value);
+  if (parse_err) {
+    return { parse_err, {} };
+  }
+  impl::utils::flat_json::arena strings{};
+  auto [err, node] =
+    internal::encrypt_node(parsed, field, crypto_manager, document_format::json, strings);
+  if (err) {
+    return { err, {} };
+  }
+  return { error{}, impl::utils::flat_json::generate(node) };
+}
+
+auto
+decrypt_value(const codec::binary& encrypted_node, const std::shared_ptr<manager>& crypto_manager)
+  -> std::pair<error, codec::binary>
+{
+  auto [parse_err, node] = impl::utils::flat_json::parse(encrypted_node);
+  if (parse_err) {
+    return { parse_err, {} };
+  }
+  return internal::decrypt_node_plaintext(node, crypto_manager);
+}
+} // namespace couchbase::crypto::subdoc
@@ -8,159 +8,967 @@
 
 #include <couchbase_encryption/transcoder.hxx>
 
-#include "utils/json.hxx"
+#include "decode_state.hxx"
+#include "encrypted_node.hxx"
+#include "utils/flat_json.hxx"
 
 #include <spdlog/fmt/bundled/format.h>
 #include <spdlog/fmt/bundled/ranges.h>
+#include <tao/json/cbor.hpp>
+#include <tao/json/from_string.hpp>
+#include <tao/json/msgpack.hpp>
+#include <tao/json/to_string.hpp>
 #include <tao/json/value.hpp>
 
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <stdexcept>
+
 namespace couchbase::crypto::internal
 {
 namespace
 {
+namespace flat = impl::utils::flat_json;
+
+/**
+ * A parsed document, and the strings its values refer to that are not part of the encoded
+ * document (which must outlive it as well).
+ */
+struct parsed_document {
+  flat::arena strings{};
+  flat::value root{};
+};
+
 auto
-decrypt_top_level_object_fields(tao::json::value& object,
-                                const std::shared_ptr<manager>& crypto_manager) -> error
+type_name(flat::value_type type) -> std::string_view
 {
-  std::vector<std::string> encrypted_keys{};
+  switch (type) {
+    case flat::value_type::null:
+      return "null";
+    case flat::value_type::boolean:
+      return "boolean";
+    case flat::value_type::number:
+      return "number";
+    case flat::value_type::string:
+      return "string";
+    case flat::value_type::binary:
+      return "binary";
+    case flat::value_type::array:
+      return "array";
+    case flat::value_type::object:
+      return "object";
+  }
+  return "unknown";
+}
 
-  for (const auto& [k, v] : object.get_object()) {
-    if (crypto_manager->is_mangled(k)) {
-      if (!v.is_object()) {
-        return error{ errc::field_level_encryption::invalid_ciphertext,
-                      "Expected an object for encrypted field" };
-      }
+/**
+ * Converts a document decoded from a binary format. Binary formats are only used for storage, so
+ * their documents do not need the performance of the JSON path.
+ */
+auto
+from_binary_format(const tao::json::value& v, flat::arena& strings) -> flat::value
+{
+  if (v.is_null()) {
+    return flat::value::make_null();
+  }
+  if (v.is_boolean()) {
+    return flat::value::make_boolean(v.get_boolean());
+  }
+  if (v.is_number()) {
+    return flat::value::make_number(strings.store(tao::json::to_string(v)));
+  }
+  if (v.is_string_type()) {
+    return flat::value::make_string(v.get_string_type(), strings);
+  }
+  if (v.is_binary_type()) {
+    const auto bytes = v.get_binary_type();
+    return flat::value::make_binary(
+      strings.store(std::string{ reinterpret_cast<const char*>(bytes.data()), bytes.size() }));
+  }
+  if (v.is_array()) {
+    auto result = flat::value::make_array();
+    result.children().reserve(v.get_array().size());
+    for (const auto& element : v.get_array()) {
+      result.children().push_back(from_binary_format(element, strings));
+    }
+    return result;
+  }
+  auto result = flat::value::make_object();
+  result.children().reserve(v.get_object().size());
+  for (const auto& [k, member] : v.get_object()) {
+    result.children().emplace_back(from_binary_format(member, strings)).set_key(k, strings);
+  }
+  return result;
+}
 
-      std::map<std::string, std::string> encrypted_node;
-      for (const auto& [node_k, node_v] : v.get_object()) {
-        encrypted_node[node_k] = node_v.get_string();
+auto
+to_binary_format(const flat::value& v) -> tao::json::value
+{
+  switch (v.type()) {
+    case flat::value_type::null:
+      return tao::json::null;
+    case flat::value_type::boolean:
+      return v.get_boolean();
+    case flat::value_type::number:
+      return tao::json::from_string(v.text());
+    case flat::value_type::string:
+      return v.get_string();
+    case flat::value_type::binary: {
+      const auto* begin = reinterpret_cast<const std::byte*>(v.text().data());
+      return std::vector<std::byte>{ begin, begin + v.text().size() };
+    }
+    case flat::value_type::array: {
+      tao::json::value result = tao::json::empty_array;
+      for (const auto& element : v.children()) {
+        result.get_array().push_back(to_binary_format(element));
       }
+      return result;
+    }
+    case flat::value_type::object:
+      break;
+  }
+  tao::json::value result = tao::json::empty_object;
+  for (const auto& member : v.children()) {
+    result[member.get_key()] = to_binary_format(member);
+  }
+  return result;
+}
 
-      auto [err, decrypted] = crypto_manager->decrypt(encrypted_node);
-      if (err) {
-        return std::move(err);
+auto
+parse_document(const codec::binary& raw, document_format format, parsed_document& document)
+  -> error
+{
+  const std::string_view data{ reinterpret_cast<const char*>(raw.data()), raw.size() };
+  // unlike the JSON parser, the parsers of the binary formats report malformed input by throwing
+  try {
+    switch (format) {
+      case document_format::cbor:
+        document.root = from_binary_format(tao::json::cbor::from_string(data), document.strings);
+        return {};
+      case document_format::msgpack:
+        document.root =
+          from_binary_format(tao::json::msgpack::from_string(data), document.strings);
+        return {};
+      case document_format::json:
+        break;
+    }
+  } catch (const std::exception& e) {
+    return { errc::common::parsing_failure, e.what() };
+  }
+  auto [err, root] = flat::parse(data);
+  document.root = std::move(root);
+  return err;
+}
+
+auto
+generate_document(const flat::value& document, document_format format) -> codec::binary
+{
+  std::string data{};
+  switch (format) {
+    case document_format::cbor:
+      data = tao::json::cbor::to_string(to_binary_format(document));
+      break;
+    case document_format::msgpack:
+      data = tao::json::msgpack::to_string(to_binary_format(document));
+      break;
+    case document_format::json:
+      return flat::generate(document);
+  }
+  const auto* begin = reinterpret_cast<const std::byte*>(data.data());
+  return { begin, begin + data.size() };
+}
+
+/**
+ * Generates the JSON of a decrypted document for the serializer. Documents read from a binary
+ * format may hold binary values outside of encrypted fields, which JSON cannot represent.
+ */
+auto
+generate_decrypted(const flat::value& document) -> std::pair<error, codec::binary>
+{
+  try {
+    return { error{}, flat::generate(document) };
+  } catch (const std::runtime_error& e) {
+    return { error{ errc::field_level_encryption::decryption_failure,
+                    fmt::format("Failed to generate decrypted document: {}", e.what()) },
+             {} };
+  }
+}
+
+auto
+find_member(const flat::value& object, std::string_view name) -> std::optional<std::size_t>
+{
+  const auto& members = object.children();
+  for (std::size_t i = 0; i < members.size(); ++i) {
+    if (members[i].has_key(name)) {
+      return i;
+    }
+  }
+  return std::nullopt;
+}
+
+/**
+ * Replaces the member at the given index with the given value, under the given name, which keeps
+ * its position in the object. Any other member with that name is removed, and the index adjusted.
+ */
+void
+replace_member(flat::value& object,
+               std::size_t& index,
+               std::string_view name,
+               flat::value replacement,
+               flat::arena& strings)
+{
+  auto& members = object.children();
+  for (std::size_t i = 0; i < members.size(); ++i) {
+    if (i != index && members[i].has_key(name)) {
+      members.erase(members.begin() + static_cast<std::ptrdiff_t>(i));
+      if (i < index) {
+        --index;
       }
+      break;
+    }
+  }
+  members[index] = std::move(replacement);
+  members[index].set_key(name, strings);
+}
 
-      object[crypto_manager->demangle(k)] = impl::utils::json::parse_binary(decrypted);
-      encrypted_keys.push_back(k);
+/**
+ * Where the encrypted fields of a document being decrypted are remembered, and the outcome of
+ * decrypting each of them is reported, if anywhere. Fields that cannot be decrypted are left
+ * encrypted if their outcome is reported, instead of failing the whole document.
+ */
+struct decode_target {
+  decode_state* state{ nullptr };
+  document_format format{ document_format::json };
+  std::vector<field_decryption_status>* statuses{ nullptr };
+
+  [[nodiscard]] auto tracks_pointers() const -> bool
+  {
+    return state != nullptr || statuses != nullptr;
+  }
+};
+
+auto
+member_pointer(const std::string& object_pointer, std::string_view name) -> std::string
+{
+  auto pointer = object_pointer;
+  append_pointer_token(pointer, name);
+  return pointer;
+}
+
+/**
+ * Decrypts the encrypted node at the given index of the object, and replaces it with the decrypted
+ * value under the demangled name.
+ */
+auto
+decrypt_member(flat::value& object,
+               std::size_t& index,
+               parsed_document& document,
+               const std::shared_ptr<manager>& crypto_manager,
+               const decode_target& target = {},
+               const std::string& object_pointer = {}) -> error
+{
+  auto& node = object.children()[index];
+  auto [err, plaintext] = decrypt_node_plaintext(node, crypto_manager);
+  flat::value decrypted{};
+  if (!err) {
+    auto [parse_err, parsed] = flat::parse(document.strings.store(plaintext));
+    if (parse_err) {
+      err = { errc::field_level_encryption::decryption_failure,
+              "Decrypted field is not valid JSON: " + parse_err.message() };
     }
+    decrypted = std::move(parsed);
+  }
+  if (err) {
+    if (target.statuses == nullptr) {
+      return std::move(err);
+    }
+    target.statuses->push_back({ member_pointer(object_pointer, node.get_key()), std::move(err) });
+    return {};
   }
 
-  for (const auto& k : encrypted_keys) {
-    object.get_object().erase(k);
+  auto key = crypto_manager->demangle(node.get_key());
+  if (target.tracks_pointers()) {
+    auto pointer = member_pointer(object_pointer, key);
+    if (target.state != nullptr) {
+      // the encrypter compares against the value as this library would serialize it, which may
+      // differ from the bytes written by another implementation
+      target.state->remember(pointer, flat::generate(decrypted), node, target.format);
+    }
+    if (target.statuses != nullptr) {
+      target.statuses->push_back({ std::move(pointer), {} });
+    }
   }
+  replace_member(object, index, key, std::move(decrypted), document.strings);
   return {};
 }
 
 auto
-decrypt_json_value(tao::json::value& value, const std::shared_ptr<manager>& crypto_manager) -> error
+decrypt_top_level_object_fields(flat::value& object,
+                                parsed_document& document,
+                                const std::shared_ptr<manager>& crypto_manager,
+                                const decode_target& target = {},
+                                const std::string& object_pointer = {}) -> error
 {
-  if (value.is_object()) {
-    if (auto err = decrypt_top_level_object_fields(value, crypto_manager)) {
+  // decrypted members keep their position, and are not decrypted again, as the loop moves past
+  // them
+  for (std::size_t i = 0; i < object.children().size(); ++i) {
+    if (!crypto_manager->is_mangled(object.children()[i].get_key())) {
+      continue;
+    }
+    if (auto err = decrypt_member(object, i, document, crypto_manager, target, object_pointer);
+        err) {
       return err;
     }
-    for (auto& [k, v] : value.get_object()) {
-      if (auto err = decrypt_json_value(v, crypto_manager)) {
+  }
+  return {};
+}
+
+/**
+ * Decrypts every encrypted field in the document. Values are visited with an explicit stack, so
+ * that deeply nested documents cannot exhaust the call stack. Decrypted values are visited as well,
+ * as they may contain encrypted fields of their own.
+ *
+ * JSON pointers to the values are only tracked if the encrypted fields are remembered, or the
+ * outcome of decrypting them reported.
+ */
+auto
+decrypt_json_value(parsed_document& document,
+                   const std::shared_ptr<manager>& crypto_manager,
+                   const decode_target& target = {}) -> error
+{
+  const bool track_pointers = target.tracks_pointers();
+  std::vector<std::pair<flat::value*, std::string>> pending{ { &document.root, std::string{} } };
+  while (!pending.empty()) {
+    auto [value, pointer] = std::move(pending.back());
+    pending.pop_back();
+
+    if (value->is_object()) {
+      if (auto err =
+            decrypt_top_level_object_fields(*value, document, crypto_manager, target, pointer)) {
         return err;
       }
+    } else if (!value->is_array()) {
+      continue;
     }
-  } else if (value.is_array()) {
-    for (auto& item : value.get_array()) {
-      if (auto err = decrypt_json_value(item, crypto_manager)) {
-        return err;
+    // the members of the object do not move anymore, so they can be referred to
+    auto& children = value->children();
+    for (std::size_t i = 0; i < children.size(); ++i) {
+      if (children[i].is_object() || children[i].is_array()) {
+        std::string child_pointer{};
+        if (track_pointers) {
+          child_pointer = pointer;
+          append_pointer_token(child_pointer,
+                               value->is_object() ? children[i].get_key() : std::to_string(i));
+        }
+        pending.emplace_back(&children[i], std::move(child_pointer));
       }
     }
   }
   return {};
 }
-} // namespace
 
-auto
-encrypt(const codec::binary& raw,
-        const std::vector<encrypted_field>& encrypted_fields,
-        const std::shared_ptr<manager>& crypto_manager) -> std::pair<error, codec::binary>
-{
-  auto ordered_encrypted_fields = encrypted_fields;
-  std::sort(ordered_encrypted_fields.begin(),
-            ordered_encrypted_fields.end(),
-            [](const encrypted_field& a, const encrypted_field& b) {
-              return a.field_path.size() > b.field_path.size();
-            });
-
-  auto document = impl::utils::json::parse_binary(raw);
-  if (!document.is_object()) {
-    return {
-      error{ errc::field_level_encryption::encryption_failure,
-             "Failed to parse document for encryption: not a JSON object" },
-      {},
-    };
-  }
+/**
+ * The encrypted fields of a document, merged into a tree of path segments, so that the document
+ * can be encrypted in a single traversal, however many fields share a prefix.
+ */
+struct field_path_node {
+  const encrypted_field* field{ nullptr };
+  std::map<std::string, field_path_node> children{};
+};
 
-  for (const auto& [path, alias] : ordered_encrypted_fields) {
-    if (path.empty()) {
+auto
+build_field_path_tree(const std::vector<encrypted_field>& encrypted_fields)
+  -> std::pair<error, field_path_node>
+{
+  field_path_node root{};
+  for (const auto& field : encrypted_fields) {
+    if (field.field_path.empty()) {
       return { error{
                  errc::field_level_encryption::encryption_failure,
                  fmt::format("Empty path is not allowed for encryption"),
                },
                {} };
     }
-
-    tao::json::value* blob = &document;
-
-    for (std::size_t i = 0; i < path.size() - 1; ++i) {
-      blob = blob->find(path.at(i));
-      if (blob == nullptr) {
-        return { error{
-                   errc::field_level_encryption::encryption_failure,
-                   fmt::format("Failed to find path '{}' in document for encryption",
-                               fmt::join(path, ".")),
-                 },
-                 {} };
-      }
-      if (!blob->is_object()) {
-        return { error{
-                   errc::field_level_encryption::encryption_failure,
-                   fmt::format(
-                     "Path '{}' in document for encryption points to {} instead of an object",
-                     fmt::join(path, "."),
-                     tao::json::to_string(blob->type())),
-                 },
-                 {} };
-      }
+    field_path_node* node = &root;
+    for (const auto& segment : field.field_path) {
+      node = &node->children[segment];
     }
-    auto current_field_key = path.at(path.size() - 1);
-    if (blob->find(current_field_key) == nullptr) {
+    if (node->field != nullptr) {
       return { error{
                  errc::field_level_encryption::encryption_failure,
-                 fmt::format("Failed to find path '{}' in document for encryption",
-                             fmt::join(path, ".")),
+                 fmt::format("Path '{}' is listed more than once for encryption",
+                             fmt::join(field.field_path, ".")),
                },
                {} };
     }
-    const auto& current_field_value = blob->at(current_field_key);
-    auto [err, encrypted] =
-      crypto_manager->encrypt(impl::utils::json::generate_binary(current_field_value), alias);
-    if (err) {
-      return { err, {} };
+    node->field = &field;
+  }
+  return { error{}, std::move(root) };
+}
+
+/**
+ * Encrypts the fields at the given paths. With placeholders, the fields are replaced with encrypted
+ * nodes of the same size as the real ones, without encrypting anything, so that the size of the
+ * encrypted document can be computed.
+ */
+class field_encrypter
+{
+public:
+  field_encrypter(const std::shared_ptr<manager>& crypto_manager,
+                  parsed_document& document,
+                  document_format format,
+                  const decode_state* previous_state,
+                  bool placeholders = false)
+    : crypto_manager_{ crypto_manager }
+    , document_{ document }
+    , format_{ format }
+    , previous_state_{ previous_state }
+    , placeholders_{ placeholders }
+  {
+  }
+
+  /**
+   * Applies the children of the given path node to the given value. Children are visited before
+   * their parent is encrypted, so that nested encrypted fields are encrypted from the inside out.
+   */
+  auto visit(flat::value& value, const field_path_node& node, bool under_wildcard) -> error
+  {
+    const auto wildcard_it = node.children.find(std::string{ wildcard_segment });
+    const auto* wildcard = wildcard_it == node.children.end() ? nullptr : &wildcard_it->second;
+    for (const auto& [segment, child] : node.children) {
+      if (segment == wildcard_segment) {
+        continue;
+      }
+      path_.push_back(segment);
+      auto err = visit_segment(value, segment, child, wildcard, under_wildcard);
+      path_.pop_back();
+      if (err) {
+        return err;
+      }
+    }
+    // concrete segments go first, so that the wildcard does not encrypt their results again
+    if (wildcard != nullptr) {
+      path_.emplace_back(wildcard_segment);
+      auto err = visit_wildcard(value, *wildcard);
+      path_.pop_back();
+      if (err) {
+        return err;
+      }
+    }
+    return {};
+  }
+
+private:
+  auto visit_segment(flat::value& value,
+                     const std::string& segment,
+                     const field_path_node& child,
+                     const field_path_node* wildcard,
+                     bool under_wildcard) -> error
+  {
+    const auto array_index = parse_array_index(segment);
+    if (value.is_object() && !array_index.has_value()) {
+      auto index = find_member(value, segment);
+      if (!index.has_value()) {
+        if (under_wildcard) {
+          return {};
+        }
+        return error{
+          errc::field_level_encryption::encryption_failure,
+          fmt::format("Failed to find path '{}' in document for encryption", fmt::join(path_, ".")),
+        };
+      }
+      return visit_member(value, index.value(), segment, child, wildcard, under_wildcard);
+    }
+    if (value.is_array() && array_index.has_value()) {
+      auto& array = value.children();
+      if (array_index.value() >= array.size()) {
+        if (under_wildcard) {
+          return {};
+        }
+        return error{
+          errc::field_level_encryption::encryption_failure,
+          fmt::format("Failed to find path '{}' in document for encryption", fmt::join(path_, ".")),
+        };
+      }
+      return visit_element(
+        array[array_index.value()], array_index.value(), child, under_wildcard);
+    }
+    if (under_wildcard) {
+      return {};
+    }
+    return error{
+      errc::field_level_encryption::encryption_failure,
+      fmt::format("Path '{}' in document for encryption points to {} instead of {}",
+                  fmt::join(path_.begin(), std::prev(path_.end()), "."),
+                  type_name(value.type()),
+                  array_index.has_value() ? "an array" : "an object"),
+    };
+  }
+
+  auto visit_wildcard(flat::value& value, const field_path_node& child) -> error
+  {
+    if (value.is_object()) {
+      // encrypted members keep their position, and are skipped as the loop moves past them
+      for (std::size_t i = 0; i < value.children().size(); ++i) {
+        auto key = value.children()[i].get_key();
+        if (crypto_manager_->is_mangled(key)) {
+          continue;
+        }
+        if (auto err = visit_member(value, i, key, child, nullptr, true); err) {
+          return err;
+        }
+      }
+      return {};
+    }
+    if (value.is_array()) {
+      auto& array = value.children();
+      for (std::size_t i = 0; i < array.size(); ++i) {
+        if (auto err = visit_element(array[i], i, child, true); err) {
+          return err;
+        }
+      }
+    }
+    return {};
+  }
+
+  auto visit_element(flat::value& element,
+                     std::size_t index,
+                     const field_path_node& child,
+                     bool under_wildcard) -> error
+  {
+    if (child.field != nullptr) {
+      return error{
+        errc::field_level_encryption::encryption_failure,
+        fmt::format("Path '{}' in document for encryption points to an array element, only object "
+                    "members can be encrypted",
+                    fmt::join(path_, ".")),
+      };
+    }
+    const auto pointer_size = enter(std::to_string(index));
+    auto err = visit(element, child, under_wildcard);
+    pointer_.resize(pointer_size);
+    return err;
+  }
+
+  /**
+   * Visits the member at the given index of the object. If it is encrypted, the index is updated
+   * to the position of the encrypted node.
+   *
+   * The wildcard of the object, if any, skips the members that are already encrypted, so the paths
+   * that continue below it are applied to a member before the member is encrypted. A member that
+   * both a path and a wildcard encrypt is encrypted once, as the path says.
+   */
+  auto visit_member(flat::value& object,
+                    std::size_t& index,
+                    const std::string& key,
+                    const field_path_node& child,
+                    const field_path_node* wildcard,
+                    bool under_wildcard) -> error
+  {
+    const auto pointer_size = enter(key);
+    error err{};
+    if (!child.children.empty()) {
+      err = visit(object.children()[index], child, under_wildcard);
+    }
+    if (!err && child.field != nullptr && wildcard != nullptr && !wildcard->children.empty()) {
+      err = visit(object.children()[index], *wildcard, true);
+    }
+    if (!err && child.field != nullptr) {
+      err = encrypt_member(object, index, key, *child.field);
+    }
+    pointer_.resize(pointer_size);
+    return err;
+  }
+
+  auto encrypt_member(flat::value& object,
+                      std::size_t& index,
+                      const std::string& key,
+                      const encrypted_field& field) -> error
+  {
+    plaintext_.clear();
+    flat::generate(object.children()[index], plaintext_);
+
+    flat::value node{};
+    const flat::value* previous_node = nullptr;
+    if (previous_state_ != nullptr) {
+      previous_node = previous_state_->reusable_node(pointer_, plaintext_, format_);
+      if (previous_node != nullptr &&
+          (!in_envelope(*previous_node, field) ||
+           !node_matches_field(*previous_node, plaintext_, field, crypto_manager_))) {
+        // encrypted again, so that changing the envelope, the encrypter alias, the key or the
+        // blind index of a field takes effect
+        previous_node = nullptr;
+      }
+    }
+    if (previous_node != nullptr) {
+      // the plaintext has not changed since the document was decoded
+      node = *previous_node;
+    } else {
+      auto [err, members] = placeholders_
+                              ? placeholder_members(plaintext_.size(), field, crypto_manager_)
+                              : encrypt_plaintext(plaintext_, field, crypto_manager_);
+      if (err) {
+        return err;
+      }
+      node = make_encrypted_node(members, format_, field.envelope, document_.strings);
+    }
+    replace_member(object, index, crypto_manager_->mangle(key), std::move(node), document_.strings);
+    return {};
+  }
+
+  /**
+   * Returns false if the given node is not in the envelope the field asks for. Fields with a blind
+   * index are always stored as objects.
+   */
+  static auto in_envelope(const flat::value& node, const encrypted_field& field) -> bool
+  {
+    if (field.envelope == envelope_format::compact) {
+      return node.is_string() || field.blind_index.has_value();
+    }
+    return !node.is_string();
+  }
+
+  /**
+   * Extends the JSON pointer to the current value, if it is needed to look up previous encrypted
+   * nodes, and returns its previous size.
+   */
+  auto enter(std::string_view token) -> std::size_t
+  {
+    const auto size = pointer_.size();
+    if (previous_state_ != nullptr) {
+      append_pointer_token(pointer_, token);
+    }
+    return size;
+  }
+
+  const std::shared_ptr<manager>& crypto_manager_;
+  parsed_document& document_;
+  document_format format_;
+  const decode_state* previous_state_;
+  bool placeholders_;
+  std::vector<std::string> path_{};
+  std::string pointer_{};
+  // the plaintext of every field is generated into the same buffer
+  std::vector<std::byte> plaintext_{};
+};
+
+/**
+ * Decrypts only the fields at the given paths, without visiting the rest of the document.
+ */
+class field_decrypter
+{
+public:
+  field_decrypter(const std::shared_ptr<manager>& crypto_manager,
+                  parsed_document& document,
+                  const decode_target& target)
+    : crypto_manager_{ crypto_manager }
+    , document_{ document }
+    , target_{ target }
+  {
+  }
+
+  /**
+   * Applies the children of the given path node to the given value. Every field of the value is
+   * decrypted before any path continues below it, as the children of an encrypted field are inside
+   * its ciphertext, whether the field was named by a path or matched by a wildcard.
+   */
+  auto visit(flat::value& value, const field_path_node& node) -> error
+  {
+    if (value.is_object()) {
+      for (const auto& [segment, child] : node.children) {
+        if (child.field == nullptr) {
+          continue;
+        }
+        if (auto err = segment == wildcard_segment ? decrypt_all_members(value)
+                                                   : decrypt_member_named(value, segment);
+            err) {
+          return err;
+        }
+      }
+    }
+    // concrete segments go first, like when encrypting
+    for (const auto& [segment, child] : node.children) {
+      if (child.children.empty() || segment == wildcard_segment) {
+        continue;
+      }
+      if (auto err = visit_segment(value, segment, child); err) {
+        return err;
+      }
+    }
+    if (const auto it = node.children.find(std::string{ wildcard_segment });
+        it != node.children.end() && !it->second.children.empty()) {
+      return visit_wildcard(value, it->second);
+    }
+    return {};
+  }
+
+private:
+  auto decrypt_member_named(flat::value& object, const std::string& segment) -> error
+  {
+    if (auto index = find_member(object, crypto_manager_->mangle(segment)); index.has_value()) {
+      return decrypt_member(object, index.value(), document_, crypto_manager_, target_, pointer_);
     }
-    blob->erase(current_field_key);
+    return {};
+  }
+
+  auto decrypt_all_members(flat::value& object) -> error
+  {
+    return decrypt_top_level_object_fields(object, document_, crypto_manager_, target_, pointer_);
+  }
 
-    (*blob)[crypto_manager->mangle(current_field_key)] = tao::json::empty_object;
-    for (const auto& [k, v] : encrypted) {
-      (*blob)[crypto_manager->mangle(current_field_key)][k] = v;
+  auto visit_segment(flat::value& value, const std::string& segment, const field_path_node& child)
+    -> error
+  {
+    const auto index = parse_array_index(segment);
+    if (value.is_object() && !index.has_value()) {
+      if (auto* member = value.find(segment); member != nullptr) {
+        return visit_child(*member, segment, child);
+      }
+    } else if (value.is_array() && index.has_value() && index.value() < value.children().size()) {
+      return visit_child(value.children()[index.value()], std::to_string(index.value()), child);
     }
+    return {};
   }
-  return { {}, impl::utils::json::generate_binary(document) };
+
+  auto visit_wildcard(flat::value& value, const field_path_node& child) -> error
+  {
+    if (value.is_object()) {
+      for (auto& member : value.children()) {
+        if (auto err = visit_child(member, member.get_key(), child); err) {
+          return err;
+        }
+      }
+    } else if (value.is_array()) {
+      auto& array = value.children();
+      for (std::size_t i = 0; i < array.size(); ++i) {
+        if (auto err = visit_child(array[i], std::to_string(i), child); err) {
+          return err;
+        }
+      }
+    }
+    return {};
+  }
+
+  auto visit_child(flat::value& value, std::string_view token, const field_path_node& child)
+    -> error
+  {
+    const auto pointer_size = pointer_.size();
+    if (target_.tracks_pointers()) {
+      append_pointer_token(pointer_, token);
+    }
+    auto err = visit(value, child);
+    pointer_.resize(pointer_size);
+    return err;
+  }
+
+  const std::shared_ptr<manager>& crypto_manager_;
+  parsed_document& document_;
+  decode_target target_;
+  std::string pointer_{};
+};
+
+auto
+parse_for_decryption(const codec::binary& encrypted,
+                     document_format format,
+                     parsed_document& document) -> error
+{
+  if (auto err = parse_document(encrypted, format, document); err) {
+    return { errc::field_level_encryption::decryption_failure,
+             "Failed to parse document for decryption: " + err.message() };
+  }
+  return {};
 }
 
+/**
+ * Parses the JSON produced by the serializer into the given document, and encrypts its fields, or
+ * replaces them with placeholders of the same size.
+ */
 auto
-decrypt(const codec::binary& encrypted, const std::shared_ptr<manager>& crypto_manager)
-  -> std::pair<error, codec::binary>
+encrypt_fields(const codec::binary& raw,
+               const std::vector<encrypted_field>& encrypted_fields,
+               const std::shared_ptr<manager>& crypto_manager,
+               document_format format,
+               const decode_state* previous_state,
+               bool placeholders,
+               parsed_document& document) -> error
 {
-  auto document = impl::utils::json::parse_binary(encrypted);
-  if (auto err = decrypt_json_value(document, crypto_manager)) {
+  auto [tree_err, field_paths] = build_field_path_tree(encrypted_fields);
+  if (tree_err) {
+    return tree_err;
+  }
+
+  // the serializer always produces JSON, whatever the format the document is stored in
+  if (auto err = parse_document(raw, document_format::json, document); err) {
+    return { errc::field_level_encryption::encryption_failure,
+             "Failed to parse document for encryption: " + err.message() };
+  }
+  if (!document.root.is_object()) {
+    return { errc::field_level_encryption::encryption_failure,
+             "Failed to parse document for encryption: not a JSON object" };
+  }
+
+  return field_encrypter{ crypto_manager, document, format, previous_state, placeholders }.visit(
+    document.root, field_paths, false);
+}
+
+void
+add_key_id(const flat::value& node,
+           std::map<std::string, std::vector<std::string>>& key_ids_by_algorithm)
+{
+  auto key = encrypted_node_key(node);
+  if (!key.has_value()) {
+    return;
+  }
+  auto& [algorithm, key_id] = key.value();
+
+  auto& key_ids = key_ids_by_algorithm[algorithm];
+  if (std::find(key_ids.begin(), key_ids.end(), key_id) == key_ids.end()) {
+    key_ids.push_back(std::move(key_id));
+  }
+}
+
+/**
+ * Collects the IDs of the keys that the encrypted fields of the document were encrypted with, by
+ * algorithm. Encrypted fields nested in the ciphertext of other fields cannot be seen.
+ */
+void
+collect_key_ids(const flat::value& root,
+                const std::shared_ptr<manager>& crypto_manager,
+                std::map<std::string, std::vector<std::string>>& key_ids_by_algorithm)
+{
+  std::vector<const flat::value*> pending{ &root };
+  while (!pending.empty()) {
+    const auto* value = pending.back();
+    pending.pop_back();
+
+    const bool is_object = value->is_object();
+    for (const auto& child : value->children()) {
+      if (is_object && (child.is_object() || child.is_string()) &&
+          crypto_manager->is_mangled(child.get_key())) {
+        add_key_id(child, key_ids_by_algorithm);
+        continue;
+      }
+      if (child.is_object() || child.is_array()) {
+        pending.push_back(&child);
+      }
+    }
+  }
+}
+} // namespace
+
+auto
+encrypt(const codec::binary& raw,
+        const std::vector<encrypted_field>& encrypted_fields,
+        const std::shared_ptr<manager>& crypto_manager,
+        document_format format,
+        const decode_state* previous_state) -> std::pair<error, codec::binary>
+{
+  parsed_document document{};
+  if (auto err = encrypt_fields(
+        raw, encrypted_fields, crypto_manager, format, previous_state, false, document);
+      err) {
     return { err, {} };
   }
-  return { {}, impl::utils::json::generate_binary(document) };
+  return { error{}, generate_document(document.root, format) };
+}
+
+auto
+encoded_size(const codec::binary& raw,
+             const std::vector<encrypted_field>& encrypted_fields,
+             const std::shared_ptr<manager>& crypto_manager,
+             document_format format) -> std::pair<error, std::size_t>
+{
+  parsed_document document{};
+  if (auto err =
+        encrypt_fields(raw, encrypted_fields, crypto_manager, format, nullptr, true, document);
+      err) {
+    return { err, 0 };
+  }
+  if (format == document_format::json) {
+    return { error{}, flat::generated_size(document.root) };
+  }
+  // the binary formats have no size computation of their own, but are rarely used for documents
+  // large enough for that to matter
+  return { error{}, generate_document(document.root, format).size() };
+}
+
+auto
+decrypt(const codec::binary& encrypted,
+        const std::shared_ptr<manager>& crypto_manager,
+        document_format format,
+        decode_state* state,
+        std::vector<field_decryption_status>* statuses) -> std::pair<error, codec::binary>
+{
+  parsed_document document{};
+  if (auto err = parse_for_decryption(encrypted, format, document); err) {
+    return { err, {} };
+  }
+  if (auto err = decrypt_json_value(document, crypto_manager, { state, format, statuses })) {
+    return { err, {} };
+  }
+  return generate_decrypted(document.root);
+}
+
+auto
+decrypt(const codec::binary& encrypted,
+        const std::vector<encrypted_field>& encrypted_fields,
+        const std::shared_ptr<manager>& crypto_manager,
+        document_format format,
+        decode_state* state,
+        std::vector<field_decryption_status>* statuses) -> std::pair<error, codec::binary>
+{
+  auto [tree_err, field_paths] = build_field_path_tree(encrypted_fields);
+  if (tree_err) {
+    return { tree_err, {} };
+  }
+
+  parsed_document document{};
+  if (auto err = parse_for_decryption(encrypted, format, document); err) {
+    return { err, {} };
+  }
+  if (auto err = field_decrypter{ crypto_manager, document, { state, format, statuses } }.visit(
+        document.root, field_paths);
+      err) {
+    return { err, {} };
+  }
+  return generate_decrypted(document.root);
+}
+
+auto
+decrypt_many(const std::vector<codec::encoded_value>& encrypted,
+             const std::shared_ptr<manager>& crypto_manager,
+             document_format format) -> std::vector<std::pair<error, codec::binary>>
+{
+  std::vector<std::pair<error, codec::binary>> results(encrypted.size());
+  std::vector<parsed_document> documents(encrypted.size());
+  std::map<std::string, std::vector<std::string>> key_ids_by_algorithm{};
+  for (std::size_t i = 0; i < encrypted.size(); ++i) {
+    if (auto err = parse_for_decryption(encrypted[i].data, format, documents[i]); err) {
+      results[i].first = std::move(err);
+      continue;
+    }
+    collect_key_ids(documents[i].root, crypto_manager, key_ids_by_algorithm);
+  }
+
+  if (!key_ids_by_algorithm.empty()) {
+    crypto_manager->prefetch_keys(key_ids_by_algorithm);
+  }
+
+  for (std::size_t i = 0; i < encrypted.size(); ++i) {
+    if (results[i].first) {
+      continue;
+    }
+    if (auto err = decrypt_json_value(documents[i], crypto_manager, { nullptr, format })) {
+      results[i].first = std::move(err);
+      continue;
+    }
+    results[i] = generate_decrypted(documents[i].root);
+    // the parsed document refers to the encrypted bytes and may be large, so it is released as
+    // soon as it is no longer needed
+    documents[i] = {};
+  }
+  return results;
 }
 } // namespace couchbase::crypto::internal
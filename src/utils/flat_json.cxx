@@ -0,0 +1,878 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include "flat_json.hxx"
+
+#include <couchbase/error_codes.hxx>
+
+#include <spdlog/fmt/bundled/format.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace couchbase::crypto::impl::utils::flat_json
+{
+namespace
+{
+/// Deeper documents are rejected, so that they cannot exhaust the call stack
+constexpr std::size_t max_depth{ 1024 };
+
+/// Objects up to this size are checked for duplicate member names without hashing
+constexpr std::size_t small_object_size{ 16 };
+
+constexpr std::string_view literal_null{ "null" };
+constexpr std::string_view literal_true{ "true" };
+constexpr std::string_view literal_false{ "false" };
+
+auto
+needs_escaping(std::string_view s) -> bool
+{
+  return std::any_of(s.begin(), s.end(), [](char c) {
+    return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20 || c == 0x7f;
+  });
+}
+
+auto
+hex_value(char c) -> int
+{
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+auto
+is_digit(char c) -> bool
+{
+  return c >= '0' && c <= '9';
+}
+
+void
+append_utf8(std::string& out, std::uint32_t code_point)
+{
+  if (code_point < 0x80) {
+    out += static_cast<char>(code_point);
+  } else if (code_point < 0x800) {
+    out += static_cast<char>(0xc0 | (code_point >> 6U));
+    out += static_cast<char>(0x80 | (code_point & 0x3fU));
+  } else if (code_point < 0x10000) {
+    out += static_cast<char>(0xe0 | (code_point >> 12U));
+    out += static_cast<char>(0x80 | ((code_point >> 6U) & 0x3fU));
+    out += static_cast<char>(0x80 | (code_point & 0x3fU));
+  } else {
+    out += static_cast<char>(0xf0 | (code_point >> 18U));
+    out += static_cast<char>(0x80 | ((code_point >> 12U) & 0x3fU));
+    out += static_cast<char>(0x80 | ((code_point >> 6U) & 0x3fU));
+    out += static_cast<char>(0x80 | (code_point & 0x3fU));
+  }
+}
+
+/**
+ * Removes the members that are followed by a member with the same name. Names are compared
+ * unescaped, but only objects that contain escaped names pay for unescaping them.
+ */
+void
+remove_duplicate_members(std::vector<value>& members)
+{
+  if (members.size() < 2) {
+    return;
+  }
+  std::deque<std::string> unescaped_names{};
+  std::vector<std::string_view> names{};
+  names.reserve(members.size());
+  for (const auto& member : members) {
+    if (member.key().find('\\') == std::string_view::npos) {
+      names.push_back(member.key());
+    } else {
+      names.emplace_back(unescaped_names.emplace_back(member.get_key()));
+    }
+  }
+
+  bool has_duplicates = false;
+  if (members.size() <= small_object_size) {
+    for (std::size_t i = 0; i < names.size() && !has_duplicates; ++i) {
+      for (std::size_t j = i + 1; j < names.size(); ++j) {
+        if (names[i] == names[j]) {
+          has_duplicates = true;
+          break;
+        }
+      }
+    }
+  } else {
+    std::unordered_set<std::string_view> seen{};
+    seen.reserve(names.size());
+    for (const auto& name : names) {
+      if (!seen.insert(name).second) {
+        has_duplicates = true;
+        break;
+      }
+    }
+  }
+  if (!has_duplicates) {
+    return;
+  }
+
+  std::unordered_set<std::string_view> kept{};
+  std::vector<value> result{};
+  for (std::size_t i = members.size(); i-- > 0;) {
+    if (kept.insert(names[i]).second) {
+      result.push_back(std::move(members[i]));
+    }
+  }
+  std::reverse(result.begin(), result.end());
+  members = std::move(result);
+}
+
+class parser
+{
+public:
+  explicit parser(std::string_view input)
+    : input_{ input }
+  {
+  }
+
+  auto run() -> std::pair<error, value>
+  {
+    value result{};
+    skip_whitespace();
+    if (parse_value(result, 0)) {
+      skip_whitespace();
+      if (pos_ == input_.size()) {
+        return { error{}, std::move(result) };
+      }
+      message_ = "unexpected characters after the value";
+    }
+    return {
+      error{ errc::common::parsing_failure,
+             fmt::format("Failed to parse JSON at offset {}: {}", pos_, message_) },
+      {},
+    };
+  }
+
+private:
+  auto fail(const char* message) -> bool
+  {
+    message_ = message;
+    return false;
+  }
+
+  [[nodiscard]] auto at_end() const -> bool
+  {
+    return pos_ >= input_.size();
+  }
+
+  [[nodiscard]] auto peek() const -> char
+  {
+    return input_[pos_];
+  }
+
+  void skip_whitespace()
+  {
+    while (!at_end() && (peek() == ' ' || peek() == '\n' || peek() == '\r' || peek() == '\t')) {
+      ++pos_;
+    }
+  }
+
+  auto consume(char c) -> bool
+  {
+    if (!at_end() && peek() == c) {
+      ++pos_;
+      return true;
+    }
+    return false;
+  }
+
+  auto parse_value(value& out, std::size_t depth) -> bool
+  {
+    if (at_end()) {
+      return fail("unexpected end of input");
+    }
+    switch (peek()) {
+      case '{':
+        return parse_object(out, depth + 1);
+      case '[':
+        return parse_array(out, depth + 1);
+      case '"': {
+        std::string_view text{};
+        bool escaped = false;
+        if (!parse_string(text, escaped)) {
+          return false;
+        }
+        out = value::make_escaped_string(text);
+        return true;
+      }
+      case 'n':
+        return parse_literal(literal_null, out);
+      case 't':
+        return parse_literal(literal_true, out);
+      case 'f':
+        return parse_literal(literal_false, out);
+      default:
+        return parse_number(out);
+    }
+  }
+
+  auto parse_literal(std::string_view literal, value& out) -> bool
+  {
+    if (input_.substr(pos_, literal.size()) != literal) {
+      return fail("invalid literal");
+    }
+    pos_ += literal.size();
+    out =
+      literal == literal_null ? value::make_null() : value::make_boolean(literal == literal_true);
+    return true;
+  }
+
+  auto parse_number(value& out) -> bool
+  {
+    const auto start = pos_;
+    consume('-');
+    if (consume('0')) {
+      // no leading zeros
+    } else if (!at_end() && is_digit(peek())) {
+      skip_digits();
+    } else {
+      return fail("invalid value");
+    }
+    if (consume('.')) {
+      if (at_end() || !is_digit(peek())) {
+        return fail("expected digits after the decimal point");
+      }
+      skip_digits();
+    }
+    if (consume('e') || consume('E')) {
+      if (!consume('+')) {
+        consume('-');
+      }
+      if (at_end() || !is_digit(peek())) {
+        return fail("expected digits in the exponent");
+      }
+      skip_digits();
+    }
+    out = value::make_number(input_.substr(start, pos_ - start));
+    return true;
+  }
+
+  void skip_digits()
+  {
+    while (!at_end() && is_digit(peek())) {
+      ++pos_;
+    }
+  }
+
+  auto parse_string(std::string_view& text, bool& escaped) -> bool
+  {
+    ++pos_; // opening quote
+    const auto start = pos_;
+    while (!at_end()) {
+      const auto c = static_cast<unsigned char>(peek());
+      if (c == '"') {
+        text = input_.substr(start, pos_ - start);
+        ++pos_;
+        return true;
+      }
+      if (c == '\\') {
+        escaped = true;
+        if (!parse_escape()) {
+          return false;
+        }
+      } else if (c < 0x20) {
+        return fail("unescaped control character in string");
+      } else if (c >= 0x80) {
+        if (!parse_utf8_sequence()) {
+          return false;
+        }
+      } else {
+        ++pos_;
+      }
+    }
+    return fail("unterminated string");
+  }
+
+  auto parse_escape() -> bool
+  {
+    ++pos_; // backslash
+    if (at_end()) {
+      return fail("unterminated string");
+    }
+    switch (peek()) {
+      case '"':
+      case '\\':
+      case '/':
+      case 'b':
+      case 'f':
+      case 'n':
+      case 'r':
+      case 't':
+        ++pos_;
+        return true;
+      case 'u':
+        break;
+      default:
+        return fail("invalid escape sequence");
+    }
+    std::uint32_t code_unit = 0;
+    if (!parse_code_unit(code_unit)) {
+      return false;
+    }
+    if (code_unit >= 0xdc00 && code_unit <= 0xdfff) {
+      return fail("unpaired surrogate in escape sequence");
+    }
+    if (code_unit >= 0xd800 && code_unit <= 0xdbff) {
+      std::uint32_t low = 0;
+      if (!consume('\\') || at_end() || peek() != 'u' || !parse_code_unit(low) || low < 0xdc00 ||
+          low > 0xdfff) {
+        return fail("unpaired surrogate in escape sequence");
+      }
+    }
+    return true;
+  }
+
+  /// Parses the four hex digits of a \u escape, with the position at the `u`
+  auto parse_code_unit(std::uint32_t& code_unit) -> bool
+  {
+    ++pos_;
+    if (input_.size() - pos_ < 4) {
+      return fail("invalid unicode escape sequence");
+    }
+    code_unit = 0;
+    for (int i = 0; i < 4; ++i) {
+      const auto digit = hex_value(input_[pos_++]);
+      if (digit < 0) {
+        return fail("invalid unicode escape sequence");
+      }
+      code_unit = (code_unit << 4U) | static_cast<std::uint32_t>(digit);
+    }
+    return true;
+  }
+
+  auto parse_utf8_sequence() -> bool
+  {
+    const auto lead = static_cast<unsigned char>(peek());
+    std::size_t continuation_bytes = 0;
+    unsigned char min_second = 0x80;
+    unsigned char max_second = 0xbf;
+    if (lead >= 0xc2 && lead <= 0xdf) {
+      continuation_bytes = 1;
+    } else if (lead >= 0xe0 && lead <= 0xef) {
+      continuation_bytes = 2;
+      min_second = lead == 0xe0 ? 0xa0 : 0x80;
+      max_second = lead == 0xed ? 0x9f : 0xbf;
+    } else if (lead >= 0xf0 && lead <= 0xf4) {
+      continuation_bytes = 3;
+      min_second = lead == 0xf0 ? 0x90 : 0x80;
+      max_second = lead == 0xf4 ? 0x8f : 0xbf;
+    } else {
+      return fail("invalid UTF-8 in string");
+    }
+    if (input_.size() - pos_ <= continuation_bytes) {
+      return fail("invalid UTF-8 in string");
+    }
+    for (std::size_t i = 1; i <= continuation_bytes; ++i) {
+      const auto c = static_cast<unsigned char>(input_[pos_ + i]);
+      const auto min = i == 1 ? min_second : 0x80;
+      const auto max = i == 1 ? max_second : 0xbf;
+      if (c < min || c > max) {
+        return fail("invalid UTF-8 in string");
+      }
+    }
+    pos_ += continuation_bytes + 1;
+    return true;
+  }
+
+  auto parse_array(value& out, std::size_t depth) -> bool
+  {
+    if (depth > max_depth) {
+      return fail("document is nested too deeply");
+    }
+    ++pos_; // [
+    out = value::make_array();
+    skip_whitespace();
+    if (consume(']')) {
+      return true;
+    }
+    while (true) {
+      skip_whitespace();
+      auto& element = out.children().emplace_back();
+      if (!parse_value(element, depth)) {
+        return false;
+      }
+      skip_whitespace();
+      if (consume(']')) {
+        return true;
+      }
+      if (!consume(',')) {
+        return fail("expected ',' or ']' after array element");
+      }
+    }
+  }
+
+  auto parse_object(value& out, std::size_t depth) -> bool
+  {
+    if (depth > max_depth) {
+      return fail("document is nested too deeply");
+    }
+    ++pos_; // {
+    out = value::make_object();
+    skip_whitespace();
+    if (consume('}')) {
+      return true;
+    }
+    while (true) {
+      skip_whitespace();
+      if (at_end() || peek() != '"') {
+        return fail("expected member name");
+      }
+      std::string_view key{};
+      bool key_escaped = false;
+      if (!parse_string(key, key_escaped)) {
+        return false;
+      }
+      skip_whitespace();
+      if (!consume(':')) {
+        return fail("expected ':' after member name");
+      }
+      skip_whitespace();
+      auto& member = out.children().emplace_back();
+      if (!parse_value(member, depth)) {
+        return false;
+      }
+      member.set_escaped_key(key, key_escaped);
+      skip_whitespace();
+      if (consume('}')) {
+        remove_duplicate_members(out.children());
+        return true;
+      }
+      if (!consume(',')) {
+        return fail("expected ',' or '}' after object member");
+      }
+    }
+  }
+
+  std::string_view input_;
+  std::size_t pos_{ 0 };
+  const char* message_{ "" };
+};
+
+auto
+write_text(std::byte* out, std::string_view text) -> std::byte*
+{
+  if (!text.empty()) {
+    std::memcpy(out, text.data(), text.size());
+  }
+  return out + text.size();
+}
+
+auto
+write_char(std::byte* out, char c) -> std::byte*
+{
+  *out = static_cast<std::byte>(c);
+  return out + 1;
+}
+
+auto
+write_value(const value& v, std::byte* out) -> std::byte*
+{
+  switch (v.type()) {
+    case value_type::null:
+      return write_text(out, literal_null);
+    case value_type::boolean:
+    case value_type::number:
+      return write_text(out, v.text());
+    case value_type::string:
+      out = write_char(out, '"');
+      out = write_text(out, v.text());
+      return write_char(out, '"');
+    case value_type::binary:
+      break;
+    case value_type::array:
+    case value_type::object: {
+      const bool object = v.is_object();
+      out = write_char(out, object ? '{' : '[');
+      bool first = true;
+      for (const auto& child : v.children()) {
+        if (!first) {
+          out = write_char(out, ',');
+        }
+        first = false;
+        if (object) {
+          out = write_char(out, '"');
+          out = write_text(out, child.key());
+          out = write_char(out, '"');
+          out = write_char(out, ':');
+        }
+        out = write_value(child, out);
+      }
+      return write_char(out, object ? '}' : ']');
+    }
+  }
+  throw std::runtime_error("binary data invalid for JSON string representation");
+}
+} // namespace
+
+auto
+arena::store(std::string text) -> std::string_view
+{
+  return strings_.emplace_back(std::move(text));
+}
+
+auto
+arena::store(const std::vector<std::byte>& bytes) -> std::string_view
+{
+  return strings_.emplace_back(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+void
+arena::clear()
+{
+  strings_.clear();
+}
+
+auto
+value::make_null() -> value
+{
+  return {};
+}
+
+auto
+value::make_boolean(bool b) -> value
+{
+  value v{};
+  v.type_ = value_type::boolean;
+  v.text_ = b ? literal_true : literal_false;
+  return v;
+}
+
+auto
+value::make_number(std::string_view text) -> value
+{
+  value v{};
+  v.type_ = value_type::number;
+  v.text_ = text;
+  return v;
+}
+
+auto
+value::make_array() -> value
+{
+  value v{};
+  v.type_ = value_type::array;
+  return v;
+}
+
+auto
+value::make_object() -> value
+{
+  value v{};
+  v.type_ = value_type::object;
+  return v;
+}
+
+auto
+value::make_escaped_string(std::string_view text) -> value
+{
+  value v{};
+  v.type_ = value_type::string;
+  v.text_ = text;
+  v.escaped_ = text.find('\\') != std::string_view::npos;
+  return v;
+}
+
+auto
+value::make_string(std::string_view s, arena& strings) -> value
+{
+  return make_escaped_string(strings.store(needs_escaping(s) ? escape(s) : std::string{ s }));
+}
+
+auto
+value::make_binary(std::string_view bytes) -> value
+{
+  value v{};
+  v.type_ = value_type::binary;
+  v.text_ = bytes;
+  return v;
+}
+
+auto
+value::get_string() const -> std::string
+{
+  return escaped_ ? unescape(text_) : std::string{ text_ };
+}
+
+auto
+value::get_key() const -> std::string
+{
+  return key_escaped_ ? unescape(key_) : std::string{ key_ };
+}
+
+auto
+value::has_key(std::string_view name) const -> bool
+{
+  return key_escaped_ ? unescape(key_) == name : key_ == name;
+}
+
+void
+value::set_key(std::string_view name, arena& strings)
+{
+  const bool escaped = needs_escaping(name);
+  key_ = strings.store(escaped ? escape(name) : std::string{ name });
+  key_escaped_ = escaped;
+}
+
+void
+value::set_escaped_key(std::string_view key, bool escaped)
+{
+  key_ = key;
+  key_escaped_ = escaped;
+}
+
+auto
+value::find(std::string_view name) -> value*
+{
+  for (auto& child : children_) {
+    if (child.has_key(name)) {
+      return &child;
+    }
+  }
+  return nullptr;
+}
+
+auto
+value::find(std::string_view name) const -> const value*
+{
+  for (const auto& child : children_) {
+    if (child.has_key(name)) {
+      return &child;
+    }
+  }
+  return nullptr;
+}
+
+auto
+value::insert(std::string_view name, value v, arena& strings) -> value&
+{
+  if (auto* existing = find(name); existing != nullptr) {
+    const auto key = existing->key_;
+    const auto key_escaped = existing->key_escaped_;
+    *existing = std::move(v);
+    existing->set_escaped_key(key, key_escaped);
+    return *existing;
+  }
+  auto& member = children_.emplace_back(std::move(v));
+  member.set_key(name, strings);
+  return member;
+}
+
+auto
+value::erase(std::string_view name) -> bool
+{
+  const auto it = std::find_if(children_.begin(), children_.end(), [name](const value& child) {
+    return child.has_key(name);
+  });
+  if (it == children_.end()) {
+    return false;
+  }
+  children_.erase(it);
+  return true;
+}
+
+auto
+value::clone(arena& strings) const -> value
+{
+  value copy{};
+  copy.type_ = type_;
+  copy.escaped_ = escaped_;
+  copy.key_escaped_ = key_escaped_;
+  if (type_ == value_type::null || type_ == value_type::boolean) {
+    copy.text_ = text_;
+  } else if (!text_.empty()) {
+    copy.text_ = strings.store(std::string{ text_ });
+  }
+  if (!key_.empty()) {
+    copy.key_ = strings.store(std::string{ key_ });
+  }
+  copy.children_.reserve(children_.size());
+  for (const auto& child : children_) {
+    copy.children_.push_back(child.clone(strings));
+  }
+  return copy;
+}
+
+auto
+value::operator==(const value& other) const -> bool
+{
+  return type_ == other.type_ && text_ == other.text_ && key_ == other.key_ &&
+         children_ == other.children_;
+}
+
+auto
+parse(std::string_view input) -> std::pair<error, value>
+{
+  return parser{ input }.run();
+}
+
+auto
+parse(const std::vector<std::byte>& input) -> std::pair<error, value>
+{
+  return parse(std::string_view{ reinterpret_cast<const char*>(input.data()), input.size() });
+}
+
+auto
+generated_size(const value& v) -> std::size_t
+{
+  switch (v.type()) {
+    case value_type::null:
+      return literal_null.size();
+    case value_type::boolean:
+    case value_type::number:
+    case value_type::binary:
+      return v.text().size();
+    case value_type::string:
+      return v.text().size() + 2;
+    case value_type::array:
+    case value_type::object:
+      break;
+  }
+  const auto& children = v.children();
+  // brackets and separators
+  std::size_t size = 2 + (children.empty() ? 0 : children.size() - 1);
+  for (const auto& child : children) {
+    if (v.is_object()) {
+      // quotes and colon
+      size += child.key().size() + 3;
+    }
+    size += generated_size(child);
+  }
+  return size;
+}
+
+void
+generate(const value& v, std::vector<std::byte>& output)
+{
+  const auto offset = output.size();
+  const auto size = offset + generated_size(v);
+  if (size > output.capacity()) {
+    // a buffer that is reused for many values is not reallocated for each of them
+    output.reserve(std::max(size, output.capacity() * 2));
+  }
+  output.resize(size);
+  write_value(v, output.data() + offset);
+}
+
+auto
+generate(const value& v) -> std::vector<std::byte>
+{
+  std::vector<std::byte> output{};
+  generate(v, output);
+  return output;
+}
+
+auto
+escape(std::string_view s) -> std::string
+{
+  static constexpr std::string_view hex_digits{ "0123456789abcdef" };
+
+  std::string out{};
+  out.reserve(s.size() + 2);
+  for (const auto c : s) {
+    switch (c) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\b':
+        out += "\\b";
+        break;
+      case '\f':
+        out += "\\f";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\r':
+        out += "\\r";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20 || c == 0x7f) {
+          out += "\\u00";
+          out += hex_digits[(static_cast<unsigned char>(c) & 0xf0U) >> 4U];
+          out += hex_digits[static_cast<unsigned char>(c) & 0x0fU];
+        } else {
+          out += c;
+        }
+    }
+  }
+  return out;
+}
+
+auto
+unescape(std::string_view text) -> std::string
+{
+  const auto code_unit_at = [text](std::size_t pos) {
+    std::uint32_t code_unit = 0;
+    for (std::size_t i = 0; i < 4; ++i) {
+      code_unit = (code_unit << 4U) | static_cast<std::uint32_t>(hex_value(text[pos + i]));
+    }
+    return code_unit;
+  };
+
+  std::string out{};
+  out.reserve(text.size());
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    if (text[i] != '\\' || i + 1 == text.size()) {
+      out += text[i];
+      continue;
+    }
+    switch (text[++i]) {
+      case 'b':
+        out += '\b';
+        break;
+      case 'f':
+        out += '\f';
+        break;
+      case 'n':
+        out += '\n';
+        break;
+      case 'r':
+        out += '\r';
+        break;
+      case 't':
+        out += '\t';
+        break;
+      case 'u': {
+        // the parser only accepts complete escapes with paired surrogates
+        auto code_point = code_unit_at(i + 1);
+        i += 4;
+        if (code_point >= 0xd800 && code_point <= 0xdbff && i + 6 < text.size()) {
+          const auto low = code_unit_at(i + 3);
+          code_point = 0x10000 + ((code_point - 0xd800) << 10U) + (low - 0xdc00);
+          i += 6;
+        }
+        append_utf8(out, code_point);
+        break;
+      }
+      default:
+        out += text[i];
+    }
+  }
+  return out;
+}
+} // namespace couchbase::crypto::impl::utils::flat_json
@@ -0,0 +1,213 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#pragma once
+
+#include <couchbase/error.hxx>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * A JSON document model for the transcoder, which only needs to find, replace and move a few
+ * members of otherwise opaque documents.
+ *
+ * Objects keep their members in a vector, in the order they appear in the document. Scalars are
+ * not decoded: strings and numbers refer to their text in the input, which is copied to the output
+ * as-is, and strings are only unescaped when their value is needed. The input, and every string
+ * stored in the arena of the document, must outlive the values that refer to them.
+ */
+namespace couchbase::crypto::impl::utils::flat_json
+{
+enum class value_type : std::uint8_t {
+  null,
+  boolean,
+  number,
+  string,
+  binary,
+  array,
+  object,
+};
+
+/**
+ * Owns the text of strings that were not part of the parsed input, e.g. mangled keys, encrypted
+ * nodes and decrypted plaintexts.
+ */
+class arena
+{
+public:
+  auto store(std::string text) -> std::string_view;
+
+  auto store(const std::vector<std::byte>& bytes) -> std::string_view;
+
+  void clear();
+
+private:
+  std::deque<std::string> strings_{};
+};
+
+class value
+{
+public:
+  value() = default;
+
+  static auto make_null() -> value;
+  static auto make_boolean(bool b) -> value;
+  static auto make_number(std::string_view text) -> value;
+  static auto make_array() -> value;
+  static auto make_object() -> value;
+
+  /// Creates a string from its JSON-escaped text, without the quotes
+  static auto make_escaped_string(std::string_view text) -> value;
+
+  /// Creates a string from its value, escaping it into the arena if needed
+  static auto make_string(std::string_view s, arena& strings) -> value;
+
+  /// Creates binary data, which can only be stored in binary document formats
+  static auto make_binary(std::string_view bytes) -> value;
+
+  [[nodiscard]] auto type() const -> value_type
+  {
+    return type_;
+  }
+
+  [[nodiscard]] auto is_object() const -> bool
+  {
+    return type_ == value_type::object;
+  }
+
+  [[nodiscard]] auto is_array() const -> bool
+  {
+    return type_ == value_type::array;
+  }
+
+  [[nodiscard]] auto is_string() const -> bool
+  {
+    return type_ == value_type::string;
+  }
+
+  [[nodiscard]] auto is_binary() const -> bool
+  {
+    return type_ == value_type::binary;
+  }
+
+  /// The JSON text of a number, the escaped text of a string, or the bytes of binary data
+  [[nodiscard]] auto text() const -> std::string_view
+  {
+    return text_;
+  }
+
+  [[nodiscard]] auto get_boolean() const -> bool
+  {
+    return text_ == "true";
+  }
+
+  /// The unescaped value of a string
+  [[nodiscard]] auto get_string() const -> std::string;
+
+  /// The members of an object, or the elements of an array
+  [[nodiscard]] auto children() -> std::vector<value>&
+  {
+    return children_;
+  }
+
+  [[nodiscard]] auto children() const -> const std::vector<value>&
+  {
+    return children_;
+  }
+
+  /// The escaped name of this value, if it is a member of an object
+  [[nodiscard]] auto key() const -> std::string_view
+  {
+    return key_;
+  }
+
+  /// The unescaped name of this value, if it is a member of an object
+  [[nodiscard]] auto get_key() const -> std::string;
+
+  [[nodiscard]] auto has_key(std::string_view name) const -> bool;
+
+  /// Renames this member, escaping the name into the arena if needed
+  void set_key(std::string_view name, arena& strings);
+
+  void set_escaped_key(std::string_view key, bool escaped);
+
+  /// Returns the member of the object with the given (unescaped) name, or null if there is none
+  [[nodiscard]] auto find(std::string_view name) -> value*;
+
+  [[nodiscard]] auto find(std::string_view name) const -> const value*;
+
+  /// Appends a member to the object, or replaces the member with the same name
+  auto insert(std::string_view name, value v, arena& strings) -> value&;
+
+  auto erase(std::string_view name) -> bool;
+
+  /// Copies this value, storing the strings it refers to in the given arena
+  [[nodiscard]] auto clone(arena& strings) const -> value;
+
+  auto operator==(const value& other) const -> bool;
+
+  auto operator!=(const value& other) const -> bool
+  {
+    return !(*this == other);
+  }
+
+private:
+  value_type type_{ value_type::null };
+  bool escaped_{ false };
+  bool key_escaped_{ false };
+  std::string_view text_{};
+  std::string_view key_{};
+  std::vector<value> children_{};
+};
+
+/**
+ * Parses the given JSON text. The returned value refers to the input, which must outlive it.
+ * Duplicate member names are resolved by keeping the last member, as the server does.
+ */
+auto
+parse(std::string_view input) -> std::pair<error, value>;
+
+auto
+parse(const std::vector<std::byte>& input) -> std::pair<error, value>;
+
+/**
+ * Returns the exact size of the JSON text generate() produces for the given value.
+ */
+auto
+generated_size(const value& v) -> std::size_t;
+
+/**
+ * Appends the JSON text of the given value to the output, which is resized once, to the size
+ * computed by generated_size(). The capacity of the output at least doubles when it is exceeded, so
+ * appending many values to the same buffer takes linear time. Binary data cannot be represented in
+ * JSON, and results in std::runtime_error.
+ */
+void
+generate(const value& v, std::vector<std::byte>& output);
+
+auto
+generate(const value& v) -> std::vector<std::byte>;
+
+/**
+ * Escapes the given string for a JSON string literal, without the quotes.
+ */
+auto
+escape(std::string_view s) -> std::string;
+
+/**
+ * Unescapes the text of a JSON string literal, without the quotes.
+ */
+auto
+unescape(std::string_view text) -> std::string;
+} // namespace couchbase::crypto::impl::utils::flat_json
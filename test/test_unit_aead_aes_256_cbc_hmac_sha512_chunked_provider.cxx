@@ -0,0 +1,194 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include "test_helper.hxx"
+
+#include <couchbase/error_codes.hxx>
+#include <couchbase_encryption/aead_aes_256_cbc_hmac_sha512_chunked_provider.hxx>
+#include <couchbase_encryption/crypto_executor.hxx>
+#include <couchbase_encryption/insecure_keyring.hxx>
+
+#include <future>
+#include <string>
+
+namespace
+{
+auto
+make_plaintext(std::size_t size) -> std::vector<std::byte>
+{
+  std::vector<std::byte> plaintext(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    plaintext[i] = static_cast<std::byte>(i * 31 + 7);
+  }
+  return plaintext;
+}
+
+auto
+make_keyring() -> std::shared_ptr<couchbase::crypto::insecure_keyring>
+{
+  auto keyring = std::make_shared<couchbase::crypto::insecure_keyring>();
+  keyring->add_key(couchbase::crypto::key("test-key", std::vector<std::byte>(64, std::byte{ 7 })));
+  keyring->add_key(couchbase::crypto::key("invalid-key", std::vector<std::byte>(3)));
+  return keyring;
+}
+
+auto
+with_member(const couchbase::crypto::encryption_result& encrypted,
+            const std::string& name,
+            std::string value) -> couchbase::crypto::encryption_result
+{
+  auto members = encrypted.as_map();
+  members[name] = std::move(value);
+  return couchbase::crypto::encryption_result{ std::move(members) };
+}
+} // namespace
+
+TEST_CASE("unit: aead_aes_256_cbc_hmac_sha512_chunked_provider", "[unit]")
+{
+  const auto keyring = make_keyring();
+
+  SECTION("encrypt & decrypt")
+  {
+    auto executor = std::make_shared<couchbase::crypto::crypto_executor>(
+      couchbase::crypto::crypto_executor_options{ 3 });
+    for (const auto& executor_used : { std::shared_ptr<couchbase::crypto::crypto_executor>{},
+                                       executor }) {
+      for (const std::size_t chunk_size : { 1, 16, 17, 1000 }) {
+        const couchbase::crypto::aead_aes_256_cbc_hmac_sha512_chunked_provider provider{
+          keyring, { chunk_size, executor_used }
+        };
+        const auto encrypter = provider.encrypter_for_key("test-key");
+        const auto decrypter = provider.decrypter();
+        for (const std::size_t size : { 0, 1, 15, 16, 17, 999, 1000, 1001, 5000 }) {
+          const auto plaintext = make_plaintext(size);
+          const auto [enc_err, enc_result] = encrypter->encrypt(plaintext);
+          REQUIRE_NO_ERROR(enc_err);
+          REQUIRE(enc_result.algorithm() == "AEAD_AES_256_CBC_HMAC_SHA512_CHUNKED");
+          REQUIRE(enc_result.get("kid") == std::make_optional("test-key"));
+          REQUIRE(enc_result.get("chunk") == std::make_optional(std::to_string(chunk_size)));
+
+          const auto placeholder = encrypter->placeholder(size);
+          REQUIRE(placeholder.has_value());
+          REQUIRE(placeholder->get("ciphertext")->size() == enc_result.get("ciphertext")->size());
+
+          const auto [dec_err, dec_result] = decrypter->decrypt(enc_result);
+          REQUIRE_NO_ERROR(dec_err);
+          REQUIRE(plaintext == dec_result);
+        }
+      }
+    }
+  }
+
+  SECTION("large values")
+  {
+    auto executor = std::make_shared<couchbase::crypto::crypto_executor>(
+      couchbase::crypto::crypto_executor_options{ 3 });
+    const couchbase::crypto::aead_aes_256_cbc_hmac_sha512_chunked_provider provider{
+      keyring, { 64 * 1024, executor }
+    };
+    const auto plaintext = make_plaintext(1024 * 1024 + 1);
+    const auto [enc_err, enc_result] = provider.encrypter_for_key("test-key")->encrypt(plaintext);
+    REQUIRE_NO_ERROR(enc_err);
+    const auto [dec_err, dec_result] = provider.decrypter()->decrypt(enc_result);
+    REQUIRE_NO_ERROR(dec_err);
+    REQUIRE(plaintext == dec_result);
+  }
+
+  SECTION("chunks are decrypted with the chunk size they were encrypted with")
+  {
+    const couchbase::crypto::aead_aes_256_cbc_hmac_sha512_chunked_provider small_chunks{ keyring,
+                                                                                        { 100 } };
+    const couchbase::crypto::aead_aes_256_cbc_hmac_sha512_chunked_provider large_chunks{ keyring };
+    const auto plaintext = make_plaintext(1000);
+    const auto [enc_err, enc_result] =
+      small_chunks.encrypter_for_key("test-key")->encrypt(plaintext);
+    REQUIRE_NO_ERROR(enc_err);
+    const auto [dec_err, dec_result] = large_chunks.decrypter()->decrypt(enc_result);
+    REQUIRE_NO_ERROR(dec_err);
+    REQUIRE(plaintext == dec_result);
+  }
+
+  SECTION("a task of the executor can use the executor")
+  {
+    auto executor = std::make_shared<couchbase::crypto::crypto_executor>(
+      couchbase::crypto::crypto_executor_options{ 1 });
+    const couchbase::crypto::aead_aes_256_cbc_hmac_sha512_chunked_provider provider{
+      keyring, { 16, executor }
+    };
+    const auto plaintext = make_plaintext(1000);
+    auto barrier = std::make_shared<std::promise<std::vector<std::byte>>>();
+    auto future = barrier->get_future();
+    executor->post([&provider, &plaintext, barrier] {
+      std::vector<std::byte> decrypted{};
+      {
+        // the encrypter and decrypter share the executor, and must be gone by the time the test
+        // releases it
+        const auto [enc_err, enc_result] =
+          provider.encrypter_for_key("test-key")->encrypt(plaintext);
+        if (!enc_err) {
+          decrypted = provider.decrypter()->decrypt(enc_result).second;
+        }
+      }
+      barrier->set_value(std::move(decrypted));
+    });
+    REQUIRE(future.get() == plaintext);
+  }
+
+  SECTION("segments cannot be reordered, dropped or swapped between values")
+  {
+    // with 32 byte chunks, every segment is 96 bytes, or 128 base64 characters
+    constexpr std::size_t segment_length{ 128 };
+    const couchbase::crypto::aead_aes_256_cbc_hmac_sha512_chunked_provider provider{ keyring,
+                                                                                    { 32 } };
+    const auto encrypter = provider.encrypter_for_key("test-key");
+    const auto decrypter = provider.decrypter();
+    const auto [err, encrypted] = encrypter->encrypt(make_plaintext(96));
+    REQUIRE_NO_ERROR(err);
+    const auto [other_err, other] = encrypter->encrypt(make_plaintext(96));
+    REQUIRE_NO_ERROR(other_err);
+    const auto ciphertext = encrypted.get("ciphertext").value();
+    const auto other_ciphertext = other.get("ciphertext").value();
+    REQUIRE(ciphertext.size() == 3 * segment_length);
+
+    const auto reordered = ciphertext.substr(0, segment_length) +
+                           ciphertext.substr(2 * segment_length) +
+                           ciphertext.substr(segment_length, segment_length);
+    const auto truncated = ciphertext.substr(0, 2 * segment_length);
+    const auto swapped = ciphertext.substr(0, segment_length) +
+                         other_ciphertext.substr(segment_length, segment_length) +
+                         ciphertext.substr(2 * segment_length);
+    for (const auto& tampered : { reordered, truncated, swapped }) {
+      const auto [dec_err, dec_result] =
+        decrypter->decrypt(with_member(encrypted, "ciphertext", tampered));
+      REQUIRE(dec_err.ec() == couchbase::errc::field_level_encryption::decryption_failure);
+    }
+
+    const auto [chunk_err, chunk_result] =
+      decrypter->decrypt(with_member(encrypted, "chunk", "16"));
+    REQUIRE(chunk_err);
+
+    const auto [b64_err, b64_result] =
+      decrypter->decrypt(with_member(encrypted, "ciphertext", ciphertext.substr(1)));
+    REQUIRE(b64_err.ec() == couchbase::errc::field_level_encryption::invalid_ciphertext);
+  }
+
+  SECTION("invalid options and keys")
+  {
+    const couchbase::crypto::aead_aes_256_cbc_hmac_sha512_chunked_provider no_chunks{ keyring,
+                                                                                     { 0 } };
+    const auto [chunk_err, chunk_result] =
+      no_chunks.encrypter_for_key("test-key")->encrypt(make_plaintext(10));
+    REQUIRE(chunk_err.ec() == couchbase::errc::field_level_encryption::encryption_failure);
+    REQUIRE_FALSE(no_chunks.encrypter_for_key("test-key")->placeholder(10).has_value());
+
+    const couchbase::crypto::aead_aes_256_cbc_hmac_sha512_chunked_provider provider{ keyring };
+    const auto [key_err, key_result] =
+      provider.encrypter_for_key("invalid-key")->encrypt(make_plaintext(10));
+    REQUIRE(key_err.ec() == couchbase::errc::field_level_encryption::invalid_crypto_key);
+  }
+}
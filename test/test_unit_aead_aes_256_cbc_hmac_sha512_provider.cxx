@@ -61,11 +61,42 @@ TEST_CASE("unit: aead_aes_256_cbc_hmac_sha512_provider", "[unit]")
     REQUIRE(enc_result.algorithm() == "AEAD_AES_256_CBC_HMAC_SHA512");
     REQUIRE(enc_result.get("kid") == std::make_optional("test-key"));
     REQUIRE(enc_result.get("ciphertext").has_value());
+    REQUIRE(enc_result.algorithm_ref() == enc_result.algorithm());
+    REQUIRE(enc_result.map_ref() == enc_result.as_map());
 
     const auto decrypter = provider.decrypter();
     const auto [dec_err, dec_result] = decrypter->decrypt(enc_result);
     REQUIRE_NO_ERROR(dec_err);
     REQUIRE(plaintext == dec_result);
+
+    auto moved_from = enc_result;
+    REQUIRE(std::move(moved_from).take_map() == enc_result.as_map());
+  }
+
+  SECTION("rotated keys are set up again")
+  {
+    auto rotating_keyring = std::make_shared<couchbase::crypto::insecure_keyring>();
+    rotating_keyring->add_key(couchbase::crypto::key("test-key", KEY));
+    const auto rotating_provider =
+      couchbase::crypto::aead_aes_256_cbc_hmac_sha512_provider(rotating_keyring);
+    const auto encrypter = rotating_provider.encrypter_for_key("test-key");
+    const auto decrypter = rotating_provider.decrypter();
+
+    const auto [old_err, old_result] = encrypter->encrypt(plaintext);
+    REQUIRE_NO_ERROR(old_err);
+    REQUIRE(decrypter->decrypt(old_result).second == plaintext);
+
+    auto rotated_key = KEY;
+    rotated_key[0] = std::byte{ 0xff };
+    rotating_keyring->add_key(couchbase::crypto::key("test-key", rotated_key));
+
+    const auto [new_err, new_result] = encrypter->encrypt(plaintext);
+    REQUIRE_NO_ERROR(new_err);
+    const auto [dec_err, dec_result] = decrypter->decrypt(new_result);
+    REQUIRE_NO_ERROR(dec_err);
+    REQUIRE(plaintext == dec_result);
+    REQUIRE(decrypter->decrypt(old_result).first.ec() ==
+            couchbase::errc::field_level_encryption::decryption_failure);
   }
 
   SECTION("encrypt missing key")
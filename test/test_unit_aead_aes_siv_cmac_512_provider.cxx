@@ -0,0 +1,233 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include "src/crypto/aes_siv.hxx"
+#include "test_helper.hxx"
+
+#include <couchbase/error_codes.hxx>
+#include <couchbase_encryption/aead_aes_siv_cmac_512_provider.hxx>
+#include <couchbase_encryption/insecure_keyring.hxx>
+
+const auto KEY = test::utils::make_bytes({
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+  0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f,
+  0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f,
+  0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0x3e, 0x3f,
+});
+
+TEST_CASE("unit: aead_aes_siv_cmac_512_provider", "[unit]")
+{
+  auto keyring = std::make_shared<couchbase::crypto::insecure_keyring>();
+  keyring->add_key(couchbase::crypto::key("test-key", KEY));
+  keyring->add_key(
+    couchbase::crypto::key("other-key", std::vector<std::byte>(KEY.rbegin(), KEY.rend())));
+  keyring->add_key(couchbase::crypto::key("invalid-key",
+                                          test::utils::make_bytes({
+                                            0x00,
+                                            0x01,
+                                            0x02,
+                                          })));
+
+  const auto provider = couchbase::crypto::aead_aes_siv_cmac_512_provider(std::move(keyring));
+
+  const auto plaintext = test::utils::make_bytes({
+    0x22, 0x54, 0x68, 0x65, 0x20, 0x65, 0x6e, 0x65, 0x6d, 0x79, 0x20, 0x6b, 0x6e, 0x6f, 0x77,
+    0x73, 0x20, 0x74, 0x68, 0x65, 0x20, 0x73, 0x79, 0x73, 0x74, 0x65, 0x6d, 0x2e, 0x22,
+  });
+  const std::string ciphertext{ "sZ2Cx16I2cCpBk4/7Yvi5FlWpQj+j0nFDTnuyD5+3DmyE2CuqKgyJO+vyi7o" };
+
+  SECTION("decrypt")
+  {
+    couchbase::crypto::encryption_result enc_result{ "AEAD_AES_SIV_CMAC_512" };
+    enc_result.put("kid", "test-key");
+    enc_result.put("ciphertext", ciphertext);
+
+    const auto decrypter = provider.decrypter();
+    const auto [dec_err, dec_result] = decrypter->decrypt(enc_result);
+    REQUIRE_NO_ERROR(dec_err);
+    REQUIRE(plaintext == dec_result);
+  }
+
+  SECTION("encryption is deterministic")
+  {
+    const auto encrypter = provider.encrypter_for_key("test-key");
+    const auto [enc_err, enc_result] = encrypter->encrypt(plaintext);
+    REQUIRE_NO_ERROR(enc_err);
+    REQUIRE(enc_result.algorithm() == "AEAD_AES_SIV_CMAC_512");
+    REQUIRE(enc_result.get("kid") == std::make_optional("test-key"));
+    REQUIRE(enc_result.get("ciphertext") == std::make_optional(ciphertext));
+
+    const auto [other_enc_err, other_enc_result] =
+      provider.encrypter_for_key("other-key")->encrypt(plaintext);
+    REQUIRE_NO_ERROR(other_enc_err);
+    REQUIRE(other_enc_result.get("ciphertext") != std::make_optional(ciphertext));
+  }
+
+  SECTION("encrypt & decrypt")
+  {
+    const auto encrypter = provider.encrypter_for_key("test-key");
+    for (std::size_t size : { 0, 1, 15, 16, 17, 32, 1000 }) {
+      const std::vector<std::byte> message(size, std::byte{ 0x2a });
+      const auto [enc_err, enc_result] = encrypter->encrypt(message);
+      REQUIRE_NO_ERROR(enc_err);
+
+      const auto decrypter = provider.decrypter();
+      const auto [dec_err, dec_result] = decrypter->decrypt(enc_result);
+      REQUIRE_NO_ERROR(dec_err);
+      REQUIRE(message == dec_result);
+    }
+  }
+
+  SECTION("encrypt missing key")
+  {
+    const auto encrypter = provider.encrypter_for_key("missing-key");
+    const auto [enc_err, enc_result] = encrypter->encrypt(plaintext);
+    REQUIRE(enc_err.ec() == couchbase::errc::field_level_encryption::crypto_key_not_found);
+  }
+
+  SECTION("encrypt invalid key")
+  {
+    const auto encrypter = provider.encrypter_for_key("invalid-key");
+    const auto [enc_err, enc_result] = encrypter->encrypt(plaintext);
+    REQUIRE(enc_err.ec() == couchbase::errc::field_level_encryption::invalid_crypto_key);
+  }
+
+  SECTION("decrypt with the wrong key")
+  {
+    couchbase::crypto::encryption_result enc_result{ "AEAD_AES_SIV_CMAC_512" };
+    enc_result.put("kid", "other-key");
+    enc_result.put("ciphertext", ciphertext);
+
+    const auto decrypter = provider.decrypter();
+    const auto [dec_err, dec_result] = decrypter->decrypt(enc_result);
+    REQUIRE(dec_err.ec() == couchbase::errc::field_level_encryption::decryption_failure);
+  }
+
+  SECTION("decrypt result that is missing key id")
+  {
+    couchbase::crypto::encryption_result enc_result{ "AEAD_AES_SIV_CMAC_512" };
+    enc_result.put("ciphertext", ciphertext);
+
+    const auto decrypter = provider.decrypter();
+    const auto [dec_err, dec_result] = decrypter->decrypt(enc_result);
+    REQUIRE(dec_err.ec() == couchbase::errc::field_level_encryption::decryption_failure);
+  }
+
+  SECTION("decrypt invalid ciphertext")
+  {
+    SECTION("ciphertext too short")
+    {
+      couchbase::crypto::encryption_result enc_result{ "AEAD_AES_SIV_CMAC_512" };
+      enc_result.put("kid", "test-key");
+      enc_result.put("ciphertext",
+                     test::utils::make_bytes({
+                       0x00,
+                       0x01,
+                       0x02,
+                       0x03,
+                     }));
+
+      const auto decrypter = provider.decrypter();
+      const auto [dec_err, dec_result] = decrypter->decrypt(enc_result);
+      REQUIRE(dec_err.ec() == couchbase::errc::field_level_encryption::invalid_ciphertext);
+    }
+
+    SECTION("ciphertext has been tampered with")
+    {
+      couchbase::crypto::encryption_result enc_result{ "AEAD_AES_SIV_CMAC_512" };
+      enc_result.put("kid", "test-key");
+      enc_result.put("ciphertext", "sZ2Cx16I2cCpBk4/7Yvi5FlWpQj+j0nFDTnuyD5+3DmyE2CuqKgyJO+vyi7p");
+
+      const auto decrypter = provider.decrypter();
+      const auto [dec_err, dec_result] = decrypter->decrypt(enc_result);
+      REQUIRE(dec_err.ec() == couchbase::errc::field_level_encryption::decryption_failure);
+    }
+  }
+}
+
+TEST_CASE("unit: AES-SIV matches the test vectors of RFC 5297", "[unit]")
+{
+  SECTION("A.1 deterministic authenticated encryption")
+  {
+    const auto key = test::utils::make_bytes({
+      0xff, 0xfe, 0xfd, 0xfc, 0xfb, 0xfa, 0xf9, 0xf8, 0xf7, 0xf6, 0xf5, 0xf4, 0xf3, 0xf2, 0xf1,
+      0xf0, 0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd,
+      0xfe, 0xff,
+    });
+    const auto associated_data = test::utils::make_bytes({
+      0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e,
+      0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27,
+    });
+    const auto plaintext = test::utils::make_bytes({
+      0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee,
+    });
+    const auto expected = test::utils::make_bytes({
+      0x85, 0x63, 0x2d, 0x07, 0xc6, 0xe8, 0xf3, 0x7f, 0x95, 0x0a, 0xcd, 0x32, 0x0a, 0x2e, 0xcc,
+      0x93, 0x40, 0xc0, 0x2b, 0x96, 0x90, 0xc4, 0xdc, 0x04, 0xda, 0xef, 0x7f, 0x6a, 0xfe, 0x5c,
+    });
+
+    const auto [err, ciphertext] =
+      couchbase::crypto::impl::aes_siv::encrypt(key, plaintext, { associated_data });
+    REQUIRE_NO_ERROR(err);
+    REQUIRE(ciphertext == expected);
+
+    const auto [dec_err, decrypted] =
+      couchbase::crypto::impl::aes_siv::decrypt(key, expected, { associated_data });
+    REQUIRE_NO_ERROR(dec_err);
+    REQUIRE(decrypted == plaintext);
+  }
+
+  SECTION("A.2 nonce-based authenticated encryption")
+  {
+    const auto key = test::utils::make_bytes({
+      0x7f, 0x7e, 0x7d, 0x7c, 0x7b, 0x7a, 0x79, 0x78, 0x77, 0x76, 0x75, 0x74, 0x73, 0x72, 0x71,
+      0x70, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x4b, 0x4c, 0x4d,
+      0x4e, 0x4f,
+    });
+    const auto first_associated_data = test::utils::make_bytes({
+      0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee,
+      0xff, 0xde, 0xad, 0xda, 0xda, 0xde, 0xad, 0xda, 0xda, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa,
+      0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00,
+    });
+    const auto second_associated_data = test::utils::make_bytes({
+      0x10, 0x20, 0x30, 0x40, 0x50, 0x60, 0x70, 0x80, 0x90, 0xa0,
+    });
+    const auto nonce = test::utils::make_bytes({
+      0x09, 0xf9, 0x11, 0x02, 0x9d, 0x74, 0xe3, 0x5b, 0xd8, 0x41, 0x56, 0xc5, 0x63, 0x56, 0x88,
+      0xc0,
+    });
+    const auto plaintext = test::utils::make_bytes({
+      0x74, 0x68, 0x69, 0x73, 0x20, 0x69, 0x73, 0x20, 0x73, 0x6f, 0x6d, 0x65, 0x20, 0x70, 0x6c,
+      0x61, 0x69, 0x6e, 0x74, 0x65, 0x78, 0x74, 0x20, 0x74, 0x6f, 0x20, 0x65, 0x6e, 0x63, 0x72,
+      0x79, 0x70, 0x74, 0x20, 0x75, 0x73, 0x69, 0x6e, 0x67, 0x20, 0x53, 0x49, 0x56, 0x2d, 0x41,
+      0x45, 0x53,
+    });
+    const auto expected = test::utils::make_bytes({
+      0x7b, 0xdb, 0x6e, 0x3b, 0x43, 0x26, 0x67, 0xeb, 0x06, 0xf4, 0xd1, 0x4b, 0xff, 0x2f, 0xbd,
+      0x0f, 0xcb, 0x90, 0x0f, 0x2f, 0xdd, 0xbe, 0x40, 0x43, 0x26, 0x60, 0x19, 0x65, 0xc8, 0x89,
+      0xbf, 0x17, 0xdb, 0xa7, 0x7c, 0xeb, 0x09, 0x4f, 0xa6, 0x63, 0xb7, 0xa3, 0xf7, 0x48, 0xba,
+      0x8a, 0xf8, 0x29, 0xea, 0x64, 0xad, 0x54, 0x4a, 0x27, 0x2e, 0x9c, 0x48, 0x5b, 0x62, 0xa3,
+      0xfd, 0x5c, 0x0d,
+    });
+
+    const std::vector<std::vector<std::byte>> associated_data{
+      first_associated_data,
+      second_associated_data,
+      nonce,
+    };
+    const auto [err, ciphertext] =
+      couchbase::crypto::impl::aes_siv::encrypt(key, plaintext, associated_data);
+    REQUIRE_NO_ERROR(err);
+    REQUIRE(ciphertext == expected);
+
+    const auto [dec_err, decrypted] =
+      couchbase::crypto::impl::aes_siv::decrypt(key, expected, associated_data);
+    REQUIRE_NO_ERROR(dec_err);
+    REQUIRE(decrypted == plaintext);
+  }
+}
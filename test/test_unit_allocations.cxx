@@ -0,0 +1,284 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include "document_types/person.hxx"
+#include "document_types/profile.hxx"
+#include "test_helper.hxx"
+
+#include <couchbase/codec/tao_json_serializer.hxx>
+#include <couchbase_encryption/aead_aes_256_cbc_hmac_sha512_provider.hxx>
+#include <couchbase_encryption/crypto_backend.hxx>
+#include <couchbase_encryption/default_manager.hxx>
+#include <couchbase_encryption/default_transcoder.hxx>
+#include <couchbase_encryption/insecure_keyring.hxx>
+
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <string>
+#include <tuple>
+
+/*
+ * Every allocation made with operator new by the current thread is counted while a measurement is
+ * in progress. Allocations made by OpenSSL with malloc() are not counted.
+ */
+namespace
+{
+struct allocation_stats {
+  std::size_t count{ 0 };
+  std::size_t bytes{ 0 };
+
+  auto operator==(const allocation_stats& other) const -> bool
+  {
+    return count == other.count && bytes == other.bytes;
+  }
+};
+
+thread_local bool counting{ false };
+thread_local allocation_stats current{};
+
+auto
+counted_allocation(std::size_t size) -> void*
+{
+  if (counting) {
+    ++current.count;
+    current.bytes += size;
+  }
+  return std::malloc(size == 0 ? 1 : size);
+}
+} // namespace
+
+auto
+operator new(std::size_t size) -> void*
+{
+  if (auto* p = counted_allocation(size); p != nullptr) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+auto
+operator new[](std::size_t size) -> void*
+{
+  return operator new(size);
+}
+
+auto
+operator new(std::size_t size, const std::nothrow_t& /* tag */) noexcept -> void*
+{
+  return counted_allocation(size);
+}
+
+auto
+operator new[](std::size_t size, const std::nothrow_t& /* tag */) noexcept -> void*
+{
+  return counted_allocation(size);
+}
+
+void
+operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void
+operator delete[](void* p) noexcept
+{
+  std::free(p);
+}
+
+void
+operator delete(void* p, std::size_t /* size */) noexcept
+{
+  std::free(p);
+}
+
+void
+operator delete[](void* p, std::size_t /* size */) noexcept
+{
+  std::free(p);
+}
+
+namespace
+{
+/**
+ * Runs the operation once to warm up caches (e.g. the OpenSSL cipher tables), then returns the
+ * allocations made by a second run.
+ */
+auto
+measure(const std::function<void()>& operation) -> allocation_stats
+{
+  operation();
+  current = {};
+  counting = true;
+  operation();
+  counting = false;
+  return current;
+}
+
+/**
+ * Checks that the operation makes exactly the expected allocations. The expected values were
+ * measured with libstdc++, and must be updated when a change adds or removes allocations, so that
+ * every change is deliberate.
+ */
+void
+check_allocations(const std::string& operation,
+                  allocation_stats measured,
+                  allocation_stats expected)
+{
+  const auto delta = [](std::size_t actual, std::size_t pinned) {
+    return static_cast<long long>(actual) - static_cast<long long>(pinned);
+  };
+  INFO(fmt::format("{}: {} allocations ({:+}), {} bytes ({:+})",
+                   operation,
+                   measured.count,
+                   delta(measured.count, expected.count),
+                   measured.bytes,
+                   delta(measured.bytes, expected.bytes)));
+  CHECK(measured.count == expected.count);
+  CHECK(measured.bytes == expected.bytes);
+}
+
+/**
+ * Pins the backend the expected allocations were measured with, which sets each key up once, so
+ * that they do not depend on the environment.
+ */
+void
+pin_measured_backend()
+{
+  couchbase::crypto::pin_crypto_backend(couchbase::crypto::crypto_backend::openssl);
+}
+
+auto
+make_keyring() -> std::shared_ptr<couchbase::crypto::insecure_keyring>
+{
+  auto keyring = std::make_shared<couchbase::crypto::insecure_keyring>();
+  keyring->add_key(couchbase::crypto::key("test-key", std::vector<std::byte>(64, std::byte{ 7 })));
+  return keyring;
+}
+
+auto
+make_crypto_manager() -> std::shared_ptr<couchbase::crypto::default_manager>
+{
+  const couchbase::crypto::aead_aes_256_cbc_hmac_sha512_provider provider{ make_keyring() };
+  auto manager = std::make_shared<couchbase::crypto::default_manager>();
+  manager->register_default_encrypter(provider.encrypter_for_key("test-key"));
+  manager->register_encrypter("one", provider.encrypter_for_key("test-key"));
+  manager->register_decrypter(provider.decrypter());
+  return manager;
+}
+
+const std::vector<std::byte> plaintext(64, std::byte{ 'x' });
+} // namespace
+
+TEST_CASE("unit: allocations of the AEAD provider", "[unit]")
+{
+  pin_measured_backend();
+  const couchbase::crypto::aead_aes_256_cbc_hmac_sha512_provider provider{ make_keyring() };
+  const auto encrypter = provider.encrypter_for_key("test-key");
+  const auto decrypter = provider.decrypter();
+
+  couchbase::error err{};
+  couchbase::crypto::encryption_result encrypted{};
+  const auto encrypt_stats = measure([&] {
+    std::tie(err, encrypted) = encrypter->encrypt(plaintext);
+  });
+  REQUIRE_NO_ERROR(err);
+  check_allocations("encrypter::encrypt", encrypt_stats, { 11, 807 });
+
+  const auto decrypt_stats = measure([&] {
+    err = decrypter->decrypt(encrypted).first;
+  });
+  REQUIRE_NO_ERROR(err);
+  check_allocations("decrypter::decrypt", decrypt_stats, { 9, 868 });
+}
+
+TEST_CASE("unit: allocations of the default manager", "[unit]")
+{
+  pin_measured_backend();
+  const auto manager = make_crypto_manager();
+
+  couchbase::error err{};
+  std::map<std::string, std::string> encrypted{};
+  const auto encrypt_stats = measure([&] {
+    std::tie(err, encrypted) = manager->encrypt(plaintext, "one");
+  });
+  REQUIRE_NO_ERROR(err);
+  check_allocations("default_manager::encrypt", encrypt_stats, { 11, 807 });
+
+  const auto decrypt_stats = measure([&] {
+    err = manager->decrypt(encrypted).first;
+  });
+  REQUIRE_NO_ERROR(err);
+  check_allocations("default_manager::decrypt", decrypt_stats, { 9, 868 });
+}
+
+TEST_CASE("unit: allocations of the transcoder", "[unit]")
+{
+  pin_measured_backend();
+  const std::shared_ptr<couchbase::crypto::manager> manager = make_crypto_manager();
+  const person p{
+    "Albert",
+    "Einstein",
+    "password123",
+    {
+      "1A",
+      {
+        "my street",
+        "my second line",
+      },
+    },
+    {
+      "cat",
+      std::map<std::string, person::pet::attribute>{
+        { "attr1", { "jump" } },
+        { "attr2", { "scratch", "extra" } },
+      },
+    },
+  };
+  const profile pr{ "alberteinstein", "Albert Einstein", 1879 };
+
+  const auto check_document = [&manager](const std::string& name,
+                                         const couchbase::codec::binary& raw,
+                                         const std::vector<couchbase::crypto::encrypted_field>&
+                                           encrypted_fields,
+                                         allocation_stats expected_encrypt,
+                                         allocation_stats expected_decrypt) {
+    couchbase::error err{};
+    couchbase::codec::binary encrypted{};
+    const auto encrypt = [&] {
+      std::tie(err, encrypted) =
+        couchbase::crypto::internal::encrypt(raw, encrypted_fields, manager);
+    };
+    const auto decrypt = [&] {
+      err = couchbase::crypto::internal::decrypt(encrypted, manager).first;
+    };
+
+    // the number of allocations must not depend on anything but the document
+    const auto encrypt_stats = measure(encrypt);
+    REQUIRE_NO_ERROR(err);
+    REQUIRE(measure(encrypt) == encrypt_stats);
+    const auto decrypt_stats = measure(decrypt);
+    REQUIRE_NO_ERROR(err);
+    REQUIRE(measure(decrypt) == decrypt_stats);
+
+    check_allocations("internal::encrypt(" + name + ")", encrypt_stats, expected_encrypt);
+    check_allocations("internal::decrypt(" + name + ")", decrypt_stats, expected_decrypt);
+  };
+
+  check_document("person",
+                 couchbase::codec::tao_json_serializer::serialize(p),
+                 person::encrypted_fields,
+                 { 134, 19371 },
+                 { 135, 19964 });
+  check_document("profile",
+                 couchbase::codec::tao_json_serializer::serialize(pr),
+                 profile::encrypted_fields,
+                 { 28, 3095 },
+                 { 28, 3651 });
+}
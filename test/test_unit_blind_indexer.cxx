@@ -0,0 +1,79 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include "test_helper.hxx"
+
+#include <couchbase/error_codes.hxx>
+#include <couchbase_encryption/blind_indexer.hxx>
+#include <couchbase_encryption/default_manager.hxx>
+#include <couchbase_encryption/insecure_keyring.hxx>
+
+TEST_CASE("unit: hmac_sha512_blind_indexer", "[unit]")
+{
+  // RFC 4231, test case 2
+  auto keyring = std::make_shared<couchbase::crypto::insecure_keyring>();
+  keyring->add_key(couchbase::crypto::key("index-key", test::utils::make_bytes({
+                                                         0x4a,
+                                                         0x65,
+                                                         0x66,
+                                                         0x65,
+                                                       })));
+  const auto plaintext = test::utils::make_bytes({
+    0x77, 0x68, 0x61, 0x74, 0x20, 0x64, 0x6f, 0x20, 0x79, 0x61, 0x20, 0x77, 0x61, 0x6e,
+    0x74, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x6e, 0x6f, 0x74, 0x68, 0x69, 0x6e, 0x67, 0x3f,
+  });
+  const auto expected = test::utils::make_bytes({
+    0x16, 0x4b, 0x7a, 0x7b, 0xfc, 0xf8, 0x19, 0xe2, 0xe3, 0x95, 0xfb, 0xe7, 0x3b, 0x56, 0xe0, 0xa3,
+    0x87, 0xbd, 0x64, 0x22, 0x2e, 0x83, 0x1f, 0xd6, 0x10, 0x27, 0x0c, 0xd7, 0xea, 0x25, 0x05, 0x54,
+    0x97, 0x58, 0xbf, 0x75, 0xc0, 0x5a, 0x99, 0x4a, 0x6d, 0x03, 0x4f, 0x65, 0xf8, 0xf0, 0xe6, 0xfd,
+    0xca, 0xea, 0xb1, 0xa3, 0x4d, 0x4a, 0x6b, 0x4b, 0x63, 0x6e, 0x07, 0x0a, 0x38, 0xbc, 0xe7, 0x37,
+  });
+
+  SECTION("index")
+  {
+    couchbase::crypto::hmac_sha512_blind_indexer indexer("index-key", keyring);
+    const auto [err, mac] = indexer.index(plaintext);
+    REQUIRE_NO_ERROR(err);
+    REQUIRE(mac == expected);
+  }
+
+  SECTION("index with missing key")
+  {
+    couchbase::crypto::hmac_sha512_blind_indexer indexer("missing-key", keyring);
+    const auto [err, mac] = indexer.index(plaintext);
+    REQUIRE(err.ec() == couchbase::errc::field_level_encryption::crypto_key_not_found);
+  }
+
+  SECTION("token")
+  {
+    const auto manager = std::make_shared<couchbase::crypto::default_manager>();
+    manager->register_default_blind_indexer(
+      std::make_shared<couchbase::crypto::hmac_sha512_blind_indexer>("index-key", keyring));
+
+    {
+      const auto [err, token] = couchbase::crypto::blind_index_token(manager, plaintext, {});
+      REQUIRE_NO_ERROR(err);
+      REQUIRE(token == "Fkt6e/z4GeLjlfvnO1bgo4e9ZCIugx/WECcM1+olBVSXWL91wFqZSm0DT2X48Ob9"
+                       "yuqxo01Ka0tjbgcKOLznNw==");
+    }
+
+    {
+      const auto [err, token] =
+        couchbase::crypto::blind_index_token(manager, plaintext, { {}, 8 });
+      REQUIRE_NO_ERROR(err);
+      REQUIRE(token == "Fkt6e/z4GeI=");
+    }
+
+    {
+      const auto [err, token] =
+        couchbase::crypto::blind_index_token(manager, plaintext, { "does-not-exist", 0 });
+      REQUIRE(err.ec() == couchbase::crypto::blind_index_errc::blind_indexer_not_found);
+      REQUIRE(err.ec().category() == couchbase::crypto::blind_index_category());
+    }
+  }
+}
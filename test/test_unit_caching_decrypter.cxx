@@ -0,0 +1,189 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include "test_helper.hxx"
+
+#include <couchbase/error_codes.hxx>
+#include <couchbase_encryption/aead_aes_256_cbc_hmac_sha512_provider.hxx>
+#include <couchbase_encryption/caching_decrypter.hxx>
+#include <couchbase_encryption/insecure_keyring.hxx>
+
+#include <functional>
+#include <string>
+#include <tuple>
+
+namespace
+{
+class counting_decrypter : public couchbase::crypto::decrypter
+{
+public:
+  explicit counting_decrypter(std::shared_ptr<couchbase::crypto::decrypter> backing)
+    : backing_{ std::move(backing) }
+  {
+  }
+
+  [[nodiscard]] auto decrypt(couchbase::crypto::encryption_result encrypted)
+    -> std::pair<couchbase::error, std::vector<std::byte>> override
+  {
+    ++calls;
+    if (during_decrypt) {
+      during_decrypt();
+    }
+    return backing_->decrypt(std::move(encrypted));
+  }
+
+  [[nodiscard]] auto algorithm() const -> const std::string& override
+  {
+    return backing_->algorithm();
+  }
+
+  std::size_t calls{ 0 };
+  std::function<void()> during_decrypt{};
+
+private:
+  std::shared_ptr<couchbase::crypto::decrypter> backing_;
+};
+
+auto
+make_value(std::size_t size, char c) -> std::vector<std::byte>
+{
+  return std::vector<std::byte>(size, static_cast<std::byte>(c));
+}
+} // namespace
+
+TEST_CASE("unit: caching decrypter", "[unit]")
+{
+  auto keyring = std::make_shared<couchbase::crypto::insecure_keyring>();
+  keyring->add_key(couchbase::crypto::key("test-key", std::vector<std::byte>(64, std::byte{ 7 })));
+  keyring->add_key(couchbase::crypto::key("other-key", std::vector<std::byte>(64, std::byte{ 9 })));
+  const couchbase::crypto::aead_aes_256_cbc_hmac_sha512_provider provider{ keyring };
+
+  const auto encrypt = [&provider](const std::string& key_id, const std::vector<std::byte>& value) {
+    auto [err, result] = provider.encrypter_for_key(key_id)->encrypt(value);
+    REQUIRE_NO_ERROR(err);
+    return result;
+  };
+
+  auto backing = std::make_shared<counting_decrypter>(provider.decrypter());
+
+  SECTION("repeated ciphertexts are decrypted once")
+  {
+    couchbase::crypto::caching_decrypter decrypter{ backing };
+    REQUIRE(decrypter.algorithm() == "AEAD_AES_256_CBC_HMAC_SHA512");
+
+    const auto value = make_value(100, 'a');
+    const auto encrypted = encrypt("test-key", value);
+    for (int i = 0; i < 3; ++i) {
+      const auto [err, plaintext] = decrypter.decrypt(encrypted);
+      REQUIRE_NO_ERROR(err);
+      REQUIRE(plaintext == value);
+    }
+    REQUIRE(backing->calls == 1);
+    REQUIRE(decrypter.size_in_bytes() > value.size());
+
+    // the same value encrypted again has a different ciphertext
+    const auto [err, plaintext] = decrypter.decrypt(encrypt("test-key", value));
+    REQUIRE_NO_ERROR(err);
+    REQUIRE(plaintext == value);
+    REQUIRE(backing->calls == 2);
+  }
+
+  SECTION("failures are not cached")
+  {
+    couchbase::crypto::caching_decrypter decrypter{ backing };
+
+    auto node = encrypt("test-key", make_value(100, 'a')).as_map();
+    node["kid"] = "other-key";
+    const couchbase::crypto::encryption_result encrypted{ node };
+    for (int i = 0; i < 2; ++i) {
+      const auto [err, plaintext] = decrypter.decrypt(encrypted);
+      REQUIRE(err.ec() == couchbase::errc::field_level_encryption::decryption_failure);
+    }
+    REQUIRE(backing->calls == 2);
+    REQUIRE(decrypter.size_in_bytes() == 0);
+  }
+
+  SECTION("invalidating a key removes its values")
+  {
+    couchbase::crypto::caching_decrypter decrypter{ backing };
+
+    const auto revoked = encrypt("test-key", make_value(100, 'a'));
+    const auto kept = encrypt("other-key", make_value(100, 'b'));
+    std::ignore = decrypter.decrypt(revoked);
+    std::ignore = decrypter.decrypt(kept);
+    REQUIRE(backing->calls == 2);
+
+    decrypter.invalidate("test-key");
+    std::ignore = decrypter.decrypt(kept);
+    REQUIRE(backing->calls == 2);
+    std::ignore = decrypter.decrypt(revoked);
+    REQUIRE(backing->calls == 3);
+
+    decrypter.clear();
+    REQUIRE(decrypter.size_in_bytes() == 0);
+    std::ignore = decrypter.decrypt(kept);
+    REQUIRE(backing->calls == 4);
+  }
+
+  SECTION("values decrypted while their key is invalidated are not cached")
+  {
+    couchbase::crypto::caching_decrypter decrypter{ backing };
+
+    const auto value = make_value(100, 'a');
+    const auto revoked = encrypt("test-key", value);
+    backing->during_decrypt = [&decrypter] {
+      decrypter.invalidate("test-key");
+    };
+    const auto [err, plaintext] = decrypter.decrypt(revoked);
+    REQUIRE_NO_ERROR(err);
+    REQUIRE(plaintext == value);
+    REQUIRE(decrypter.size_in_bytes() == 0);
+
+    backing->during_decrypt = nullptr;
+    std::ignore = decrypter.decrypt(revoked);
+    REQUIRE(backing->calls == 2);
+    std::ignore = decrypter.decrypt(revoked);
+    REQUIRE(backing->calls == 2);
+  }
+
+  SECTION("least recently used values are evicted")
+  {
+    couchbase::crypto::caching_decrypter decrypter{ backing, { 1024, 1 } };
+
+    const auto first = encrypt("test-key", make_value(300, 'a'));
+    const auto second = encrypt("test-key", make_value(300, 'b'));
+    const auto third = encrypt("test-key", make_value(300, 'c'));
+    std::ignore = decrypter.decrypt(first);
+    std::ignore = decrypter.decrypt(second);
+    std::ignore = decrypter.decrypt(first);
+    std::ignore = decrypter.decrypt(third);
+    REQUIRE(backing->calls == 3);
+    REQUIRE(decrypter.size_in_bytes() <= 1024);
+
+    std::ignore = decrypter.decrypt(first);
+    REQUIRE(backing->calls == 3);
+    std::ignore = decrypter.decrypt(second);
+    REQUIRE(backing->calls == 4);
+
+    // values larger than the cache are never cached
+    const auto large = encrypt("test-key", make_value(2048, 'd'));
+    std::ignore = decrypter.decrypt(large);
+    std::ignore = decrypter.decrypt(large);
+    REQUIRE(backing->calls == 6);
+  }
+
+  SECTION("caching can be disabled")
+  {
+    couchbase::crypto::caching_decrypter decrypter{ backing, { 0 } };
+
+    const auto encrypted = encrypt("test-key", make_value(100, 'a'));
+    std::ignore = decrypter.decrypt(encrypted);
+    std::ignore = decrypter.decrypt(encrypted);
+    REQUIRE(backing->calls == 2);
+  }
+}
@@ -0,0 +1,220 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include "test_helper.hxx"
+
+#include <couchbase/error_codes.hxx>
+#include <couchbase_encryption/aead_aes_256_cbc_hmac_sha512_provider.hxx>
+#include <couchbase_encryption/compression.hxx>
+#include <couchbase_encryption/insecure_keyring.hxx>
+
+#include <map>
+#include <string>
+
+namespace
+{
+auto
+make_provider() -> couchbase::crypto::aead_aes_256_cbc_hmac_sha512_provider
+{
+  auto keyring = std::make_shared<couchbase::crypto::insecure_keyring>();
+  keyring->add_key(couchbase::crypto::key("test-key", std::vector<std::byte>(64, std::byte{ 7 })));
+  return couchbase::crypto::aead_aes_256_cbc_hmac_sha512_provider{ std::move(keyring) };
+}
+
+auto
+make_note(std::size_t size) -> std::vector<std::byte>
+{
+  const std::string sentence{ "\"Patient reports mild headache, no fever. Follow up in 2 weeks. " };
+  std::vector<std::byte> note{};
+  while (note.size() < size) {
+    for (const auto c : sentence) {
+      note.push_back(static_cast<std::byte>(c));
+    }
+  }
+  note.resize(size);
+  return note;
+}
+} // namespace
+
+TEST_CASE("unit: compressing encrypter", "[unit]")
+{
+  using couchbase::crypto::compression_algorithm;
+
+  const auto provider = make_provider();
+
+  for (const auto algorithm : { compression_algorithm::zstd, compression_algorithm::lz4 }) {
+    if (!couchbase::crypto::is_compression_supported(algorithm)) {
+      continue;
+    }
+    const std::string name{ algorithm == compression_algorithm::zstd ? "zstd" : "lz4" };
+
+    SECTION("compress & decompress " + name)
+    {
+      couchbase::crypto::compression_options options{};
+      options.algorithm = algorithm;
+      options.level = 1;
+      couchbase::crypto::compressing_encrypter encrypter{ provider.encrypter_for_key("test-key"),
+                                                          options };
+      couchbase::crypto::decompressing_decrypter decrypter{ provider.decrypter() };
+      REQUIRE(decrypter.algorithm() == "AEAD_AES_256_CBC_HMAC_SHA512");
+
+      const auto note = make_note(30 * 1024);
+      const auto [enc_err, enc_result] = encrypter.encrypt(note);
+      REQUIRE_NO_ERROR(enc_err);
+      REQUIRE(enc_result.get("cmp") == std::make_optional(name));
+      REQUIRE_FALSE(enc_result.get("cdict").has_value());
+      REQUIRE(enc_result.get_bytes("ciphertext").value().size() < note.size() / 4);
+
+      const auto [dec_err, dec_result] = decrypter.decrypt(enc_result);
+      REQUIRE_NO_ERROR(dec_err);
+      REQUIRE(dec_result == note);
+    }
+
+    SECTION("small values are not compressed " + name)
+    {
+      couchbase::crypto::compression_options options{};
+      options.algorithm = algorithm;
+      options.min_size = 64;
+      couchbase::crypto::compressing_encrypter encrypter{ provider.encrypter_for_key("test-key"),
+                                                          options };
+      couchbase::crypto::decompressing_decrypter decrypter{ provider.decrypter() };
+
+      const auto note = make_note(63);
+      const auto [enc_err, enc_result] = encrypter.encrypt(note);
+      REQUIRE_NO_ERROR(enc_err);
+      REQUIRE_FALSE(enc_result.get("cmp").has_value());
+
+      const auto [dec_err, dec_result] = decrypter.decrypt(enc_result);
+      REQUIRE_NO_ERROR(dec_err);
+      REQUIRE(dec_result == note);
+    }
+
+    SECTION("compress with dictionary " + name)
+    {
+      couchbase::crypto::compression_options options{};
+      options.algorithm = algorithm;
+      options.min_size = 0;
+      options.dictionary = couchbase::crypto::compression_dictionary{ "notes-v1", make_note(512) };
+      couchbase::crypto::compressing_encrypter encrypter{ provider.encrypter_for_key("test-key"),
+                                                          options };
+
+      const auto note = make_note(200);
+      const auto [enc_err, enc_result] = encrypter.encrypt(note);
+      REQUIRE_NO_ERROR(enc_err);
+      REQUIRE(enc_result.get("cmp") == std::make_optional(name));
+      REQUIRE(enc_result.get("cdict") == std::make_optional<std::string>("notes-v1"));
+
+      couchbase::crypto::decompressing_decrypter decrypter{ provider.decrypter(),
+                                                            { options.dictionary.value() } };
+      const auto [dec_err, dec_result] = decrypter.decrypt(enc_result);
+      REQUIRE_NO_ERROR(dec_err);
+      REQUIRE(dec_result == note);
+
+      couchbase::crypto::decompressing_decrypter decrypter_without_dictionary{
+        provider.decrypter()
+      };
+      const auto [missing_err, missing_result] = decrypter_without_dictionary.decrypt(enc_result);
+      REQUIRE(missing_err.ec() == couchbase::errc::field_level_encryption::decryption_failure);
+    }
+
+    SECTION("compression fields are authenticated " + name)
+    {
+      couchbase::crypto::compression_options options{};
+      options.algorithm = algorithm;
+      options.min_size = 0;
+      options.dictionary = couchbase::crypto::compression_dictionary{ "notes-v1", make_note(512) };
+      couchbase::crypto::compressing_encrypter encrypter{ provider.encrypter_for_key("test-key"),
+                                                          options };
+      couchbase::crypto::decompressing_decrypter decrypter{
+        provider.decrypter(),
+        { options.dictionary.value(),
+          couchbase::crypto::compression_dictionary{ "notes-v2", make_note(256) } }
+      };
+
+      const auto [enc_err, enc_result] = encrypter.encrypt(make_note(200));
+      REQUIRE_NO_ERROR(enc_err);
+
+      // the encryption result is stored next to the ciphertext, where anyone can change it. An
+      // empty value removes the field.
+      const auto tampered = [&enc_result](const std::map<std::string, std::string>& fields) {
+        auto map = enc_result.as_map();
+        for (const auto& [field, value] : fields) {
+          if (value.empty()) {
+            map.erase(field);
+          } else {
+            map[field] = value;
+          }
+        }
+        return couchbase::crypto::encryption_result{ std::move(map) };
+      };
+      REQUIRE(decrypter.decrypt(tampered({ { "cdict", "notes-v2" } })).first.ec() ==
+              couchbase::errc::field_level_encryption::decryption_failure);
+      const std::string other_algorithm{ name == "zstd" ? "lz4" : "zstd" };
+      REQUIRE(decrypter.decrypt(tampered({ { "cmp", other_algorithm } })).first.ec() ==
+              couchbase::errc::field_level_encryption::decryption_failure);
+      REQUIRE(decrypter.decrypt(tampered({ { "cmp", "" }, { "cdict", "" } })).first.ec() ==
+              couchbase::errc::field_level_encryption::decryption_failure);
+    }
+
+    SECTION("decompressed size is limited " + name)
+    {
+      couchbase::crypto::compression_options options{};
+      options.algorithm = algorithm;
+      couchbase::crypto::compressing_encrypter encrypter{ provider.encrypter_for_key("test-key"),
+                                                          options };
+      couchbase::crypto::decompressing_decrypter decrypter{ provider.decrypter(), {}, 4096 };
+
+      const auto [enc_err, enc_result] = encrypter.encrypt(make_note(8192));
+      REQUIRE_NO_ERROR(enc_err);
+      const auto [dec_err, dec_result] = decrypter.decrypt(enc_result);
+      REQUIRE(dec_err.ec() == couchbase::errc::field_level_encryption::decryption_failure);
+    }
+  }
+
+  if (couchbase::crypto::is_compression_supported(compression_algorithm::zstd)) {
+    SECTION("invalid zstd dictionary")
+    {
+      // the magic number of a zstd dictionary, followed by entropy tables that do not parse
+      std::vector<std::byte> bytes{ std::byte{ 0x37 }, std::byte{ 0xa4 }, std::byte{ 0x30 },
+                                    std::byte{ 0xec } };
+      bytes.resize(512, std::byte{ 0xff });
+      const couchbase::crypto::compression_dictionary dictionary{ "broken", bytes };
+
+      couchbase::crypto::compression_options options{};
+      options.min_size = 0;
+      options.dictionary = dictionary;
+      couchbase::crypto::compressing_encrypter encrypter{ provider.encrypter_for_key("test-key"),
+                                                          options };
+      const auto [enc_err, enc_result] = encrypter.encrypt(make_note(200));
+      REQUIRE(enc_err.ec() == couchbase::errc::field_level_encryption::encryption_failure);
+
+      // a field compressed with a valid dictionary that is broken on the reading side
+      options.dictionary = couchbase::crypto::compression_dictionary{ "broken", make_note(512) };
+      couchbase::crypto::compressing_encrypter valid_encrypter{
+        provider.encrypter_for_key("test-key"), options
+      };
+      const auto [valid_err, valid_result] = valid_encrypter.encrypt(make_note(200));
+      REQUIRE_NO_ERROR(valid_err);
+      couchbase::crypto::decompressing_decrypter decrypter{ provider.decrypter(), { dictionary } };
+      const auto [dec_err, dec_result] = decrypter.decrypt(valid_result);
+      REQUIRE(dec_err.ec() == couchbase::errc::field_level_encryption::decryption_failure);
+      REQUIRE(dec_err.message().find("broken") != std::string::npos);
+    }
+  }
+
+  SECTION("unknown compression algorithm")
+  {
+    auto [enc_err, enc_result] = provider.encrypter_for_key("test-key")->encrypt(make_note(16));
+    REQUIRE_NO_ERROR(enc_err);
+    enc_result.put("cmp", "brotli");
+
+    couchbase::crypto::decompressing_decrypter decrypter{ provider.decrypter() };
+    const auto [dec_err, dec_result] = decrypter.decrypt(enc_result);
+    REQUIRE(dec_err.ec() == couchbase::errc::field_level_encryption::decryption_failure);
+  }
+}
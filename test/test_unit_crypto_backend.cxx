@@ -0,0 +1,88 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include "test_helper.hxx"
+
+#include <couchbase_encryption/aead_aes_256_cbc_hmac_sha512_chunked_provider.hxx>
+#include <couchbase_encryption/aead_aes_256_cbc_hmac_sha512_provider.hxx>
+#include <couchbase_encryption/crypto_backend.hxx>
+#include <couchbase_encryption/insecure_keyring.hxx>
+
+#include <string>
+
+TEST_CASE("unit: crypto backends", "[unit]")
+{
+  using couchbase::crypto::crypto_backend;
+  const std::vector<crypto_backend> backends{ crypto_backend::openssl,
+                                              crypto_backend::couchbase_sdk };
+
+  SECTION("names")
+  {
+    for (const auto backend : backends) {
+      REQUIRE(couchbase::crypto::crypto_backend_from_name(
+                couchbase::crypto::crypto_backend_name(backend)) == backend);
+    }
+    REQUIRE_FALSE(couchbase::crypto::crypto_backend_from_name("auto").has_value());
+  }
+
+  SECTION("every backend is measured")
+  {
+    for (const std::size_t rounds : { 0, 1, 4 }) {
+      INFO(rounds);
+      const auto measurements =
+        couchbase::crypto::benchmark_crypto_backends(std::chrono::microseconds{ 200 }, rounds);
+      REQUIRE(measurements.size() == backends.size());
+      for (std::size_t i = 0; i < backends.size(); ++i) {
+        INFO(couchbase::crypto::crypto_backend_name(measurements[i].backend));
+        REQUIRE(measurements[i].backend == backends[i]);
+        REQUIRE(measurements[i].bytes_per_second > 0);
+      }
+    }
+  }
+
+  SECTION("the selected backend is the active one")
+  {
+    const auto selected = couchbase::crypto::select_crypto_backend();
+    REQUIRE(couchbase::crypto::active_crypto_backend() == selected);
+    couchbase::crypto::pin_crypto_backend(crypto_backend::openssl);
+    REQUIRE(couchbase::crypto::active_crypto_backend() == crypto_backend::openssl);
+  }
+
+  SECTION("values encrypted with one backend are decrypted with the others")
+  {
+    auto keyring = std::make_shared<couchbase::crypto::insecure_keyring>();
+    keyring->add_key(
+      couchbase::crypto::key("test-key", std::vector<std::byte>(64, std::byte{ 7 })));
+    const couchbase::crypto::aead_aes_256_cbc_hmac_sha512_provider provider{ keyring };
+    const couchbase::crypto::aead_aes_256_cbc_hmac_sha512_chunked_provider chunked_provider{
+      keyring, { 100 }
+    };
+    const std::vector<std::byte> plaintext(1000, std::byte{ 42 });
+
+    for (const auto encrypting_backend : backends) {
+      couchbase::crypto::pin_crypto_backend(encrypting_backend);
+      REQUIRE(couchbase::crypto::active_crypto_backend() == encrypting_backend);
+      const auto [err, encrypted] = provider.encrypter_for_key("test-key")->encrypt(plaintext);
+      REQUIRE_NO_ERROR(err);
+      const auto [chunked_err, chunked] =
+        chunked_provider.encrypter_for_key("test-key")->encrypt(plaintext);
+      REQUIRE_NO_ERROR(chunked_err);
+
+      for (const auto decrypting_backend : backends) {
+        couchbase::crypto::pin_crypto_backend(decrypting_backend);
+        const auto [dec_err, decrypted] = provider.decrypter()->decrypt(encrypted);
+        REQUIRE_NO_ERROR(dec_err);
+        REQUIRE(decrypted == plaintext);
+        const auto [chunked_dec_err, chunked_decrypted] =
+          chunked_provider.decrypter()->decrypt(chunked);
+        REQUIRE_NO_ERROR(chunked_dec_err);
+        REQUIRE(chunked_decrypted == plaintext);
+      }
+    }
+  }
+}
@@ -115,3 +115,156 @@ TEST_CASE("unit: can use crypto document to specify additional fields to encrypt
   // Verify that the transcoder can decode & decrypt and return the original document
   REQUIRE(p == couchbase::crypto::default_transcoder::decode<profile>(encoded, mgr));
 }
+
+TEST_CASE("unit: can use wildcard and array index path segments to specify fields to encrypt",
+          "[unit]")
+{
+  const tao::json::value doc{
+    { "name", "Albert Einstein" },
+    { "contacts",
+      tao::json::value::array({
+        { { "type", "home" }, { "phone", "555-0100" } },
+        { { "type", "work" }, { "phone", "555-0199" } },
+        { { "type", "email" }, { "address", "albert@example.com" } },
+      }) },
+    { "secrets", { { "question", "First pet?" }, { "answer", "Chico" } } },
+  };
+
+  const auto mgr = make_crypto_manager();
+
+  SECTION("wildcard over array elements")
+  {
+    const auto crypto_doc = couchbase::crypto::document<tao::json::value>::from(doc)
+                              .with_encrypted_field({ "contacts", "*", "phone" });
+    const auto encoded = couchbase::crypto::default_transcoder::encode(crypto_doc, mgr);
+
+    auto json = couchbase::codec::tao_json_serializer::deserialize<tao::json::value>(encoded.data);
+    REQUIRE(json.at("name").get_string() == "Albert Einstein");
+    const auto& contacts = json.at("contacts").get_array();
+    test::utils::ensure_field_is_encrypted(contacts.at(0), "phone");
+    test::utils::ensure_field_is_encrypted(contacts.at(1), "phone");
+    REQUIRE(contacts.at(0).at("type").get_string() == "home");
+    REQUIRE(contacts.at(2) == doc.at("contacts").get_array().at(2));
+
+    REQUIRE(doc == couchbase::crypto::default_transcoder::decode<tao::json::value>(encoded, mgr));
+  }
+
+  SECTION("array index")
+  {
+    const auto crypto_doc = couchbase::crypto::document<tao::json::value>::from(doc)
+                              .with_encrypted_field({ "contacts", "[1]", "phone" });
+    const auto encoded = couchbase::crypto::default_transcoder::encode(crypto_doc, mgr);
+
+    auto json = couchbase::codec::tao_json_serializer::deserialize<tao::json::value>(encoded.data);
+    const auto& contacts = json.at("contacts").get_array();
+    REQUIRE(contacts.at(0).at("phone").get_string() == "555-0100");
+    test::utils::ensure_field_is_encrypted(contacts.at(1), "phone");
+
+    REQUIRE(doc == couchbase::crypto::default_transcoder::decode<tao::json::value>(encoded, mgr));
+  }
+
+  SECTION("numeric member names")
+  {
+    const tao::json::value codes{ { "codes", { { "1", "1234" }, { "2", "5678" } } } };
+    const auto crypto_doc = couchbase::crypto::document<tao::json::value>::from(codes)
+                              .with_encrypted_field({ "codes", "1" });
+    const auto encoded = couchbase::crypto::default_transcoder::encode(crypto_doc, mgr);
+
+    auto json = couchbase::codec::tao_json_serializer::deserialize<tao::json::value>(encoded.data);
+    test::utils::ensure_field_is_encrypted(json.at("codes"), "1");
+    REQUIRE(json.at("codes").at("2").get_string() == "5678");
+
+    REQUIRE(codes ==
+            couchbase::crypto::default_transcoder::decode<tao::json::value>(encoded, mgr));
+  }
+
+  SECTION("array index segments do not match object members")
+  {
+    const auto crypto_doc = couchbase::crypto::document<tao::json::value>::from(doc)
+                              .with_encrypted_field({ "secrets", "[0]" });
+    try {
+      const auto _ = couchbase::crypto::default_transcoder::encode(crypto_doc, mgr);
+      FAIL("Expected exception to be thrown, but was not.");
+    } catch (const std::system_error& e) {
+      REQUIRE(e.code() == couchbase::errc::field_level_encryption::encryption_failure);
+    }
+  }
+
+  SECTION("wildcard over object members")
+  {
+    const auto crypto_doc = couchbase::crypto::document<tao::json::value>::from(doc)
+                              .with_encrypted_field({ "secrets", "answer" }, "one")
+                              .with_encrypted_field({ "secrets", "*" });
+    const auto encoded = couchbase::crypto::default_transcoder::encode(crypto_doc, mgr);
+
+    auto json = couchbase::codec::tao_json_serializer::deserialize<tao::json::value>(encoded.data);
+    REQUIRE(json.at("secrets").get_object().size() == 2);
+    test::utils::ensure_field_is_encrypted(json.at("secrets"), "question");
+    test::utils::ensure_field_is_encrypted(json.at("secrets"), "answer");
+
+    REQUIRE(doc == couchbase::crypto::default_transcoder::decode<tao::json::value>(encoded, mgr));
+  }
+
+  SECTION("wildcard paths continue below members encrypted by other paths")
+  {
+    const tao::json::value accounts{
+      { "accounts",
+        { { "checking", { { "pin", "1234" }, { "bank", "First" } } },
+          { "savings", { { "pin", "5678" } } } } },
+    };
+    const auto declared_first = couchbase::crypto::document<tao::json::value>::from(accounts)
+                                  .with_encrypted_field({ "accounts", "*", "pin" })
+                                  .with_encrypted_field({ "accounts", "checking" });
+    const auto declared_last = couchbase::crypto::document<tao::json::value>::from(accounts)
+                                 .with_encrypted_field({ "accounts", "checking" })
+                                 .with_encrypted_field({ "accounts", "*", "pin" });
+
+    for (const auto& crypto_doc : { declared_first, declared_last }) {
+      const auto encoded = couchbase::crypto::default_transcoder::encode(crypto_doc, mgr);
+
+      auto json =
+        couchbase::codec::tao_json_serializer::deserialize<tao::json::value>(encoded.data);
+      test::utils::ensure_field_is_encrypted(json.at("accounts"), "checking");
+      test::utils::ensure_field_is_encrypted(json.at("accounts").at("savings"), "pin");
+
+      // the pin of the checking account is encrypted inside the ciphertext of the account
+      std::map<std::string, std::string> checking_node{};
+      for (const auto& [name, value] : json.at("accounts").at("encrypted$checking").get_object()) {
+        checking_node.emplace(name, value.get_string());
+      }
+      const auto [err, checking] = mgr->decrypt(checking_node);
+      REQUIRE_NO_ERROR(err);
+      const auto checking_json =
+        couchbase::codec::tao_json_serializer::deserialize<tao::json::value>(checking);
+      test::utils::ensure_field_is_encrypted(checking_json, "pin");
+      REQUIRE(checking_json.at("bank").get_string() == "First");
+
+      REQUIRE(accounts ==
+              couchbase::crypto::default_transcoder::decode<tao::json::value>(encoded, mgr));
+    }
+  }
+
+  SECTION("array index out of range")
+  {
+    const auto crypto_doc = couchbase::crypto::document<tao::json::value>::from(doc)
+                              .with_encrypted_field({ "contacts", "[3]", "phone" });
+    try {
+      const auto _ = couchbase::crypto::default_transcoder::encode(crypto_doc, mgr);
+      FAIL("Expected exception to be thrown, but was not.");
+    } catch (const std::system_error& e) {
+      REQUIRE(e.code() == couchbase::errc::field_level_encryption::encryption_failure);
+    }
+  }
+
+  SECTION("array elements cannot be encrypted")
+  {
+    const auto crypto_doc = couchbase::crypto::document<tao::json::value>::from(doc)
+                              .with_encrypted_field({ "contacts", "*" });
+    try {
+      const auto _ = couchbase::crypto::default_transcoder::encode(crypto_doc, mgr);
+      FAIL("Expected exception to be thrown, but was not.");
+    } catch (const std::system_error& e) {
+      REQUIRE(e.code() == couchbase::errc::field_level_encryption::encryption_failure);
+    }
+  }
+}
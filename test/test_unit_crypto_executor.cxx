@@ -0,0 +1,145 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include "test_helper.hxx"
+
+#include <couchbase_encryption/crypto_executor.hxx>
+
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+/**
+ * Occupies the only worker of an executor until released, so that the tasks posted meanwhile are
+ * queued.
+ */
+class blocker
+{
+public:
+  explicit blocker(couchbase::crypto::crypto_executor& executor)
+  {
+    auto started = std::make_shared<std::promise<void>>();
+    auto started_future = started->get_future();
+    executor.post([started, released = released_.get_future().share()] {
+      started->set_value();
+      released.wait();
+    });
+    started_future.wait();
+  }
+
+  void release()
+  {
+    released_.set_value();
+  }
+
+private:
+  std::promise<void> released_{};
+};
+
+struct recorder {
+  std::mutex mutex{};
+  std::vector<std::string> order{};
+
+  auto task(std::string name)
+  {
+    return [this, name = std::move(name)] {
+      const std::scoped_lock lock(mutex);
+      order.push_back(name);
+    };
+  }
+};
+} // namespace
+
+TEST_CASE("unit: crypto executor", "[unit]")
+{
+  using couchbase::crypto::crypto_priority;
+
+  SECTION("interactive tasks run before bulk tasks")
+  {
+    recorder tasks{};
+    {
+      couchbase::crypto::crypto_executor executor{ { 1 } };
+      blocker worker{ executor };
+      executor.post(tasks.task("bulk-1"), crypto_priority::bulk);
+      executor.post(tasks.task("interactive-1"));
+      executor.post(tasks.task("bulk-2"), crypto_priority::bulk);
+      executor.post(tasks.task("interactive-2"), crypto_priority::interactive);
+      worker.release();
+    }
+    REQUIRE(tasks.order ==
+            std::vector<std::string>{ "interactive-1", "interactive-2", "bulk-1", "bulk-2" });
+  }
+
+  SECTION("bulk tasks are not starved")
+  {
+    recorder tasks{};
+    {
+      couchbase::crypto::crypto_executor executor{ { 1 } };
+      blocker worker{ executor };
+      executor.post(tasks.task("bulk"), crypto_priority::bulk);
+      for (int i = 0; i < 20; ++i) {
+        executor.post(tasks.task("interactive"));
+      }
+      worker.release();
+    }
+    REQUIRE(tasks.order.size() == 21);
+    // the blocker counts as the first interactive task of the burst
+    REQUIRE(tasks.order[7] == "bulk");
+  }
+
+  SECTION("pending tasks run before the executor is destroyed")
+  {
+    recorder tasks{};
+    {
+      couchbase::crypto::crypto_executor executor{ { 2 } };
+      for (int i = 0; i < 100; ++i) {
+        executor.post(tasks.task("task"), i % 2 == 0 ? crypto_priority::interactive
+                                                     : crypto_priority::bulk);
+      }
+    }
+    REQUIRE(tasks.order.size() == 100);
+  }
+
+  SECTION("failing tasks do not stop the workers")
+  {
+    recorder tasks{};
+    {
+      couchbase::crypto::crypto_executor executor{ { 1 } };
+      executor.post([] {
+        throw std::runtime_error("failed");
+      });
+      executor.post(tasks.task("after"));
+    }
+    REQUIRE(tasks.order == std::vector<std::string>{ "after" });
+  }
+
+  SECTION("empty tasks are rejected")
+  {
+    recorder tasks{};
+    {
+      couchbase::crypto::crypto_executor executor{ { 1 } };
+      REQUIRE_THROWS_AS(executor.post({}), std::invalid_argument);
+      REQUIRE_THROWS_AS(executor.post(std::function<void()>{}, crypto_priority::bulk),
+                        std::invalid_argument);
+      executor.post(tasks.task("after"));
+    }
+    REQUIRE(tasks.order == std::vector<std::string>{ "after" });
+  }
+
+  SECTION("documents above either threshold are offloaded")
+  {
+    const couchbase::crypto::crypto_executor executor{ { 1, 1024, 4 } };
+    REQUIRE_FALSE(executor.should_offload(1023, 3));
+    REQUIRE(executor.should_offload(1024, 0));
+    REQUIRE(executor.should_offload(10, 4));
+  }
+}
@@ -12,14 +12,22 @@
 
 #include <couchbase/codec/tao_json_serializer.hxx>
 #include <couchbase_encryption/aead_aes_256_cbc_hmac_sha512_provider.hxx>
+#include <couchbase_encryption/aead_aes_siv_cmac_512_provider.hxx>
+#include <couchbase_encryption/blind_indexer.hxx>
+#include <couchbase_encryption/crypto_executor.hxx>
 #include <couchbase_encryption/default_manager.hxx>
 #include <couchbase_encryption/default_transcoder.hxx>
 #include <couchbase_encryption/encrypted_fields.hxx>
 #include <couchbase_encryption/insecure_keyring.hxx>
 
+#include <tao/json/cbor.hpp>
+#include <tao/json/msgpack.hpp>
 #include <tao/json/to_string.hpp>
 #include <tao/json/value.hpp>
 
+#include <future>
+#include <thread>
+
 struct doc {
   std::string maxim;
 
@@ -66,6 +74,7 @@ make_crypto_manager() -> std::shared_ptr<couchbase::crypto::default_manager>
 {
   auto keyring = std::make_shared<couchbase::crypto::insecure_keyring>();
   keyring->add_key(couchbase::crypto::key("test-key", KEY));
+  keyring->add_key(couchbase::crypto::key("index-key", test::utils::make_bytes({ 0x2a, 0x43 })));
 
   auto provider = couchbase::crypto::aead_aes_256_cbc_hmac_sha512_provider(keyring);
 
@@ -73,6 +82,8 @@ make_crypto_manager() -> std::shared_ptr<couchbase::crypto::default_manager>
   manager->register_default_encrypter(provider.encrypter_for_key("test-key"));
   manager->register_encrypter("one", provider.encrypter_for_key("test-key"));
   manager->register_decrypter(provider.decrypter());
+  manager->register_default_blind_indexer(
+    std::make_shared<couchbase::crypto::hmac_sha512_blind_indexer>("index-key", keyring));
 
   return manager;
 }
@@ -357,3 +368,811 @@ TEST_CASE("unit: crypto transcoder with document that has nested encrypted field
 
   REQUIRE(p == couchbase::crypto::default_transcoder::decode<person>(encoded, crypto_manager));
 }
+
+struct customer {
+  std::string name;
+  std::string ssn;
+
+  auto operator==(const customer& other) const -> bool
+  {
+    return name == other.name && ssn == other.ssn;
+  }
+
+  inline static const std::vector<couchbase::crypto::encrypted_field> encrypted_fields{
+    {
+      /* .field_path = */ { "ssn" },
+      /* .encrypter_alias = */ {},
+      /* .blind_index = */ couchbase::crypto::blind_index_options{ {}, 16 },
+    },
+  };
+};
+
+template<>
+struct tao::json::traits<customer> {
+  template<template<typename...> class Traits>
+  static void assign(tao::json::basic_value<Traits>& v, const customer& c)
+  {
+    v = { { "name", c.name }, { "ssn", c.ssn } };
+  }
+
+  template<template<typename...> class Traits>
+  static auto as(const tao::json::basic_value<Traits>& v) -> customer
+  {
+    customer c;
+    c.name = v.at("name").get_string();
+    c.ssn = v.at("ssn").get_string();
+    return c;
+  }
+};
+
+TEST_CASE("unit: crypto transcoder with blind index", "[unit]")
+{
+  const auto crypto_manager = make_crypto_manager();
+
+  const customer alice{ "Alice", "123-45-6789" };
+  const customer bob{ "Bob", "123-45-6789" };
+
+  const auto alice_encoded = couchbase::crypto::default_transcoder::encode(alice, crypto_manager);
+  const auto bob_encoded = couchbase::crypto::default_transcoder::encode(bob, crypto_manager);
+
+  auto alice_json =
+    couchbase::codec::tao_json_serializer::deserialize<tao::json::value>(alice_encoded.data);
+  auto bob_json =
+    couchbase::codec::tao_json_serializer::deserialize<tao::json::value>(bob_encoded.data);
+  REQUIRE(alice_json.find("ssn") == nullptr);
+  const auto& alice_node = alice_json.at("encrypted$ssn");
+  const auto& bob_node = bob_json.at("encrypted$ssn");
+  REQUIRE(alice_node.get_object().size() == 4);
+
+  // the ciphertexts differ, but the blind index tokens match
+  REQUIRE(alice_node.at("ciphertext") != bob_node.at("ciphertext"));
+  REQUIRE(alice_node.at("bix").get_string() == bob_node.at("bix").get_string());
+
+  const auto [err, token] = couchbase::crypto::blind_index_token(
+    crypto_manager,
+    couchbase::codec::tao_json_serializer::serialize(std::string{ "123-45-6789" }),
+    customer::encrypted_fields.at(0).blind_index.value());
+  REQUIRE_NO_ERROR(err);
+  REQUIRE(alice_node.at("bix").get_string() == token);
+
+  REQUIRE(alice ==
+          couchbase::crypto::default_transcoder::decode<customer>(alice_encoded, crypto_manager));
+  const auto decoded_json = couchbase::crypto::default_transcoder::decode<tao::json::value>(
+    alice_encoded, crypto_manager);
+  REQUIRE(decoded_json.get_object().size() == 2);
+  REQUIRE(decoded_json.at("ssn").get_string() == "123-45-6789");
+}
+
+TEST_CASE("unit: crypto transcoder with binary document formats", "[unit]")
+{
+  const auto crypto_manager = make_crypto_manager();
+
+  const doc d{ "The enemy knows the system." };
+  const auto json_encoded = couchbase::crypto::default_transcoder::encode(d, crypto_manager);
+
+  SECTION("CBOR")
+  {
+    const auto encoded = couchbase::crypto::cbor_transcoder::encode(d, crypto_manager);
+    REQUIRE(encoded.flags == couchbase::codec::codec_flags::binary_common_flags);
+    REQUIRE(encoded.data.size() < json_encoded.data.size());
+
+    const auto encrypted_document = tao::json::cbor::from_string(
+      std::string_view{ reinterpret_cast<const char*>(encoded.data.data()), encoded.data.size() });
+    REQUIRE(encrypted_document.find("maxim") == nullptr);
+    const auto& encrypted_node = encrypted_document.at("encrypted$maxim");
+    REQUIRE(encrypted_node.at("ciphertext").is_binary());
+    REQUIRE(encrypted_node.at("kid").get_string() == "test-key");
+    REQUIRE(encrypted_node.at("alg").get_string() == "AEAD_AES_256_CBC_HMAC_SHA512");
+
+    REQUIRE(d == couchbase::crypto::cbor_transcoder::decode<doc>(encoded, crypto_manager));
+    REQUIRE_THROWS_AS(couchbase::crypto::default_transcoder::decode<doc>(encoded, crypto_manager),
+                      std::system_error);
+  }
+
+  SECTION("MessagePack")
+  {
+    const auto encoded = couchbase::crypto::msgpack_transcoder::encode(d, crypto_manager);
+    REQUIRE(encoded.flags == couchbase::codec::codec_flags::binary_common_flags);
+    REQUIRE(encoded.data.size() < json_encoded.data.size());
+
+    const auto encrypted_document = tao::json::msgpack::from_string(
+      std::string_view{ reinterpret_cast<const char*>(encoded.data.data()), encoded.data.size() });
+    REQUIRE(encrypted_document.at("encrypted$maxim").at("ciphertext").is_binary());
+
+    REQUIRE(d == couchbase::crypto::msgpack_transcoder::decode<doc>(encoded, crypto_manager));
+  }
+
+  SECTION("JSON documents are rejected")
+  {
+    REQUIRE_THROWS_AS(
+      couchbase::crypto::cbor_transcoder::decode<doc>(json_encoded, crypto_manager),
+      std::system_error);
+  }
+}
+
+template<typename Transcoder>
+void
+require_malformed_documents_are_reported(const couchbase::codec::encoded_value& valid,
+                                         const std::vector<std::byte>& garbage,
+                                         const std::shared_ptr<couchbase::crypto::manager>& manager)
+{
+  const auto truncated = couchbase::codec::encoded_value{
+    { valid.data.begin(), valid.data.begin() + static_cast<std::ptrdiff_t>(valid.data.size() / 2) },
+    valid.flags
+  };
+  const auto invalid = couchbase::codec::encoded_value{ garbage, valid.flags };
+
+  for (const auto& malformed : { truncated, invalid }) {
+    auto [err, decoded] = Transcoder::template try_decode<doc>(malformed, manager);
+    REQUIRE(err.ec() == couchbase::errc::field_level_encryption::decryption_failure);
+  }
+
+  auto results = Transcoder::template try_decode_many<doc>({ valid, truncated, invalid }, manager);
+  REQUIRE(results.size() == 3);
+  REQUIRE_NO_ERROR(results[0].first);
+  REQUIRE(results[0].second.maxim == "The enemy knows the system.");
+  REQUIRE(results[1].first.ec() == couchbase::errc::field_level_encryption::decryption_failure);
+  REQUIRE(results[2].first.ec() == couchbase::errc::field_level_encryption::decryption_failure);
+
+  REQUIRE_THROWS_AS(Transcoder::template decode_many<doc>({ valid, truncated }, manager),
+                    std::system_error);
+}
+
+TEST_CASE("unit: crypto transcoder reports malformed binary documents", "[unit]")
+{
+  const auto crypto_manager = make_crypto_manager();
+  const doc d{ "The enemy knows the system." };
+
+  SECTION("CBOR")
+  {
+    // 0xff is a break code outside of an indefinite-length item
+    require_malformed_documents_are_reported<couchbase::crypto::cbor_transcoder>(
+      couchbase::crypto::cbor_transcoder::encode(d, crypto_manager),
+      test::utils::make_bytes({ 0xa1, 0xff, 0xff }),
+      crypto_manager);
+  }
+
+  SECTION("MessagePack")
+  {
+    // 0xc1 is never used
+    require_malformed_documents_are_reported<couchbase::crypto::msgpack_transcoder>(
+      couchbase::crypto::msgpack_transcoder::encode(d, crypto_manager),
+      test::utils::make_bytes({ 0x81, 0xc1, 0xc1 }),
+      crypto_manager);
+  }
+
+  SECTION("binary values outside of encrypted fields")
+  {
+    tao::json::value document = tao::json::empty_object;
+    document["maxim"] = test::utils::make_bytes({ 0x00, 0x01, 0x02 });
+    const auto data = tao::json::cbor::to_string(document);
+    const auto* begin = reinterpret_cast<const std::byte*>(data.data());
+    const auto encoded = couchbase::codec::encoded_value{
+      { begin, begin + data.size() }, couchbase::codec::codec_flags::binary_common_flags
+    };
+
+    auto [err, decoded] =
+      couchbase::crypto::cbor_transcoder::try_decode<doc>(encoded, crypto_manager);
+    REQUIRE(err.ec() == couchbase::errc::field_level_encryption::decryption_failure);
+  }
+}
+
+TEST_CASE("unit: crypto transcoder with schema-guided decoding", "[unit]")
+{
+  const auto crypto_manager = make_crypto_manager();
+  const person p{
+    "Albert",
+    "Einstein",
+    "password123",
+    {
+      "1A",
+      {
+        "my street",
+        "my second line",
+      },
+    },
+    {
+      "cat",
+      std::map<std::string, person::pet::attribute>{
+        { "attr1", { "jump" } },
+      },
+    },
+  };
+
+  const auto encoded = couchbase::crypto::default_transcoder::encode(p, crypto_manager);
+  REQUIRE(p == couchbase::crypto::default_transcoder::decode<person>(
+                 encoded, crypto_manager, person::encrypted_fields));
+
+  // fields that are not part of the schema are left encrypted
+  const std::vector<couchbase::crypto::encrypted_field> password_only{ { { "password" } } };
+  const auto decoded = couchbase::crypto::default_transcoder::decode<tao::json::value>(
+    encoded, crypto_manager, password_only);
+  REQUIRE(decoded.at("password").get_string() == "password123");
+  test::utils::ensure_field_is_encrypted(decoded, "address");
+}
+
+TEST_CASE("unit: crypto transcoder reuses unchanged encrypted fields", "[unit]")
+{
+  const auto crypto_manager = make_crypto_manager();
+  person p{
+    "Albert",
+    "Einstein",
+    "password123",
+    {
+      "1A",
+      {
+        "my street",
+        "my second line",
+      },
+    },
+    {
+      "cat",
+      std::map<std::string, person::pet::attribute>{
+        { "attr1", { "jump" } },
+      },
+    },
+  };
+
+  const auto encoded = couchbase::crypto::default_transcoder::encode(p, crypto_manager);
+  const auto original =
+    couchbase::codec::tao_json_serializer::deserialize<tao::json::value>(encoded.data);
+
+  couchbase::crypto::decode_handle handle{};
+  auto decoded =
+    couchbase::crypto::default_transcoder::decode<person>(encoded, crypto_manager, handle);
+  REQUIRE(decoded == p);
+  REQUIRE(handle.size() == 3);
+
+  SECTION("unchanged fields keep their ciphertext")
+  {
+    decoded.first_name = "Alfred";
+    const auto reencoded =
+      couchbase::crypto::default_transcoder::encode(decoded, crypto_manager, handle);
+    const auto json =
+      couchbase::codec::tao_json_serializer::deserialize<tao::json::value>(reencoded.data);
+    REQUIRE(json.at("first_name").get_string() == "Alfred");
+    REQUIRE(json.at("encrypted$password") == original.at("encrypted$password"));
+    REQUIRE(json.at("encrypted$address") == original.at("encrypted$address"));
+    REQUIRE(json.at("pet").at("encrypted$attributes") ==
+            original.at("pet").at("encrypted$attributes"));
+  }
+
+  SECTION("changed fields are encrypted again")
+  {
+    decoded.password = "password456";
+    const auto reencoded =
+      couchbase::crypto::default_transcoder::encode(decoded, crypto_manager, handle);
+    const auto json =
+      couchbase::codec::tao_json_serializer::deserialize<tao::json::value>(reencoded.data);
+    REQUIRE(json.at("encrypted$password") != original.at("encrypted$password"));
+    REQUIRE(json.at("encrypted$address") == original.at("encrypted$address"));
+    REQUIRE(decoded ==
+            couchbase::crypto::default_transcoder::decode<person>(reencoded, crypto_manager));
+  }
+
+  SECTION("encoding without the handle encrypts every field")
+  {
+    const auto reencoded = couchbase::crypto::default_transcoder::encode(decoded, crypto_manager);
+    const auto json =
+      couchbase::codec::tao_json_serializer::deserialize<tao::json::value>(reencoded.data);
+    REQUIRE(json.at("encrypted$password") != original.at("encrypted$password"));
+  }
+}
+
+TEST_CASE("unit: crypto transcoder encrypts fields again when their configuration changes",
+          "[unit]")
+{
+  auto keyring = std::make_shared<couchbase::crypto::insecure_keyring>();
+  keyring->add_key(couchbase::crypto::key("test-key", KEY));
+  keyring->add_key(couchbase::crypto::key("other-key", KEY));
+  keyring->add_key(couchbase::crypto::key("index-key", test::utils::make_bytes({ 0x2a, 0x43 })));
+  auto provider = couchbase::crypto::aead_aes_256_cbc_hmac_sha512_provider(keyring);
+  auto crypto_manager = std::make_shared<couchbase::crypto::default_manager>();
+  crypto_manager->register_default_encrypter(provider.encrypter_for_key("test-key"));
+  crypto_manager->register_encrypter("one", provider.encrypter_for_key("test-key"));
+  crypto_manager->register_encrypter("other", provider.encrypter_for_key("other-key"));
+  crypto_manager->register_decrypter(provider.decrypter());
+  crypto_manager->register_default_blind_indexer(
+    std::make_shared<couchbase::crypto::hmac_sha512_blind_indexer>("index-key", keyring));
+
+  const auto content = couchbase::crypto::document<tao::json::value>::from(
+    { { "maxim", "The enemy knows the system." } });
+  const auto reencode = [&](const couchbase::crypto::document<tao::json::value>& before,
+                            const couchbase::crypto::document<tao::json::value>& after) {
+    const auto encoded = couchbase::crypto::default_transcoder::encode(before, crypto_manager);
+    couchbase::crypto::decode_handle handle{};
+    const auto decoded = couchbase::crypto::default_transcoder::decode<tao::json::value>(
+      encoded, crypto_manager, handle);
+    REQUIRE(decoded == content.content());
+    const auto reencoded =
+      couchbase::crypto::default_transcoder::encode(after, crypto_manager, handle);
+    return std::make_pair(
+      couchbase::codec::tao_json_serializer::deserialize<tao::json::value>(encoded.data)
+        .at("encrypted$maxim"),
+      couchbase::codec::tao_json_serializer::deserialize<tao::json::value>(reencoded.data)
+        .at("encrypted$maxim"));
+  };
+  auto with_field = [&content](std::optional<std::string> alias,
+                               std::optional<couchbase::crypto::blind_index_options> index) {
+    auto document = content;
+    document.with_encrypted_field({ "maxim" }, std::move(alias), std::move(index));
+    return document;
+  };
+
+  SECTION("an alias of the same key keeps the ciphertext")
+  {
+    const auto [before, after] = reencode(with_field({}, {}), with_field("one", {}));
+    REQUIRE(after == before);
+  }
+
+  SECTION("an alias of another key encrypts the field again")
+  {
+    const auto [before, after] = reencode(with_field({}, {}), with_field("other", {}));
+    REQUIRE(after != before);
+    REQUIRE(after.at("kid").get_string() == "other-key");
+  }
+
+  SECTION("adding a blind index encrypts the field again")
+  {
+    const auto [before, after] =
+      reencode(with_field({}, {}), with_field({}, couchbase::crypto::blind_index_options{}));
+    REQUIRE(after != before);
+    REQUIRE(after.find("bix") != nullptr);
+  }
+
+  SECTION("changing a blind index encrypts the field again")
+  {
+    const auto [before, after] =
+      reencode(with_field({}, couchbase::crypto::blind_index_options{}),
+               with_field({}, couchbase::crypto::blind_index_options{ {}, 16 }));
+    REQUIRE(after != before);
+    REQUIRE(after.at("bix") != before.at("bix"));
+  }
+
+  SECTION("removing a blind index encrypts the field again")
+  {
+    const auto [before, after] =
+      reencode(with_field({}, couchbase::crypto::blind_index_options{}), with_field({}, {}));
+    REQUIRE(before.find("bix") != nullptr);
+    REQUIRE(after.find("bix") == nullptr);
+  }
+}
+
+TEST_CASE("unit: crypto transcoder preserves the order of members", "[unit]")
+{
+  const std::shared_ptr<couchbase::crypto::manager> crypto_manager = make_crypto_manager();
+  const std::string document{ R"({"b":1,"password":"secret","a":{"y":2.50,"x":"é"}})" };
+  const std::vector<couchbase::crypto::encrypted_field> encrypted_fields{
+    { { "password" } },
+    { { "a", "x" } },
+  };
+
+  const auto* begin = reinterpret_cast<const std::byte*>(document.data());
+  const auto [encrypt_err, encrypted] = couchbase::crypto::internal::encrypt(
+    { begin, begin + document.size() }, encrypted_fields, crypto_manager);
+  REQUIRE_NO_ERROR(encrypt_err);
+  const auto encrypted_text = test::utils::to_string(encrypted);
+  REQUIRE(encrypted_text.find(R"({"b":1,"encrypted$password":{)") == 0);
+  REQUIRE(encrypted_text.find(R"("a":{"y":2.50,"encrypted$x":{)") != std::string::npos);
+
+  // numbers and escaped strings are copied as they were written
+  const auto [decrypt_err, decrypted] =
+    couchbase::crypto::internal::decrypt(encrypted, crypto_manager);
+  REQUIRE_NO_ERROR(decrypt_err);
+  REQUIRE(test::utils::to_string(decrypted) == document);
+}
+
+namespace
+{
+class prefetch_recording_keyring : public couchbase::crypto::insecure_keyring
+{
+public:
+  void prefetch(const std::vector<std::string>& key_ids) const override
+  {
+    prefetched.push_back(key_ids);
+  }
+
+  mutable std::vector<std::vector<std::string>> prefetched{};
+};
+} // namespace
+
+TEST_CASE("unit: crypto transcoder decodes a batch of documents", "[unit]")
+{
+  auto keyring = std::make_shared<prefetch_recording_keyring>();
+  keyring->add_key(couchbase::crypto::key("test-key", KEY));
+  keyring->add_key(couchbase::crypto::key("other-key", KEY));
+  auto provider = couchbase::crypto::aead_aes_256_cbc_hmac_sha512_provider(keyring);
+  auto crypto_manager = std::make_shared<couchbase::crypto::default_manager>();
+  crypto_manager->register_default_encrypter(provider.encrypter_for_key("test-key"));
+  crypto_manager->register_encrypter("other", provider.encrypter_for_key("other-key"));
+  crypto_manager->register_decrypter(provider.decrypter());
+
+  const std::vector<doc> docs{
+    { "The enemy knows the system." },
+    { "Security through obscurity is no security." },
+    { "The enemy knows the system." },
+  };
+  std::vector<couchbase::codec::encoded_value> encoded{};
+  for (const auto& d : docs) {
+    encoded.push_back(couchbase::crypto::default_transcoder::encode(d, crypto_manager));
+  }
+  const auto other_document =
+    couchbase::crypto::document<tao::json::value>::from({ { "maxim", "Keys are rotated." } })
+      .with_encrypted_field({ "maxim" }, "other");
+  encoded.push_back(couchbase::crypto::default_transcoder::encode(other_document, crypto_manager));
+
+  const auto decoded =
+    couchbase::crypto::default_transcoder::decode_many<doc>(encoded, crypto_manager);
+  REQUIRE(decoded.size() == 4);
+  for (std::size_t i = 0; i < docs.size(); ++i) {
+    REQUIRE(decoded[i] == docs[i]);
+  }
+  REQUIRE(decoded[3].maxim == "Keys are rotated.");
+
+  // every key the batch uses is announced once, before anything is decrypted
+  REQUIRE(keyring->prefetched.size() == 1);
+  REQUIRE(keyring->prefetched[0] == std::vector<std::string>{ "test-key", "other-key" });
+
+  encoded.push_back(couchbase::codec::encoded_value{
+    test::utils::make_bytes({ 0x7b }), couchbase::codec::codec_flags::json_common_flags });
+  REQUIRE_THROWS_AS(
+    couchbase::crypto::default_transcoder::decode_many<doc>(encoded, crypto_manager),
+    std::system_error);
+}
+
+TEST_CASE("unit: crypto transcoder reports failures without throwing", "[unit]")
+{
+  auto keyring = std::make_shared<couchbase::crypto::insecure_keyring>();
+  keyring->add_key(couchbase::crypto::key("test-key", KEY));
+  auto provider = couchbase::crypto::aead_aes_256_cbc_hmac_sha512_provider(keyring);
+  auto crypto_manager = std::make_shared<couchbase::crypto::default_manager>();
+  crypto_manager->register_default_encrypter(provider.encrypter_for_key("test-key"));
+  crypto_manager->register_encrypter("revoked", provider.encrypter_for_key("revoked-key"));
+  crypto_manager->register_decrypter(provider.decrypter());
+
+  const doc d{ "The enemy knows the system." };
+  auto [encode_err, encoded] = couchbase::crypto::default_transcoder::try_encode(d, crypto_manager);
+  REQUIRE_NO_ERROR(encode_err);
+
+  {
+    auto [err, decoded] =
+      couchbase::crypto::default_transcoder::try_decode<doc>(encoded, crypto_manager);
+    REQUIRE_NO_ERROR(err);
+    REQUIRE(decoded == d);
+  }
+
+  {
+    const auto revoked_document =
+      couchbase::crypto::document<tao::json::value>::from({ { "maxim", "Keys are revoked." } })
+        .with_encrypted_field({ "maxim" }, "revoked");
+    auto [err, revoked_encoded] =
+      couchbase::crypto::default_transcoder::try_encode(revoked_document, crypto_manager);
+    REQUIRE(err.ec() == couchbase::errc::field_level_encryption::crypto_key_not_found);
+  }
+
+  {
+    // encrypted with a key that the reading side no longer has, e.g. because it was revoked
+    keyring->add_key(couchbase::crypto::key("revoked-key", KEY));
+    const auto revoked_encoded = couchbase::crypto::default_transcoder::encode(
+      couchbase::crypto::document<tao::json::value>::from({ { "maxim", "Keys are revoked." } })
+        .with_encrypted_field({ "maxim" }, "revoked"),
+      crypto_manager);
+    auto other_keyring = std::make_shared<couchbase::crypto::insecure_keyring>();
+    other_keyring->add_key(couchbase::crypto::key("test-key", KEY));
+    auto other_manager = std::make_shared<couchbase::crypto::default_manager>();
+    other_manager->register_decrypter(
+      couchbase::crypto::aead_aes_256_cbc_hmac_sha512_provider(other_keyring).decrypter());
+
+    auto [err, decoded] =
+      couchbase::crypto::default_transcoder::try_decode<doc>(revoked_encoded, other_manager);
+    REQUIRE(err.ec() == couchbase::errc::field_level_encryption::crypto_key_not_found);
+
+    auto results = couchbase::crypto::default_transcoder::try_decode_many<doc>(
+      { encoded, revoked_encoded, encoded }, other_manager);
+    REQUIRE(results.size() == 3);
+    REQUIRE_NO_ERROR(results[0].first);
+    REQUIRE(results[0].second == d);
+    REQUIRE(results[1].first.ec() ==
+            couchbase::errc::field_level_encryption::crypto_key_not_found);
+    REQUIRE_NO_ERROR(results[2].first);
+
+    REQUIRE_THROWS_AS(
+      couchbase::crypto::default_transcoder::decode<doc>(revoked_encoded, other_manager),
+      std::system_error);
+  }
+
+  {
+    const auto binary = couchbase::codec::encoded_value{
+      encoded.data, couchbase::codec::codec_flags::binary_common_flags
+    };
+    auto [err, decoded] =
+      couchbase::crypto::default_transcoder::try_decode<doc>(binary, crypto_manager);
+    REQUIRE(err.ec() == couchbase::errc::common::decoding_failure);
+  }
+
+  {
+    auto [err, decoded] = couchbase::crypto::default_transcoder::try_decode<doc>(encoded, nullptr);
+    REQUIRE(err.ec() == couchbase::errc::field_level_encryption::generic_cryptography_failure);
+  }
+}
+
+TEST_CASE("unit: crypto transcoder decodes documents partially", "[unit]")
+{
+  auto keyring = std::make_shared<couchbase::crypto::insecure_keyring>();
+  keyring->add_key(couchbase::crypto::key("test-key", KEY));
+  keyring->add_key(couchbase::crypto::key("other-key", KEY));
+  auto provider = couchbase::crypto::aead_aes_256_cbc_hmac_sha512_provider(keyring);
+  auto crypto_manager = std::make_shared<couchbase::crypto::default_manager>();
+  crypto_manager->register_default_encrypter(provider.encrypter_for_key("test-key"));
+  crypto_manager->register_encrypter("other", provider.encrypter_for_key("other-key"));
+  crypto_manager->register_decrypter(provider.decrypter());
+
+  const auto encoded = couchbase::crypto::default_transcoder::encode(
+    couchbase::crypto::document<tao::json::value>::from(
+      { { "maxim", "The enemy knows the system." }, { "author", "Shannon" } })
+      .with_encrypted_field({ "maxim" })
+      .with_encrypted_field({ "author" }, "other"),
+    crypto_manager);
+
+  // a reader that only has one of the keys
+  auto reader_keyring = std::make_shared<couchbase::crypto::insecure_keyring>();
+  reader_keyring->add_key(couchbase::crypto::key("test-key", KEY));
+  auto reader_manager = std::make_shared<couchbase::crypto::default_manager>();
+  reader_manager->register_decrypter(
+    couchbase::crypto::aead_aes_256_cbc_hmac_sha512_provider(reader_keyring).decrypter());
+
+  REQUIRE_THROWS_AS(
+    couchbase::crypto::default_transcoder::decode<tao::json::value>(encoded, reader_manager),
+    std::system_error);
+
+  std::vector<couchbase::crypto::field_decryption_status> statuses{};
+  const auto decoded = couchbase::crypto::default_transcoder::decode_partially<tao::json::value>(
+    encoded, reader_manager, statuses);
+  REQUIRE(decoded.at("maxim").get_string() == "The enemy knows the system.");
+  REQUIRE(decoded.find("author") == nullptr);
+  REQUIRE(decoded.at("encrypted$author").at("kid").get_string() == "other-key");
+
+  REQUIRE(statuses.size() == 2);
+  for (const auto& status : statuses) {
+    if (status.pointer == "/maxim") {
+      REQUIRE_NO_ERROR(status.err);
+    } else {
+      REQUIRE(status.pointer == "/encrypted$author");
+      REQUIRE(status.err.ec() == couchbase::errc::field_level_encryption::crypto_key_not_found);
+    }
+  }
+
+  // the fields that were left encrypted are decrypted once the key is available
+  reader_keyring->add_key(couchbase::crypto::key("other-key", KEY));
+  statuses.clear();
+  const auto fully_decoded =
+    couchbase::crypto::default_transcoder::decode_partially<tao::json::value>(
+      encoded, reader_manager, { { { "maxim" } }, { { "author" } } }, statuses);
+  REQUIRE(fully_decoded.at("author").get_string() == "Shannon");
+  REQUIRE(statuses.size() == 2);
+  REQUIRE_NO_ERROR(statuses[0].err);
+  REQUIRE_NO_ERROR(statuses[1].err);
+}
+
+TEST_CASE("unit: crypto transcoder with compact envelopes", "[unit]")
+{
+  const auto crypto_manager = make_crypto_manager();
+  const tao::json::value content{
+    { "maxim", "The enemy knows the system." },
+    { "author", "Shannon" },
+  };
+
+  const auto compact = couchbase::crypto::default_transcoder::encode(
+    couchbase::crypto::document<tao::json::value>::from(content)
+      .with_encrypted_field({ "maxim" }, {}, {}, couchbase::crypto::envelope_format::compact)
+      .with_encrypted_field({ "author" }),
+    crypto_manager);
+  const auto json =
+    couchbase::codec::tao_json_serializer::deserialize<tao::json::value>(compact.data);
+  REQUIRE(json.at("encrypted$maxim").is_string());
+  REQUIRE(json.at("encrypted$maxim").get_string().rfind("1:test-key:", 0) == 0);
+  REQUIRE(json.at("encrypted$author").is_object());
+
+  const auto decoded =
+    couchbase::crypto::default_transcoder::decode<tao::json::value>(compact, crypto_manager);
+  REQUIRE(decoded == content);
+
+  const auto objects = couchbase::crypto::default_transcoder::encode(
+    couchbase::crypto::document<tao::json::value>::from(content)
+      .with_encrypted_field({ "maxim" })
+      .with_encrypted_field({ "author" }),
+    crypto_manager);
+  REQUIRE(compact.data.size() < objects.data.size());
+
+  SECTION("fields with a blind index are stored as objects")
+  {
+    const auto encoded = couchbase::crypto::default_transcoder::encode(
+      couchbase::crypto::document<tao::json::value>::from(content).with_encrypted_field(
+        { "maxim" },
+        {},
+        couchbase::crypto::blind_index_options{},
+        couchbase::crypto::envelope_format::compact),
+      crypto_manager);
+    const auto encoded_json =
+      couchbase::codec::tao_json_serializer::deserialize<tao::json::value>(encoded.data);
+    REQUIRE(encoded_json.at("encrypted$maxim").is_object());
+    REQUIRE(encoded_json.at("encrypted$maxim").find("bix") != nullptr);
+  }
+
+  SECTION("malformed compact envelopes are rejected")
+  {
+    const auto data = couchbase::core::utils::json::generate_binary(
+      tao::json::value{ { "encrypted$maxim", "9:test-key:AAAA" } });
+    REQUIRE_THROWS_AS(couchbase::crypto::default_transcoder::decode<tao::json::value>(
+                        couchbase::codec::encoded_value{
+                          data, couchbase::codec::codec_flags::json_common_flags },
+                        crypto_manager),
+                      std::system_error);
+  }
+}
+
+TEST_CASE("unit: crypto transcoder computes the size of encoded documents", "[unit]")
+{
+  const auto crypto_manager = make_crypto_manager();
+
+  SECTION("nested encrypted fields")
+  {
+    const person p{
+      "Albert",
+      "Einstein",
+      "password123",
+      { "1A", { "my street", "my second line" } },
+      { "cat", std::map<std::string, person::pet::attribute>{ { "attr1", { "jump" } } } },
+    };
+    const auto [err, size] = couchbase::crypto::default_transcoder::encoded_size(p, crypto_manager);
+    REQUIRE_NO_ERROR(err);
+    REQUIRE(size == couchbase::crypto::default_transcoder::encode(p, crypto_manager).data.size());
+  }
+
+  SECTION("blind indexes")
+  {
+    const customer alice{ "Alice", "123-45-6789" };
+    const auto [err, size] =
+      couchbase::crypto::default_transcoder::encoded_size(alice, crypto_manager);
+    REQUIRE_NO_ERROR(err);
+    REQUIRE(size ==
+            couchbase::crypto::default_transcoder::encode(alice, crypto_manager).data.size());
+  }
+
+  SECTION("envelopes and algorithms")
+  {
+    auto keyring = std::make_shared<couchbase::crypto::insecure_keyring>();
+    keyring->add_key(couchbase::crypto::key("siv-key", KEY));
+    const couchbase::crypto::aead_aes_siv_cmac_512_provider siv_provider{ keyring };
+    crypto_manager->register_encrypter("siv", siv_provider.encrypter_for_key("siv-key"));
+
+    // every plaintext size up to two AES blocks, to cover the padding and base64 boundaries
+    for (std::size_t length = 0; length < 34; ++length) {
+      const tao::json::value content{
+        { "maxim", std::string(length, 'x') },
+        { "author", "Shannon" },
+      };
+      const auto document =
+        couchbase::crypto::document<tao::json::value>::from(content)
+          .with_encrypted_field({ "maxim" }, {}, {}, couchbase::crypto::envelope_format::compact)
+          .with_encrypted_field({ "author" }, "siv");
+      const auto [err, size] =
+        couchbase::crypto::default_transcoder::encoded_size(document, crypto_manager);
+      REQUIRE_NO_ERROR(err);
+      REQUIRE(size ==
+              couchbase::crypto::default_transcoder::encode(document, crypto_manager).data.size());
+    }
+  }
+
+  SECTION("unknown encrypter aliases are reported")
+  {
+    const auto document =
+      couchbase::crypto::document<tao::json::value>::from(tao::json::value{ { "maxim", "x" } })
+        .with_encrypted_field({ "maxim" }, "missing");
+    const auto [err, size] =
+      couchbase::crypto::default_transcoder::encoded_size(document, crypto_manager);
+    REQUIRE(err.ec() == couchbase::errc::field_level_encryption::encrypter_not_found);
+  }
+}
+
+namespace
+{
+class throwing_encrypter : public couchbase::crypto::encrypter
+{
+public:
+  auto encrypt(std::vector<std::byte> /* plaintext */)
+    -> std::pair<couchbase::error, couchbase::crypto::encryption_result> override
+  {
+    throw std::runtime_error("the encrypter failed");
+  }
+};
+} // namespace
+
+TEST_CASE("unit: crypto transcoder encodes and decodes on a crypto executor", "[unit]")
+{
+  const auto crypto_manager = make_crypto_manager();
+  const doc d{ "The enemy knows the system." };
+
+  SECTION("small documents stay on the calling thread")
+  {
+    couchbase::crypto::crypto_executor executor{};
+    const auto caller = std::this_thread::get_id();
+    std::thread::id encoded_on{};
+    couchbase::codec::encoded_value encoded{};
+    couchbase::crypto::default_transcoder::encode_async(
+      d,
+      crypto_manager,
+      executor,
+      [&](couchbase::error err, couchbase::codec::encoded_value value) {
+        REQUIRE_NO_ERROR(err);
+        encoded_on = std::this_thread::get_id();
+        encoded = std::move(value);
+      });
+    REQUIRE(encoded_on == caller);
+
+    std::thread::id decoded_on{};
+    couchbase::crypto::default_transcoder::decode_async<doc>(
+      encoded, crypto_manager, executor, [&](couchbase::error err, doc decoded) {
+        REQUIRE_NO_ERROR(err);
+        REQUIRE(decoded == d);
+        decoded_on = std::this_thread::get_id();
+      });
+    REQUIRE(decoded_on == caller);
+  }
+
+  SECTION("documents with enough encrypted fields go to the workers")
+  {
+    couchbase::crypto::crypto_executor executor{ { 1, 1024 * 1024, 1 } };
+    auto [encode_err, encoded] =
+      couchbase::crypto::default_transcoder::encode_future(
+        d, crypto_manager, executor, couchbase::crypto::crypto_priority::bulk)
+        .get();
+    REQUIRE_NO_ERROR(encode_err);
+
+    auto [decode_err, decoded] =
+      couchbase::crypto::default_transcoder::decode_future<doc>(encoded, crypto_manager, executor)
+        .get();
+    REQUIRE_NO_ERROR(decode_err);
+    REQUIRE(decoded == d);
+  }
+
+  SECTION("large documents go to the workers")
+  {
+    couchbase::crypto::crypto_executor executor{ { 1, 1, 1024 } };
+    const auto caller = std::this_thread::get_id();
+    const auto encoded = couchbase::crypto::default_transcoder::encode(d, crypto_manager);
+    auto decoded_on = std::make_shared<std::promise<std::thread::id>>();
+    couchbase::crypto::default_transcoder::decode_async<doc>(
+      encoded, crypto_manager, executor, [decoded_on](couchbase::error err, doc decoded) {
+        decoded_on->set_value(err || decoded.maxim.empty() ? std::thread::id{}
+                                                           : std::this_thread::get_id());
+      });
+    const auto worker = decoded_on->get_future().get();
+    REQUIRE(worker != std::thread::id{});
+    REQUIRE(worker != caller);
+  }
+
+  SECTION("failures are delivered to the handler")
+  {
+    couchbase::crypto::crypto_executor executor{ { 1, 1, 1 } };
+    const auto encoded = couchbase::crypto::default_transcoder::encode(d, crypto_manager);
+    auto [err, decoded] =
+      couchbase::crypto::default_transcoder::decode_future<doc>(encoded, nullptr, executor).get();
+    REQUIRE(err.ec() == couchbase::errc::field_level_encryption::generic_cryptography_failure);
+  }
+
+  SECTION("exceptions of the encrypter are delivered to the handler")
+  {
+    auto throwing_manager = std::make_shared<couchbase::crypto::default_manager>();
+    throwing_manager->register_default_encrypter(std::make_shared<throwing_encrypter>());
+
+    for (const std::size_t min_encrypted_fields : { 1, 1024 }) {
+      INFO(min_encrypted_fields);
+      couchbase::crypto::crypto_executor executor{ { 1, 1024 * 1024, min_encrypted_fields } };
+      auto [err, encoded] =
+        couchbase::crypto::default_transcoder::encode_future(d, throwing_manager, executor).get();
+      REQUIRE(err.ec() == couchbase::errc::field_level_encryption::encryption_failure);
+      REQUIRE(err.message().find("the encrypter failed") != std::string::npos);
+    }
+  }
+}
@@ -9,7 +9,12 @@
 #include "test_helper.hxx"
 
 #include <couchbase/error_codes.hxx>
+#include <couchbase_encryption/caching_keyring.hxx>
 #include <couchbase_encryption/insecure_keyring.hxx>
+#include <couchbase_encryption/keyring_chain.hxx>
+
+#include <chrono>
+#include <tuple>
 
 TEST_CASE("unit: insecure keyring", "[unit]")
 {
@@ -26,6 +31,7 @@ TEST_CASE("unit: insecure keyring", "[unit]")
   {
     auto [err, key] = keyring->get("test-key-2");
     REQUIRE(err.ec() == couchbase::errc::field_level_encryption::crypto_key_not_found);
+    REQUIRE(err.message() == "Key not found: test-key-2");
   }
 
   {
@@ -36,3 +42,231 @@ TEST_CASE("unit: insecure keyring", "[unit]")
     REQUIRE(key.bytes() == test::utils::make_bytes({ 0x51, 0x1b }));
   }
 }
+
+namespace
+{
+class counting_keyring : public couchbase::crypto::keyring
+{
+public:
+  explicit counting_keyring(std::shared_ptr<couchbase::crypto::keyring> backing)
+    : backing_{ std::move(backing) }
+  {
+  }
+
+  [[nodiscard]] auto get(const std::string& key_id) const
+    -> std::pair<couchbase::error, couchbase::crypto::key> override
+  {
+    ++calls;
+    return backing_->get(key_id);
+  }
+
+  [[nodiscard]] auto get_many(const std::vector<std::string>& key_ids) const
+    -> std::vector<std::pair<couchbase::error, couchbase::crypto::key>> override
+  {
+    ++batch_calls;
+    return backing_->get_many(key_ids);
+  }
+
+  mutable std::size_t calls{ 0 };
+  mutable std::size_t batch_calls{ 0 };
+
+private:
+  std::shared_ptr<couchbase::crypto::keyring> backing_;
+};
+
+class failing_keyring : public couchbase::crypto::keyring
+{
+public:
+  [[nodiscard]] auto get(const std::string& /* key_id */) const
+    -> std::pair<couchbase::error, couchbase::crypto::key> override
+  {
+    ++calls;
+    return {
+      couchbase::error{ couchbase::errc::field_level_encryption::generic_cryptography_failure,
+                        "key management service is unavailable" },
+      {},
+    };
+  }
+
+  mutable std::size_t calls{ 0 };
+};
+} // namespace
+
+TEST_CASE("unit: keyring chain", "[unit]")
+{
+  const auto local = std::make_shared<couchbase::crypto::insecure_keyring>(
+    std::vector{ couchbase::crypto::key("local-key", test::utils::make_bytes({ 0x2a, 0x43 })) });
+  const auto remote = std::make_shared<couchbase::crypto::insecure_keyring>(std::vector{
+    couchbase::crypto::key("local-key", test::utils::make_bytes({ 0x00 })),
+    couchbase::crypto::key("remote-key", test::utils::make_bytes({ 0x51, 0x1b })),
+  });
+
+  const couchbase::crypto::keyring_chain chain({ local, remote });
+
+  {
+    auto [err, key] = chain.get("local-key");
+    REQUIRE_NO_ERROR(err);
+    REQUIRE(key.bytes() == test::utils::make_bytes({ 0x2a, 0x43 }));
+  }
+
+  {
+    auto [err, key] = chain.get("remote-key");
+    REQUIRE_NO_ERROR(err);
+    REQUIRE(key.bytes() == test::utils::make_bytes({ 0x51, 0x1b }));
+  }
+
+  {
+    auto [err, key] = chain.get("missing-key");
+    REQUIRE(err.ec() == couchbase::errc::field_level_encryption::crypto_key_not_found);
+    REQUIRE(err.message() == "Key not found: missing-key");
+  }
+
+  {
+    const auto failing = std::make_shared<failing_keyring>();
+    const couchbase::crypto::keyring_chain chain_with_failure({ failing, remote });
+    auto [err, key] = chain_with_failure.get("remote-key");
+    REQUIRE(err.ec() == couchbase::errc::field_level_encryption::generic_cryptography_failure);
+  }
+
+  {
+    const auto counting = std::make_shared<counting_keyring>(remote);
+    const couchbase::crypto::keyring_chain counting_chain({ local, counting });
+    auto results = counting_chain.get_many({ "remote-key", "missing-key", "local-key" });
+    REQUIRE(results.size() == 3);
+    REQUIRE_NO_ERROR(results[0].first);
+    REQUIRE(results[0].second.bytes() == test::utils::make_bytes({ 0x51, 0x1b }));
+    REQUIRE(results[1].first.ec() ==
+            couchbase::errc::field_level_encryption::crypto_key_not_found);
+    REQUIRE(results[1].first.message() == "Key not found: missing-key");
+    REQUIRE_NO_ERROR(results[2].first);
+    REQUIRE(results[2].second.bytes() == test::utils::make_bytes({ 0x2a, 0x43 }));
+    // the second keyring is only asked for the keys the first one did not have, all at once
+    REQUIRE(counting->batch_calls == 1);
+    REQUIRE(counting->calls == 0);
+  }
+}
+
+TEST_CASE("unit: caching keyring", "[unit]")
+{
+  const auto backing = std::make_shared<couchbase::crypto::insecure_keyring>(
+    std::vector{ couchbase::crypto::key("test-key", test::utils::make_bytes({ 0x2a, 0x43 })) });
+  const auto counting = std::make_shared<counting_keyring>(backing);
+
+  SECTION("keys are served from the cache")
+  {
+    couchbase::crypto::caching_keyring keyring(counting);
+    for (int i = 0; i < 3; ++i) {
+      auto [err, key] = keyring.get("test-key");
+      REQUIRE_NO_ERROR(err);
+      REQUIRE(key.bytes() == test::utils::make_bytes({ 0x2a, 0x43 }));
+    }
+    REQUIRE(counting->calls == 1);
+
+    keyring.invalidate("test-key");
+    auto [err, key] = keyring.get("test-key");
+    REQUIRE_NO_ERROR(err);
+    REQUIRE(counting->calls == 2);
+  }
+
+  SECTION("missing keys are served from the cache")
+  {
+    couchbase::crypto::caching_keyring keyring(counting);
+    for (int i = 0; i < 3; ++i) {
+      auto [err, key] = keyring.get("missing-key");
+      REQUIRE(err.ec() == couchbase::errc::field_level_encryption::crypto_key_not_found);
+      REQUIRE(err.message() == "Key not found: missing-key");
+    }
+    REQUIRE(counting->calls == 1);
+
+    backing->add_key(couchbase::crypto::key("missing-key", test::utils::make_bytes({ 0x51 })));
+    keyring.invalidate("missing-key");
+    auto [err, key] = keyring.get("missing-key");
+    REQUIRE_NO_ERROR(err);
+    REQUIRE(key.bytes() == test::utils::make_bytes({ 0x51 }));
+    REQUIRE(counting->calls == 2);
+  }
+
+  SECTION("expired entries are fetched again")
+  {
+    couchbase::crypto::caching_keyring_options options{};
+    options.key_ttl = std::chrono::milliseconds{ 0 };
+    options.missing_key_ttl = std::chrono::milliseconds{ 0 };
+    couchbase::crypto::caching_keyring keyring(counting, options);
+    std::ignore = keyring.get("test-key");
+    std::ignore = keyring.get("test-key");
+    std::ignore = keyring.get("missing-key");
+    std::ignore = keyring.get("missing-key");
+    REQUIRE(counting->calls == 4);
+  }
+
+  SECTION("number of missing keys is bounded")
+  {
+    couchbase::crypto::caching_keyring_options options{};
+    options.max_missing_keys = 2;
+    couchbase::crypto::caching_keyring keyring(counting, options);
+    std::ignore = keyring.get("missing-1");
+    std::ignore = keyring.get("missing-2");
+    std::ignore = keyring.get("missing-3");
+    REQUIRE(counting->calls == 3);
+
+    // missing-1 was the least recently used, and has been evicted
+    std::ignore = keyring.get("missing-3");
+    std::ignore = keyring.get("missing-2");
+    REQUIRE(counting->calls == 3);
+    std::ignore = keyring.get("missing-1");
+    REQUIRE(counting->calls == 4);
+  }
+
+  SECTION("keys are retrieved together")
+  {
+    couchbase::crypto::caching_keyring keyring(counting);
+    std::ignore = keyring.get("test-key");
+    REQUIRE(counting->calls == 1);
+
+    auto results = keyring.get_many({ "missing-1", "test-key", "missing-2" });
+    REQUIRE(results.size() == 3);
+    REQUIRE(results[0].first.ec() ==
+            couchbase::errc::field_level_encryption::crypto_key_not_found);
+    REQUIRE_NO_ERROR(results[1].first);
+    REQUIRE(results[1].second.bytes() == test::utils::make_bytes({ 0x2a, 0x43 }));
+    REQUIRE(results[2].first.ec() ==
+            couchbase::errc::field_level_encryption::crypto_key_not_found);
+    REQUIRE(results[2].first.message() == "Key not found: missing-2");
+    REQUIRE(counting->batch_calls == 1);
+
+    // everything is cached now, including the missing keys
+    results = keyring.get_many({ "missing-2", "test-key", "missing-1" });
+    REQUIRE(results.size() == 3);
+    REQUIRE(counting->batch_calls == 1);
+    REQUIRE(counting->calls == 1);
+  }
+
+  SECTION("prefetched keys are served from the cache")
+  {
+    backing->add_key(couchbase::crypto::key("other-key", test::utils::make_bytes({ 0x51 })));
+    couchbase::crypto::caching_keyring keyring(counting);
+    keyring.prefetch({ "test-key", "other-key" });
+    REQUIRE(counting->batch_calls == 1);
+
+    auto [err, key] = keyring.get("other-key");
+    REQUIRE_NO_ERROR(err);
+    REQUIRE(key.bytes() == test::utils::make_bytes({ 0x51 }));
+    std::ignore = keyring.get("test-key");
+    REQUIRE(counting->calls == 0);
+
+    // keys that are already cached are not retrieved again
+    keyring.prefetch({ "test-key", "other-key" });
+    REQUIRE(counting->batch_calls == 1);
+  }
+
+  SECTION("other errors are not cached")
+  {
+    const auto failing = std::make_shared<failing_keyring>();
+    couchbase::crypto::caching_keyring keyring(failing);
+    for (int i = 0; i < 3; ++i) {
+      auto [err, key] = keyring.get("test-key");
+      REQUIRE(err.ec() == couchbase::errc::field_level_encryption::generic_cryptography_failure);
+    }
+    REQUIRE(failing->calls == 3);
+  }
+}
@@ -0,0 +1,110 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include "test_helper.hxx"
+
+#include <couchbase_encryption/aead_aes_256_cbc_hmac_sha512_provider.hxx>
+#include <couchbase_encryption/default_manager.hxx>
+#include <couchbase_encryption/insecure_keyring.hxx>
+#include <couchbase_encryption/transcoder.hxx>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <string>
+
+namespace
+{
+auto
+make_crypto_manager() -> std::shared_ptr<couchbase::crypto::manager>
+{
+  auto keyring = std::make_shared<couchbase::crypto::insecure_keyring>();
+  keyring->add_key(couchbase::crypto::key("test-key", std::vector<std::byte>(64, std::byte{ 7 })));
+  const couchbase::crypto::aead_aes_256_cbc_hmac_sha512_provider provider{ keyring };
+  auto manager = std::make_shared<couchbase::crypto::default_manager>();
+  manager->register_default_encrypter(provider.encrypter_for_key("test-key"));
+  manager->register_decrypter(provider.decrypter());
+  return manager;
+}
+
+/**
+ * Returns a JSON document of roughly the given size, made of an array of small objects, with an
+ * encrypted field in every object.
+ */
+auto
+make_document(std::size_t size) -> couchbase::codec::binary
+{
+  std::string document{ R"({"items":[)" };
+  for (std::size_t i = 0; document.size() < size; ++i) {
+    if (i > 0) {
+      document += ',';
+    }
+    document += fmt::format(
+      R"({{"id":{},"name":"item \"{}\"","price":{}.25,"tags":["a","b","c"],"secret":"{}"}})",
+      i,
+      i,
+      i % 1000,
+      std::string(32, 'x'));
+  }
+  document += "]}";
+  const auto* begin = reinterpret_cast<const std::byte*>(document.data());
+  return { begin, begin + document.size() };
+}
+
+const std::vector<couchbase::crypto::encrypted_field> encrypted_fields{
+  { { "items", "*", "secret" } },
+};
+} // namespace
+
+TEST_CASE("unit: crypto transcoder with large documents", "[unit]")
+{
+  const auto crypto_manager = make_crypto_manager();
+  const auto document = make_document(4 * 1024 * 1024);
+
+  const auto [encrypt_err, encrypted] =
+    couchbase::crypto::internal::encrypt(document, encrypted_fields, crypto_manager);
+  REQUIRE_NO_ERROR(encrypt_err);
+  REQUIRE(encrypted.size() > document.size());
+
+  const auto [decrypt_err, decrypted] =
+    couchbase::crypto::internal::decrypt(encrypted, crypto_manager);
+  REQUIRE_NO_ERROR(decrypt_err);
+  REQUIRE(decrypted == document);
+}
+
+/*
+ * Hidden from the test run, and run with:
+ *
+ *   test_unit_large_documents "[!benchmark]"
+ *
+ * The time per document should grow linearly with its size.
+ */
+TEST_CASE("benchmark: crypto transcoder with large documents", "[!benchmark]")
+{
+  const auto crypto_manager = make_crypto_manager();
+  const std::vector<couchbase::crypto::encrypted_field> no_fields{};
+
+  for (const std::size_t mebibytes : { 1, 2, 4, 8, 16 }) {
+    const auto document = make_document(mebibytes * 1024 * 1024);
+    const auto encrypted =
+      couchbase::crypto::internal::encrypt(document, encrypted_fields, crypto_manager).second;
+
+    // without encrypted fields, the document is only parsed and generated
+    BENCHMARK(fmt::format("parse and generate {} MiB", mebibytes))
+    {
+      return couchbase::crypto::internal::encrypt(document, no_fields, crypto_manager);
+    };
+    BENCHMARK(fmt::format("encrypt {} MiB", mebibytes))
+    {
+      return couchbase::crypto::internal::encrypt(document, encrypted_fields, crypto_manager);
+    };
+    BENCHMARK(fmt::format("decrypt {} MiB", mebibytes))
+    {
+      return couchbase::crypto::internal::decrypt(encrypted, crypto_manager);
+    };
+  }
+}
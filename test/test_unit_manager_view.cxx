@@ -0,0 +1,106 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include "test_helper.hxx"
+
+#include <couchbase/error_codes.hxx>
+#include <couchbase_encryption/aead_aes_256_cbc_hmac_sha512_provider.hxx>
+#include <couchbase_encryption/insecure_keyring.hxx>
+#include <couchbase_encryption/manager_view.hxx>
+
+#include <map>
+#include <string>
+
+TEST_CASE("unit: manager views share a registry", "[unit]")
+{
+  auto keyring = std::make_shared<couchbase::crypto::insecure_keyring>();
+  keyring->add_key(couchbase::crypto::key("tenant-a", std::vector<std::byte>(64, std::byte{ 1 })));
+  keyring->add_key(couchbase::crypto::key("tenant-b", std::vector<std::byte>(64, std::byte{ 2 })));
+  keyring->add_key(couchbase::crypto::key("shared", std::vector<std::byte>(64, std::byte{ 3 })));
+  const couchbase::crypto::aead_aes_256_cbc_hmac_sha512_provider provider{ keyring };
+
+  std::map<std::string, int> created{};
+  auto registry = std::make_shared<couchbase::crypto::manager_registry>();
+  registry->register_encrypter_factory([&provider, &created](const std::string& key_id) {
+    ++created[key_id];
+    return provider.encrypter_for_key(key_id);
+  });
+  registry->register_encrypter("shared", provider.encrypter_for_key("shared"));
+  registry->register_decrypter(provider.decrypter());
+
+  couchbase::crypto::manager_view tenant_a{ registry, "a$" };
+  tenant_a.register_default_key("tenant-a");
+  couchbase::crypto::manager_view tenant_b{ registry, "b$" };
+  tenant_b.register_default_key("tenant-b");
+  tenant_b.register_key("archive", "tenant-a");
+
+  const auto plaintext = test::utils::make_bytes({ 0x22, 0x78, 0x22 });
+
+  SECTION("aliases are resolved to the keys of each view")
+  {
+    const auto [a_err, a_node] = tenant_a.encrypt(plaintext, {});
+    REQUIRE_NO_ERROR(a_err);
+    REQUIRE(a_node.at("kid") == "tenant-a");
+    const auto [b_err, b_node] = tenant_b.encrypt(plaintext, {});
+    REQUIRE_NO_ERROR(b_err);
+    REQUIRE(b_node.at("kid") == "tenant-b");
+    const auto [archive_err, archive_node] = tenant_b.encrypt(plaintext, "archive");
+    REQUIRE_NO_ERROR(archive_err);
+    REQUIRE(archive_node.at("kid") == "tenant-a");
+
+    // the decrypters are shared
+    const auto [dec_err, decrypted] = tenant_b.decrypt(a_node);
+    REQUIRE_NO_ERROR(dec_err);
+    REQUIRE(decrypted == plaintext);
+  }
+
+  SECTION("encrypters are created once per key")
+  {
+    for (int i = 0; i < 3; ++i) {
+      const auto [a_err, a_node] = tenant_a.encrypt(plaintext, {});
+      REQUIRE_NO_ERROR(a_err);
+      const auto [b_err, b_node] = tenant_b.encrypt(plaintext, "archive");
+      REQUIRE_NO_ERROR(b_err);
+    }
+    REQUIRE(created.size() == 1);
+    REQUIRE(created.at("tenant-a") == 1);
+    REQUIRE(registry->encrypter_for_key("tenant-a") == registry->encrypter_for_key("tenant-a"));
+  }
+
+  SECTION("unmapped aliases fall back to the registry")
+  {
+    const auto [err, node] = tenant_a.encrypt(plaintext, "shared");
+    REQUIRE_NO_ERROR(err);
+    REQUIRE(node.at("kid") == "shared");
+    REQUIRE(created.empty());
+
+    const auto [missing_err, missing_node] = tenant_a.encrypt(plaintext, "missing");
+    REQUIRE(missing_err.ec() == couchbase::errc::field_level_encryption::encrypter_not_found);
+  }
+
+  SECTION("field names are mangled with the prefix of each view")
+  {
+    REQUIRE(tenant_a.mangle("ssn") == "a$ssn");
+    REQUIRE(tenant_a.is_mangled("a$ssn"));
+    REQUIRE_FALSE(tenant_b.is_mangled("a$ssn"));
+    REQUIRE(tenant_b.demangle("b$ssn") == "ssn");
+  }
+
+  SECTION("views without a default key use the default encrypter of the registry")
+  {
+    couchbase::crypto::manager_view view{ registry };
+    REQUIRE(view.mangle("ssn") == "encrypted$ssn");
+    REQUIRE(view.encrypt(plaintext, {}).first.ec() ==
+            couchbase::errc::field_level_encryption::encrypter_not_found);
+
+    registry->register_default_encrypter(provider.encrypter_for_key("shared"));
+    const auto [err, node] = view.encrypt(plaintext, {});
+    REQUIRE_NO_ERROR(err);
+    REQUIRE(node.at("kid") == "shared");
+  }
+}
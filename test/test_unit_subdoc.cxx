@@ -0,0 +1,209 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+#include "test_helper.hxx"
+#include "utils/crypto.hxx"
+
+#include <couchbase/codec/tao_json_serializer.hxx>
+#include <couchbase/error_codes.hxx>
+#include <couchbase_encryption/aead_aes_256_cbc_hmac_sha512_provider.hxx>
+#include <couchbase_encryption/default_manager.hxx>
+#include <couchbase_encryption/default_transcoder.hxx>
+#include <couchbase_encryption/document.hxx>
+#include <couchbase_encryption/insecure_keyring.hxx>
+#include <couchbase_encryption/subdoc.hxx>
+
+#include <tao/json/value.hpp>
+
+namespace
+{
+auto
+make_crypto_manager() -> std::shared_ptr<couchbase::crypto::default_manager>
+{
+  const auto keyring = std::make_shared<couchbase::crypto::insecure_keyring>();
+  keyring->add_key(couchbase::crypto::key("test-key", std::vector<std::byte>(64, std::byte{ 1 })));
+
+  const auto provider = couchbase::crypto::aead_aes_256_cbc_hmac_sha512_provider(keyring);
+
+  auto manager = std::make_shared<couchbase::crypto::default_manager>();
+  manager->register_default_encrypter(provider.encrypter_for_key("test-key"));
+  manager->register_decrypter(provider.decrypter());
+  return manager;
+}
+
+/**
+ * A minimal stand-in for the sub-document upsert and lookup specs, which resolves a sub-document
+ * path (member names, backtick escapes and array indexes) against a local document.
+ */
+struct mock_subdoc_spec {
+  std::string path;
+
+  auto resolve(tao::json::value& document, bool create) const -> tao::json::value*
+  {
+    tao::json::value* current = &document;
+    std::size_t i = 0;
+    while (i < path.size() && current != nullptr) {
+      if (path[i] == '.') {
+        ++i;
+      } else if (path[i] == '[') {
+        const auto end = path.find(']', i);
+        const auto index = std::stoul(path.substr(i + 1, end - i - 1));
+        current = &current->get_array().at(index);
+        i = end + 1;
+      } else {
+        std::string name{};
+        if (path[i] == '`') {
+          for (++i; i < path.size(); ++i) {
+            if (path[i] == '`' && (i + 1 == path.size() || path[i + 1] != '`')) {
+              ++i;
+              break;
+            }
+            if (path[i] == '`') {
+              ++i;
+            }
+            name += path[i];
+          }
+        } else {
+          const auto end = path.find_first_of(".[", i);
+          name = path.substr(i, end == std::string::npos ? std::string::npos : end - i);
+          i = end == std::string::npos ? path.size() : end;
+        }
+        current = create ? &(*current)[name] : current->find(name);
+      }
+    }
+    return current;
+  }
+
+  void upsert(tao::json::value& document, const couchbase::codec::binary& value) const
+  {
+    *resolve(document, true) =
+      couchbase::codec::tao_json_serializer::deserialize<tao::json::value>(value);
+  }
+
+  auto lookup(tao::json::value& document) const -> couchbase::codec::binary
+  {
+    return couchbase::codec::tao_json_serializer::serialize(*resolve(document, false));
+  }
+};
+} // namespace
+
+TEST_CASE("unit: sub-document encrypted paths", "[unit]")
+{
+  const auto mgr = make_crypto_manager();
+
+  const auto path_of = [&mgr](const std::vector<std::string>& field_path) {
+    auto [err, path] = couchbase::crypto::subdoc::encrypted_path(field_path, mgr);
+    REQUIRE_NO_ERROR(err);
+    return path;
+  };
+
+  REQUIRE(path_of({ "password" }) == "encrypted$password");
+  REQUIRE(path_of({ "address", "street" }) == "address.encrypted$street");
+  REQUIRE(path_of({ "contacts", "[1]", "phone" }) == "contacts[1].encrypted$phone");
+  REQUIRE(path_of({ "codes", "1", "pin" }) == "codes.1.encrypted$pin");
+  REQUIRE(path_of({ "codes", "1" }) == "codes.encrypted$1");
+  REQUIRE(path_of({ "a.b", "c`d", "e" }) == "`a.b`.`c``d`.encrypted$e");
+
+  const auto [wildcard_err, wildcard_path] =
+    couchbase::crypto::subdoc::encrypted_path({ "contacts", "*", "phone" }, mgr);
+  REQUIRE(wildcard_err.ec() == couchbase::errc::field_level_encryption::encryption_failure);
+
+  const auto [element_err, element_path] =
+    couchbase::crypto::subdoc::encrypted_path({ "contacts", "[1]" }, mgr);
+  REQUIRE(element_err.ec() == couchbase::errc::field_level_encryption::encryption_failure);
+
+  const auto [empty_err, empty_path] = couchbase::crypto::subdoc::encrypted_path({}, mgr);
+  REQUIRE(empty_err.ec() == couchbase::errc::field_level_encryption::encryption_failure);
+}
+
+TEST_CASE("unit: sub-document encryption and decryption of a single field", "[unit]")
+{
+  const auto mgr = make_crypto_manager();
+
+  const tao::json::value doc{
+    { "name", "Albert Einstein" },
+    { "address", { { "city", "Princeton" }, { "street", "112 Mercer Street" } } },
+  };
+  const couchbase::crypto::encrypted_field street_field{ { "address", "street" } };
+
+  const auto encoded = couchbase::crypto::default_transcoder::encode(
+    couchbase::crypto::document<tao::json::value>::from(doc).with_encrypted_field(
+      street_field.field_path),
+    mgr);
+  auto stored = couchbase::codec::tao_json_serializer::deserialize<tao::json::value>(encoded.data);
+
+  auto [path_err, path] = couchbase::crypto::subdoc::encrypted_path(street_field.field_path, mgr);
+  REQUIRE_NO_ERROR(path_err);
+  const mock_subdoc_spec spec{ path };
+
+  SECTION("lookup_in")
+  {
+    const auto [err, value] = couchbase::crypto::subdoc::decrypt_value(spec.lookup(stored), mgr);
+    REQUIRE_NO_ERROR(err);
+    REQUIRE(couchbase::codec::tao_json_serializer::deserialize<std::string>(value) ==
+            "112 Mercer Street");
+  }
+
+  SECTION("mutate_in")
+  {
+    const auto [err, node] = couchbase::crypto::subdoc::encrypt_value(
+      street_field,
+      couchbase::codec::tao_json_serializer::serialize(std::string{ "Grove Street" }),
+      mgr);
+    REQUIRE_NO_ERROR(err);
+    spec.upsert(stored, node);
+    test::utils::ensure_field_at_path_is_encrypted(stored, street_field.field_path);
+
+    const auto decoded = couchbase::crypto::default_transcoder::decode<tao::json::value>(
+      couchbase::codec::encoded_value{
+        couchbase::codec::tao_json_serializer::serialize(stored),
+        couchbase::codec::codec_flags::json_common_flags,
+      },
+      mgr);
+    REQUIRE(decoded.at("address").at("street").get_string() == "Grove Street");
+    REQUIRE(decoded.at("address").at("city").get_string() == "Princeton");
+  }
+
+  SECTION("decrypt invalid node")
+  {
+    const auto [err, value] = couchbase::crypto::subdoc::decrypt_value(
+      couchbase::codec::tao_json_serializer::serialize(std::string{ "not encrypted" }), mgr);
+    REQUIRE(err.ec() == couchbase::errc::field_level_encryption::invalid_ciphertext);
+  }
+}
+
+TEST_CASE("unit: sub-document paths address the fields the transcoder encrypts", "[unit]")
+{
+  const auto mgr = make_crypto_manager();
+
+  const tao::json::value doc{
+    { "codes", { { "1", { { "pin", "1234" } } } } },
+    { "contacts", tao::json::value::array({ { { "phone", "555-0100" } } }) },
+  };
+  const std::vector<couchbase::crypto::encrypted_field> fields{
+    { { "codes", "1", "pin" } },
+    { { "contacts", "[0]", "phone" } },
+  };
+
+  auto crypto_doc = couchbase::crypto::document<tao::json::value>::from(doc);
+  for (const auto& field : fields) {
+    crypto_doc.with_encrypted_field(field.field_path);
+  }
+  const auto encoded = couchbase::crypto::default_transcoder::encode(crypto_doc, mgr);
+  auto stored = couchbase::codec::tao_json_serializer::deserialize<tao::json::value>(encoded.data);
+  REQUIRE(stored.at("codes").get_object().count("1") == 1);
+
+  for (const auto& field : fields) {
+    auto [path_err, path] = couchbase::crypto::subdoc::encrypted_path(field.field_path, mgr);
+    REQUIRE_NO_ERROR(path_err);
+    INFO(path);
+    const auto [err, value] =
+      couchbase::crypto::subdoc::decrypt_value(mock_subdoc_spec{ path }.lookup(stored), mgr);
+    REQUIRE_NO_ERROR(err);
+  }
+}
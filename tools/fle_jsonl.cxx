@@ -0,0 +1,507 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * Copyright (c) 2025 Couchbase, Inc.
+ *
+ * Use of this software is subject to the Couchbase Inc. Enterprise Subscription License Agreement
+ * v7 which may be found at https://www.couchbase.com/ESLA01162020.
+ */
+
+/*
+ * Encrypts or decrypts the fields of the documents in a JSON Lines file, outside of the SDK, e.g.
+ * for migrations and backups.
+ *
+ * The file is read by one thread, in batches of documents that are processed by the worker
+ * threads, and written by the main thread in the order they were read. The number of batches in
+ * flight is bounded, so that memory use does not depend on the size of the file.
+ */
+
+#include <couchbase/error_codes.hxx>
+#include <couchbase_encryption/aead_aes_256_cbc_hmac_sha512_provider.hxx>
+#include <couchbase_encryption/aead_aes_siv_cmac_512_provider.hxx>
+#include <couchbase_encryption/default_manager.hxx>
+#include <couchbase_encryption/encrypted_fields.hxx>
+#include <couchbase_encryption/insecure_keyring.hxx>
+#include <couchbase_encryption/transcoder.hxx>
+
+#include "src/utils/base64.h"
+
+#include <spdlog/fmt/bundled/format.h>
+
+#include <tao/json/from_file.hpp>
+#include <tao/json/value.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+constexpr auto usage = R"(usage: fle_jsonl <encrypt|decrypt> [options]
+
+Encrypts or decrypts the fields of the JSON documents in a JSON Lines file, one document per line.
+Documents are processed on several threads, and written in the order they were read. Documents
+that fail are reported on standard error with their line number, and left out of the output.
+
+options:
+  --keys <file>        JSON object with the keys, by key ID, as base64 strings (required)
+  --key <id>           ID of the key to encrypt with (required to encrypt)
+  --algorithm <name>   AEAD_AES_256_CBC_HMAC_SHA512 (default) or AEAD_AES_SIV_CMAC_512
+  --field <path>       dot-separated path of a field, where `*` matches any member or element
+                       and `[n]` the element at index n; may be repeated (required to encrypt,
+                       limits the fields to decrypt)
+  --prefix <prefix>    prefix of the names of encrypted fields (default: encrypted$)
+  --input <file>       file to read (default: standard input)
+  --output <file>      file to write (default: standard output)
+  --threads <n>        number of worker threads (default: number of cores)
+  --batch-size <n>     number of documents handed to a worker at once (default: 256)
+  --queue-size <n>     maximum number of batches in flight (default: 4 per thread)
+)";
+
+struct options {
+  bool encrypt{ true };
+  std::string keys_file{};
+  std::string key_id{};
+  std::string algorithm{ couchbase::crypto::aead_aes_256_cbc_hmac_sha512_provider::algorithm_name };
+  std::vector<couchbase::crypto::encrypted_field> fields{};
+  std::string prefix{ couchbase::crypto::default_manager::default_encrypted_field_name_prefix };
+  std::string input{};
+  std::string output{};
+  std::size_t threads{ std::max(1U, std::thread::hardware_concurrency()) };
+  std::size_t batch_size{ 256 };
+  std::size_t queue_size{ 0 };
+};
+
+/**
+ * Splits a path such as `contacts[0].phone` into the segments `contacts`, `[0]` and `phone`.
+ */
+auto
+split_path(const std::string& path) -> std::vector<std::string>
+{
+  std::vector<std::string> segments{};
+  std::string segment{};
+  for (const auto c : path) {
+    if (c == '.' || (c == '[' && !segment.empty())) {
+      segments.push_back(std::move(segment));
+      segment.clear();
+    }
+    if (c != '.') {
+      segment += c;
+    }
+  }
+  segments.push_back(std::move(segment));
+  return segments;
+}
+
+auto
+parse_count(const std::string& name, const std::string& value) -> std::size_t
+{
+  std::size_t parsed = 0;
+  std::size_t count = 0;
+  try {
+    count = std::stoul(value, &parsed);
+  } catch (const std::exception&) {
+    parsed = 0;
+  }
+  if (parsed != value.size() || count == 0) {
+    throw std::invalid_argument(fmt::format("{} must be a positive number", name));
+  }
+  return count;
+}
+
+auto
+parse_options(int argc, const char* const* argv) -> options
+{
+  if (argc < 2) {
+    throw std::invalid_argument("missing command");
+  }
+  options opts{};
+  const std::string command{ argv[1] };
+  if (command == "decrypt") {
+    opts.encrypt = false;
+  } else if (command != "encrypt") {
+    throw std::invalid_argument(fmt::format("unknown command `{}`", command));
+  }
+
+  for (int i = 2; i < argc; i += 2) {
+    const std::string name{ argv[i] };
+    if (i + 1 == argc) {
+      throw std::invalid_argument(fmt::format("missing value for {}", name));
+    }
+    std::string value{ argv[i + 1] };
+    if (name == "--keys") {
+      opts.keys_file = std::move(value);
+    } else if (name == "--key") {
+      opts.key_id = std::move(value);
+    } else if (name == "--algorithm") {
+      opts.algorithm = std::move(value);
+    } else if (name == "--field") {
+      opts.fields.push_back({ split_path(value) });
+    } else if (name == "--prefix") {
+      opts.prefix = std::move(value);
+    } else if (name == "--input") {
+      opts.input = std::move(value);
+    } else if (name == "--output") {
+      opts.output = std::move(value);
+    } else if (name == "--threads") {
+      opts.threads = parse_count(name, value);
+    } else if (name == "--batch-size") {
+      opts.batch_size = parse_count(name, value);
+    } else if (name == "--queue-size") {
+      opts.queue_size = parse_count(name, value);
+    } else {
+      throw std::invalid_argument(fmt::format("unknown option `{}`", name));
+    }
+  }
+
+  if (opts.keys_file.empty()) {
+    throw std::invalid_argument("--keys is required");
+  }
+  if (opts.encrypt && (opts.key_id.empty() || opts.fields.empty())) {
+    throw std::invalid_argument("--key and at least one --field are required to encrypt");
+  }
+  if (opts.queue_size == 0) {
+    opts.queue_size = 4 * opts.threads;
+  }
+  return opts;
+}
+
+auto
+make_crypto_manager(const options& opts) -> std::shared_ptr<couchbase::crypto::manager>
+{
+  const auto keys = tao::json::from_file(opts.keys_file);
+  if (!keys.is_object()) {
+    throw std::invalid_argument(fmt::format("{} must contain a JSON object", opts.keys_file));
+  }
+  auto keyring = std::make_shared<couchbase::crypto::insecure_keyring>();
+  for (const auto& [key_id, bytes] : keys.get_object()) {
+    keyring->add_key(couchbase::crypto::key(
+      key_id, couchbase::crypto::impl::utils::base64::decode(bytes.get_string())));
+  }
+
+  const couchbase::crypto::aead_aes_256_cbc_hmac_sha512_provider cbc_hmac{ keyring };
+  const couchbase::crypto::aead_aes_siv_cmac_512_provider siv{ keyring };
+  auto crypto_manager = std::make_shared<couchbase::crypto::default_manager>(opts.prefix);
+  crypto_manager->register_decrypter(cbc_hmac.decrypter());
+  crypto_manager->register_decrypter(siv.decrypter());
+  if (opts.encrypt) {
+    if (opts.algorithm == cbc_hmac.algorithm_name) {
+      crypto_manager->register_default_encrypter(cbc_hmac.encrypter_for_key(opts.key_id));
+    } else if (opts.algorithm == siv.algorithm_name) {
+      crypto_manager->register_default_encrypter(siv.encrypter_for_key(opts.key_id));
+    } else {
+      throw std::invalid_argument(fmt::format("unknown algorithm `{}`", opts.algorithm));
+    }
+  }
+  return crypto_manager;
+}
+
+/**
+ * A line of the input, which is replaced by its output once it is processed.
+ */
+struct document_line {
+  std::size_t number{};
+  std::string text{};
+  couchbase::error err{};
+};
+
+struct batch {
+  std::size_t sequence{};
+  std::vector<document_line> lines{};
+};
+
+/**
+ * The batches read but not written yet. The reader waits for room before reading a new batch, the
+ * workers take the batches in the order they were read, and the writer takes the processed batches
+ * in the same order, whatever the order in which the workers finish them.
+ */
+class pipeline
+{
+public:
+  explicit pipeline(std::size_t capacity)
+    : capacity_{ capacity }
+  {
+  }
+
+  /**
+   * Waits until the batch with the given sequence number fits in the pipeline.
+   */
+  void wait_for_room(std::size_t sequence)
+  {
+    std::unique_lock lock(mutex_);
+    room_.wait(lock, [this, sequence] {
+      return sequence < next_to_write_ + capacity_;
+    });
+  }
+
+  void push(batch b)
+  {
+    {
+      const std::scoped_lock lock(mutex_);
+      pending_.push_back(std::move(b));
+    }
+    work_.notify_one();
+  }
+
+  /**
+   * Signals that no more batches will be pushed.
+   */
+  void close()
+  {
+    {
+      const std::scoped_lock lock(mutex_);
+      closed_ = true;
+    }
+    work_.notify_all();
+    done_.notify_all();
+  }
+
+  /**
+   * Returns the next batch to process, or std::nullopt once the pipeline is closed and empty.
+   */
+  auto take_work() -> std::optional<batch>
+  {
+    std::unique_lock lock(mutex_);
+    work_.wait(lock, [this] {
+      return !pending_.empty() || closed_;
+    });
+    if (pending_.empty()) {
+      return std::nullopt;
+    }
+    auto b = std::move(pending_.front());
+    pending_.pop_front();
+    ++in_progress_;
+    return b;
+  }
+
+  void complete(batch b)
+  {
+    {
+      const std::scoped_lock lock(mutex_);
+      --in_progress_;
+      auto sequence = b.sequence;
+      processed_.emplace(sequence, std::move(b));
+    }
+    done_.notify_all();
+  }
+
+  /**
+   * Returns the next batch to write, or std::nullopt once every batch has been written.
+   */
+  auto take_processed() -> std::optional<batch>
+  {
+    std::unique_lock lock(mutex_);
+    done_.wait(lock, [this] {
+      return processed_.count(next_to_write_) > 0 ||
+             (closed_ && pending_.empty() && in_progress_ == 0 && processed_.empty());
+    });
+    const auto it = processed_.find(next_to_write_);
+    if (it == processed_.end()) {
+      return std::nullopt;
+    }
+    auto b = std::move(it->second);
+    processed_.erase(it);
+    ++next_to_write_;
+    lock.unlock();
+    room_.notify_one();
+    return b;
+  }
+
+private:
+  std::size_t capacity_;
+  std::mutex mutex_{};
+  std::condition_variable room_{};
+  std::condition_variable work_{};
+  std::condition_variable done_{};
+  std::deque<batch> pending_{};
+  std::map<std::size_t, batch> processed_{};
+  std::size_t in_progress_{ 0 };
+  std::size_t next_to_write_{ 0 };
+  bool closed_{ false };
+};
+
+void
+read_batches(std::istream& input, const options& opts, pipeline& batches, std::size_t& input_bytes)
+{
+  std::size_t line_number = 0;
+  for (std::size_t sequence = 0; input; ++sequence) {
+    batches.wait_for_room(sequence);
+    batch b{ sequence, {} };
+    b.lines.reserve(opts.batch_size);
+    std::string text{};
+    while (b.lines.size() < opts.batch_size && std::getline(input, text)) {
+      ++line_number;
+      input_bytes += text.size() + 1;
+      if (text.find_first_not_of(" \t\r") == std::string::npos) {
+        continue;
+      }
+      b.lines.push_back({ line_number, std::move(text), {} });
+    }
+    batches.push(std::move(b));
+  }
+  batches.close();
+}
+
+void
+process_line(document_line& line,
+             const options& opts,
+             const std::shared_ptr<couchbase::crypto::manager>& crypto_manager)
+{
+  const auto* begin = reinterpret_cast<const std::byte*>(line.text.data());
+  const couchbase::codec::binary raw{ begin, begin + line.text.size() };
+  std::pair<couchbase::error, couchbase::codec::binary> result{};
+  try {
+    if (opts.encrypt) {
+      result = couchbase::crypto::internal::encrypt(raw, opts.fields, crypto_manager);
+    } else if (opts.fields.empty()) {
+      result = couchbase::crypto::internal::decrypt(raw, crypto_manager);
+    } else {
+      result = couchbase::crypto::internal::decrypt(raw, opts.fields, crypto_manager);
+    }
+  } catch (const std::exception& e) {
+    // a single malformed document must not bring the whole run down
+    result.first = { couchbase::errc::field_level_encryption::generic_cryptography_failure,
+                     e.what() };
+  }
+  if (result.first) {
+    line.err = std::move(result.first);
+    return;
+  }
+  line.text.assign(reinterpret_cast<const char*>(result.second.data()), result.second.size());
+}
+
+void
+process_batches(pipeline& batches,
+                const options& opts,
+                const std::shared_ptr<couchbase::crypto::manager>& crypto_manager)
+{
+  while (auto b = batches.take_work()) {
+    for (auto& line : b->lines) {
+      process_line(line, opts, crypto_manager);
+    }
+    batches.complete(std::move(b.value()));
+  }
+}
+
+struct totals {
+  std::size_t documents{ 0 };
+  std::size_t failed{ 0 };
+  std::size_t output_bytes{ 0 };
+};
+
+auto
+write_batches(std::ostream& output, pipeline& batches) -> totals
+{
+  totals t{};
+  while (auto b = batches.take_processed()) {
+    for (const auto& line : b->lines) {
+      ++t.documents;
+      if (line.err) {
+        ++t.failed;
+        std::cerr << fmt::format("line {}: {}\n", line.number, line.err.message());
+        continue;
+      }
+      output.write(line.text.data(), static_cast<std::streamsize>(line.text.size()));
+      output.put('\n');
+      t.output_bytes += line.text.size() + 1;
+    }
+  }
+  output.flush();
+  return t;
+}
+
+auto
+run(const options& opts) -> int
+{
+  const auto crypto_manager = make_crypto_manager(opts);
+
+  std::ifstream input_file{};
+  if (!opts.input.empty()) {
+    input_file.open(opts.input, std::ios::binary);
+    if (!input_file) {
+      throw std::runtime_error(fmt::format("cannot open {}", opts.input));
+    }
+  }
+  std::ofstream output_file{};
+  if (!opts.output.empty()) {
+    output_file.open(opts.output, std::ios::binary | std::ios::trunc);
+    if (!output_file) {
+      throw std::runtime_error(fmt::format("cannot open {}", opts.output));
+    }
+  }
+  std::istream& input = opts.input.empty() ? std::cin : input_file;
+  std::ostream& output = opts.output.empty() ? std::cout : output_file;
+  std::ios::sync_with_stdio(false);
+  // std::cin flushes std::cout before reading by default, which the reader thread must not do while
+  // the main thread writes
+  input.tie(nullptr);
+
+  const auto start = std::chrono::steady_clock::now();
+  pipeline batches{ opts.queue_size };
+  std::size_t input_bytes = 0;
+  std::thread reader{ [&] {
+    read_batches(input, opts, batches, input_bytes);
+  } };
+  std::vector<std::thread> workers{};
+  workers.reserve(opts.threads);
+  for (std::size_t i = 0; i < opts.threads; ++i) {
+    workers.emplace_back([&] {
+      process_batches(batches, opts, crypto_manager);
+    });
+  }
+  const auto t = write_batches(output, batches);
+  reader.join();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  const auto seconds = std::max(elapsed.count(), 1e-9);
+  std::cerr << fmt::format(
+    "{} {} documents ({} failed) in {:.3f} s on {} threads: {:.0f} documents/s, {:.1f} MB/s read, "
+    "{:.1f} MB/s written\n",
+    opts.encrypt ? "encrypted" : "decrypted",
+    t.documents,
+    t.failed,
+    seconds,
+    opts.threads,
+    static_cast<double>(t.documents) / seconds,
+    static_cast<double>(input_bytes) / seconds / 1e6,
+    static_cast<double>(t.output_bytes) / seconds / 1e6);
+  if (!output) {
+    throw std::runtime_error("failed to write the output");
+  }
+  return t.failed == 0 ? 0 : 1;
+}
+} // namespace
+
+auto
+main(int argc, const char* argv[]) -> int
+{
+  options opts{};
+  try {
+    opts = parse_options(argc, argv);
+  } catch (const std::exception& e) {
+    std::cerr << "fle_jsonl: " << e.what() << "\n\n" << usage;
+    return 2;
+  }
+  try {
+    return run(opts);
+  } catch (const std::exception& e) {
+    std::cerr << "fle_jsonl: " << e.what() << '\n';
+    return 2;
+  }
+}